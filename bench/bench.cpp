@@ -0,0 +1,1564 @@
+// End-to-end decode benchmark.
+// Runs nRF24L01_SimulationDataGenerator and nRF24L01_Analyzer back to back
+// against the headless SDK stand-in and reports the decode throughput.
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+#include <AnalyzerChannelData.h>
+#include <HeadlessCapture.h>
+#include <HeadlessTools.h>
+
+#include "nRF24L01_Analyzer.h"
+#include "nRF24L01_AnalyzerSettings.h"
+#include "nRFTypes.h"
+#include "nRFTables.h"
+#include "nRFBinaryReader.h"
+#include "nRFSpiDecoder.h"
+#include "nRFSegmentDecoder.h"
+
+static Channel MOSI_CH(0, 0);
+static Channel MISO_CH(0, 1);
+static Channel SCK_CH(0, 2);
+static Channel CSN_CH(0, 3);
+static Channel MORE_CSN_CH[MAX_RADIOS - 1] = {Channel(0, 4), Channel(0, 5), Channel(0, 6)};
+
+// counts the heap allocations, to check the text rendering doesn't make any
+static std::atomic<U64> g_allocations(0);
+
+void* operator new(size_t size)
+{
+	++g_allocations;
+
+	void* p = ::malloc(size == 0 ? 1 : size);
+	if (p == NULL)
+		throw std::bad_alloc();
+
+	return p;
+}
+
+void operator delete(void* p) noexcept
+{
+	::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+	::free(p);
+}
+
+struct BenchOptions
+{
+	U64		mTransactions;
+	U32		mSampleRate;
+	nRFDecoder_e	mDecoder;
+	nRFMarkers_e	mMarkers;
+	nRFSpiMode_e	mSpiMode;
+	U32				mRadios;
+	bool			mNoCsn;
+	bool			mNoMiso;
+	U32				mSckGapNs;
+	int				mPayloadRamMB;
+	U64				mBubbleViews;
+	const char*		mExportFile;
+	const char*		mBinaryExportFile;
+	const char*		mStatisticsFile;
+	const char*		mFilteredFile;
+	const char*		mFilter;
+	U64				mExportFrom;
+	U64				mExportTo;
+	U32				mOfflineThreads;
+	const char*		mCaptureFile;
+	U64				mLiveChunk;
+
+	BenchOptions()
+	:	mTransactions(1000000),
+		mSampleRate(100000000),
+		mDecoder(DECODER_BATCH),
+		mMarkers(MARKERS_FULL),
+		mSpiMode(SPI_MODE_AUTO),
+		mRadios(1),
+		mNoCsn(false),
+		mNoMiso(false),
+		mSckGapNs(0),
+		mPayloadRamMB(256),
+		mBubbleViews(0),
+		mExportFile(NULL),
+		mBinaryExportFile(NULL),
+		mStatisticsFile(NULL),
+		mFilteredFile(NULL),
+		mFilter(""),
+		mExportFrom(0),
+		mExportTo(0xFFFFFFFFFFFFFFFFull),
+		mOfflineThreads(0),
+		mCaptureFile(NULL),
+		mLiveChunk(0)
+	{}
+};
+
+static void usage()
+{
+	::fprintf(stderr,	"usage: nrf24l01_bench [options]\n"
+						"  --transactions N    number of SPI transactions to decode (default 1000000)\n"
+						"  --sample-rate HZ    capture sample rate (default 100000000)\n"
+						"  --decoder NAME      batch or per-bit (default batch)\n"
+						"  --markers LEVEL     none, csn, sck or full (default full)\n"
+						"  --spi-mode MODE     auto, 0, 1, 2 or 3, for the simulation and the decoder (default auto)\n"
+						"  --radios N          radios on the bus, each with its own CSN, 1 to 4 (default 1)\n"
+						"  --csn none          don't give the decoder CSN, it goes by the SCK idle gap\n"
+						"  --miso none         don't give the decoder MISO\n"
+						"  --sck-gap NS        the SCK idle gap without CSN (default 8 SCK half periods)\n"
+						"  --payload-ram MB    RAM for long payloads before they spill to disk (default 256)\n"
+						"  --bubbles N         render the bubbles of N scrolled views after decoding (default 0)\n"
+						"  --export FILE       export the decoded frames to FILE after decoding\n"
+						"  --export-binary FILE  binary export to FILE, then read it back and check it\n"
+						"  --export-stats FILE   statistics export to FILE\n"
+						"  --export-from SAMPLE  only export the transactions from SAMPLE on\n"
+						"  --export-to SAMPLE    only export the transactions up to SAMPLE\n"
+						"  --export-filtered FILE  check the filtered export, then export with --filter to FILE\n"
+						"  --filter EXPR       the export filter (default none)\n"
+						"  --offline-threads N  decode the capture again offline on 1, 2, 4... up to N threads\n"
+						"  --save-capture FILE  write the capture to FILE as packed samples, one byte each, for nrf24-decode\n"
+						"  --live SAMPLES      decode the capture as if it was still being recorded, SAMPLES at a time\n");
+	::exit(2);
+}
+
+static const NamedValue DECODERS[] = {{"batch", DECODER_BATCH}, {"per-bit", DECODER_PER_BIT}, {NULL, 0}};
+static const NamedValue MARKER_LEVELS[] = {{"none", MARKERS_NONE}, {"csn", MARKERS_CSN}, {"sck", MARKERS_SCK}, {"full", MARKERS_FULL}, {NULL, 0}};
+static const NamedValue SPI_MODES[] = {{"auto", SPI_MODE_AUTO}, {"0", SPI_MODE_0}, {"1", SPI_MODE_1}, {"2", SPI_MODE_2}, {"3", SPI_MODE_3}, {NULL, 0}};
+
+static bool parse_options(int argc, char* argv[], BenchOptions& opt)
+{
+	for (int c = 1; c < argc; c += 2)
+	{
+		const char* option = argv[c];
+		const char* value = c + 1 < argc ? argv[c + 1] : NULL;
+		int named;
+
+		if (value == NULL)
+			return false;
+
+		if (::strcmp(option, "--transactions") == 0)
+			opt.mTransactions = ::strtoull(value, NULL, 10);
+		else if (::strcmp(option, "--sample-rate") == 0)
+			opt.mSampleRate = U32(::strtoul(value, NULL, 10));
+		else if (::strcmp(option, "--decoder") == 0  &&  lookup(DECODERS, value, named))
+			opt.mDecoder = nRFDecoder_e(named);
+		else if (::strcmp(option, "--markers") == 0  &&  lookup(MARKER_LEVELS, value, named))
+			opt.mMarkers = nRFMarkers_e(named);
+		else if (::strcmp(option, "--spi-mode") == 0  &&  lookup(SPI_MODES, value, named))
+			opt.mSpiMode = nRFSpiMode_e(named);
+		else if (::strcmp(option, "--radios") == 0)
+			opt.mRadios = U32(::strtoul(value, NULL, 10));
+		else if (::strcmp(option, "--csn") == 0  &&  ::strcmp(value, "none") == 0)
+			opt.mNoCsn = true;
+		else if (::strcmp(option, "--miso") == 0  &&  ::strcmp(value, "none") == 0)
+			opt.mNoMiso = true;
+		else if (::strcmp(option, "--sck-gap") == 0)
+			opt.mSckGapNs = U32(::strtoul(value, NULL, 10));
+		else if (::strcmp(option, "--payload-ram") == 0)
+			opt.mPayloadRamMB = ::atoi(value);
+		else if (::strcmp(option, "--bubbles") == 0)
+			opt.mBubbleViews = ::strtoull(value, NULL, 10);
+		else if (::strcmp(option, "--export") == 0)
+			opt.mExportFile = value;
+		else if (::strcmp(option, "--export-binary") == 0)
+			opt.mBinaryExportFile = value;
+		else if (::strcmp(option, "--export-stats") == 0)
+			opt.mStatisticsFile = value;
+		else if (::strcmp(option, "--export-filtered") == 0)
+			opt.mFilteredFile = value;
+		else if (::strcmp(option, "--filter") == 0)
+			opt.mFilter = value;
+		else if (::strcmp(option, "--export-from") == 0)
+			opt.mExportFrom = ::strtoull(value, NULL, 10);
+		else if (::strcmp(option, "--export-to") == 0)
+			opt.mExportTo = ::strtoull(value, NULL, 10);
+		else if (::strcmp(option, "--offline-threads") == 0)
+			opt.mOfflineThreads = U32(::strtoul(value, NULL, 10));
+		else if (::strcmp(option, "--save-capture") == 0)
+			opt.mCaptureFile = value;
+		else if (::strcmp(option, "--live") == 0)
+			opt.mLiveChunk = ::strtoull(value, NULL, 10);
+		else
+			return false;
+	}
+
+	return opt.mTransactions > 0  &&  opt.mSampleRate > 0  &&  opt.mRadios >= 1  &&  opt.mRadios <= MAX_RADIOS
+			&&  !(opt.mNoCsn  &&  opt.mRadios > 1);
+}
+
+// FNV-1a over the frames and markers, so runs with different decoder options can be compared
+static U64 hash_bytes(U64 hash, const void* data, size_t size)
+{
+	const U8* p = (const U8*) data;
+	for (size_t c = 0; c < size; ++c)
+		hash = (hash ^ p[c]) * 0x100000001b3ull;
+
+	return hash;
+}
+
+// the long payloads are hashed by content, so the hash doesn't depend on how they're stored
+static U64 hash_results(nRF24L01_AnalyzerResults* results, U64& num_transactions)
+{
+	U64 hash = 0xcbf29ce484222325ull;
+	U64 num_frames = results->GetNumFrames();
+
+	num_transactions = 0;
+	for (U64 fcnt = 0; fcnt < num_frames; ++fcnt)
+	{
+		Frame f = results->GetFrame(fcnt);
+		if (f.mFlags & IS_COMMAND)
+			++num_transactions;
+
+		U64 fields[] = {U64(f.mStartingSampleInclusive), U64(f.mEndingSampleInclusive), f.mData1, f.mData2, U64(f.mType) << 8 | f.mFlags};
+		if (f.mFlags & IS_EXTENDED)
+		{
+			U8 payload[nRFPayloadStore::MAX_PAYLOAD];
+			U32 length = results->GetExtendedData().Get(f.mData1, payload);
+			fields[2] = hash_bytes(0xcbf29ce484222325ull, payload, length);
+		}
+
+		hash = hash_bytes(hash, fields, sizeof(fields));
+	}
+
+	U64 num_markers = results->GetNumMarkers();
+	for (U64 mcnt = 0; mcnt < num_markers; ++mcnt)
+	{
+		U64 sample;
+		U32 channel_index;
+		AnalyzerResults::MarkerType type;
+		results->GetMarker(mcnt, sample, channel_index, type);
+
+		U64 fields[] = {sample, U64(channel_index) << 8 | type};
+		hash = hash_bytes(hash, fields, sizeof(fields));
+	}
+
+	return hash;
+}
+
+// what was said on the bus, without where; the same with or without CSN
+static U64 hash_content(nRF24L01_AnalyzerResults* results)
+{
+	U64 hash = 0xcbf29ce484222325ull;
+	U64 num_frames = results->GetNumFrames();
+
+	for (U64 fcnt = 0; fcnt < num_frames; ++fcnt)
+	{
+		Frame f = results->GetFrame(fcnt);
+		U64 fields[] = {f.mData1, f.mData2, U64(f.mType) << 8 | f.mFlags};
+		if (f.mFlags & IS_OVERSIZE_BURST)
+		{
+			fields[0] = 0;
+		} else if (f.mFlags & IS_EXTENDED) {
+			U8 payload[nRFPayloadStore::MAX_PAYLOAD];
+			U32 length = results->GetExtendedData().Get(f.mData1, payload);
+			fields[0] = hash_bytes(0xcbf29ce484222325ull, payload, length);
+		}
+
+		hash = hash_bytes(hash, fields, sizeof(fields));
+	}
+
+	return hash;
+}
+
+static U64 hash_result_strings(nRF24L01_AnalyzerResults* results, U64 hash)
+{
+	const char** strings;
+	U32 num_strings;
+	results->GetResultStrings(&strings, &num_strings);
+
+	for (U32 c = 0; c < num_strings; ++c)
+		hash = hash_bytes(hash, strings[c], ::strlen(strings[c]) + 1);
+
+	return hash;
+}
+
+// Scrolls through the frames like someone reading the capture: a view of 40 frames
+// moves forward, and every fourth step jumps back to look at something again.
+// Every frame in view gets its MOSI and MISO bubble and its tabular text.
+static U64 render_bubbles(nRF24L01_AnalyzerResults* results, U64 num_views, U64& num_texts)
+{
+	const U64 VIEW_SIZE = 40;
+	const DisplayBase BASES[] = {Hexadecimal, Decimal, Binary, AsciiHex};
+
+	U64 hash = 0xcbf29ce484222325ull;
+	U64 num_frames = results->GetNumFrames();
+
+	num_texts = 0;
+	if (num_frames < VIEW_SIZE)
+		return hash;
+
+	U64 first = 0;
+	for (U64 view = 0; view < num_views; ++view)
+	{
+		DisplayBase display_base = BASES[(view / 64) % 4];
+
+		for (U64 fcnt = first; fcnt < first + VIEW_SIZE; ++fcnt)
+		{
+			results->GenerateBubbleText(fcnt, MOSI_CH, display_base);
+			hash = hash_result_strings(results, hash);
+			results->GenerateBubbleText(fcnt, MISO_CH, display_base);
+			hash = hash_result_strings(results, hash);
+			results->GenerateFrameTabularText(fcnt, display_base);
+			hash = hash_result_strings(results, hash);
+
+			num_texts += 3;
+		}
+
+		if (view % 4 == 3)
+			first = first > VIEW_SIZE / 2 ? first - VIEW_SIZE / 2 : 0;
+		else
+			first += VIEW_SIZE / 4;
+
+		if (first + VIEW_SIZE > num_frames)
+			first = 0;
+	}
+
+	return hash;
+}
+
+// the first frame that starts at or after the sample, the slow way
+static U64 frame_at_sample(nRF24L01_AnalyzerResults* results, U64 sample)
+{
+	U64 first = 0, count = results->GetNumFrames();
+	while (count > 0)
+	{
+		U64 step = count / 2;
+		if (U64(results->GetFrame(first + step).mStartingSampleInclusive) < sample)
+		{
+			first += step + 1;
+			count -= step + 1;
+		} else {
+			count = step;
+		}
+	}
+
+	return first;
+}
+
+// reads the binary export back and checks every row against the frames
+static bool check_binary_export(nRF24L01_AnalyzerResults* results, const char* file, U64 from_sample, U64 to_sample, double& read_s)
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	nRFBinaryReader reader;
+	if (!reader.Open(file))
+	{
+		::fprintf(stderr, "FAIL: can't read the binary export: %s\n", reader.GetError().c_str());
+		return false;
+	}
+
+	// what a downstream tool would do: walk the columns
+	U64 payload_sum = 0;
+	const U8* lengths = reader.GetLengths();
+	for (U64 row = 0; row < reader.GetNumRows(); ++row)
+	{
+		const U8* payload = reader.GetPayload(row);
+		for (U8 c = 0; c < lengths[row]; ++c)
+			payload_sum += payload[c];
+	}
+
+	read_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	// the command frames in the export range
+	U64 num_frames = results->GetNumFrames();
+	U64 first_frame = frame_at_sample(results, from_sample);
+	if (first_frame < num_frames  &&  (results->GetFrame(first_frame).mFlags & IS_COMMAND) == 0)
+		++first_frame;
+
+	U64 num_rows = 0;
+	for (U64 fcnt = first_frame; fcnt < num_frames; ++fcnt)
+	{
+		Frame f = results->GetFrame(fcnt);
+		if (U64(f.mStartingSampleInclusive) > to_sample)
+			break;
+		if (f.mFlags & IS_COMMAND)
+			++num_rows;
+	}
+
+	if (reader.GetNumRows() != num_rows)
+	{
+		::fprintf(stderr, "FAIL: binary export has %llu rows, expected %llu\n", reader.GetNumRows(), num_rows);
+		return false;
+	}
+
+	Frame cmd_frame, data_frame;
+	nRFCommand expected, cmd;
+	U64 fcnt = first_frame;
+	for (U64 row = 0; row < reader.GetNumRows(); ++row)
+	{
+		// the oversize bursts aren't exported
+		while ((cmd_frame = results->GetFrame(fcnt)).mFlags & IS_OVERSIZE_BURST)
+			++fcnt;
+
+		bool has_data = (cmd_frame.mFlags & HAS_DATA_FRAME) != 0;
+		if (has_data)
+			data_frame = results->GetFrame(fcnt + 1);
+		fcnt += has_data ? 2 : 1;
+
+		expected.Decode(&cmd_frame, &data_frame, results->GetExtendedData());
+		if (!has_data)
+			expected.mDataLength = 0;
+
+		reader.GetCommand(row, cmd);
+		if (reader.GetSamples()[row] != U64(cmd_frame.mStartingSampleInclusive)
+				||  cmd.mCommandByte != expected.mCommandByte  ||  cmd.mStatus != expected.mStatus
+				||  cmd.mCommand != expected.mCommand  ||  cmd.mRegister != expected.mRegister  ||  cmd.mRadio != expected.mRadio
+				||  cmd.mDataLength != expected.mDataLength
+				||  ::memcmp(cmd.mData, expected.mData, cmd.mDataLength) != 0)
+		{
+			::fprintf(stderr, "FAIL: binary export row %llu doesn't match the frames\n", row);
+			return false;
+		}
+	}
+
+	return payload_sum != 0  ||  reader.GetHeader().mPayloadBytes == 0;
+}
+
+// replays the register writes and reads of each radio and checks the shadow's state at every few transactions
+static bool check_register_shadow(nRF24L01_AnalyzerResults* results)
+{
+	nRFRegisterFile replayed[MAX_RADIOS], state;
+	U64 num_frames = results->GetNumFrames();
+	U64 num_checked = 0;
+
+	for (U64 fcnt = 0; fcnt < num_frames; ++fcnt)
+	{
+		Frame cmd_frame = results->GetFrame(fcnt);
+		if ((cmd_frame.mFlags & IS_COMMAND) == 0)
+			continue;
+
+		if (cmd_frame.mFlags & HAS_DATA_FRAME)
+		{
+			Frame data_frame = results->GetFrame(fcnt + 1);
+
+			U8 reg;
+			if ((data_frame.mFlags & IS_EXTENDED) == 0  &&  nRFRegisterFile::GetTarget(U8(cmd_frame.mData1), U32(data_frame.mType), reg))
+				replayed[cmd_frame.mType].Set(reg, (const U8*) &data_frame.mData1, U32(data_frame.mType));
+		}
+
+		if (num_checked++ % 7 != 0)
+			continue;
+
+		const nRFRegisterFile& expected = replayed[cmd_frame.mType];
+		results->GetRegisterShadow(cmd_frame.mType).GetState(fcnt, state);
+		if (state.mKnown != expected.mKnown  ||  ::memcmp(state.mValues, expected.mValues, sizeof(state.mValues)) != 0)
+		{
+			::fprintf(stderr, "FAIL: register shadow doesn't match at frame %llu\n", fcnt);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// the state at random frames, as the bubbles of a scrolled view would ask for it
+static double time_register_shadow(nRF24L01_AnalyzerResults* results, U64 num_queries, U32& check)
+{
+	const nRFRegisterShadow& shadow = results->GetRegisterShadow(0);
+	nRFRegisterFile state;
+	U64 num_frames = results->GetNumFrames();
+	U64 random = 0x2545f4914f6cdd1dull;
+	check = 0;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (U64 c = 0; c < num_queries; ++c)
+	{
+		random = random * 6364136223846793005ull + 1442695040888963407ull;
+		shadow.GetState((random >> 16) % num_frames, state);
+		check += state.Get(RF_CH);
+	}
+
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Every transaction should be a packet, and the packets should go into the operations in order.
+// The operations of different radios can be interleaved, each radio's go one after the other.
+static bool check_operations(nRF24L01_AnalyzerResults* results, U64 num_transactions)
+{
+	const nRFOperationGrouper& operations = results->GetOperations();
+	U64 num_packets = results->GetNumPackets();
+	if (num_packets != num_transactions)
+	{
+		::fprintf(stderr, "FAIL: %llu packets for %llu transactions\n", num_packets, num_transactions);
+		return false;
+	}
+
+	U64 num_operations = operations.GetNumOperations();
+	std::vector<U32> in_operation(size_t(num_operations), 0);
+	U64 last_operation[MAX_RADIOS];
+	std::fill(last_operation, last_operation + MAX_RADIOS, ~U64(0));
+	U64 next_new = 0;
+
+	nRFOperation op;
+	for (U64 packet_id = 0; packet_id < num_packets; ++packet_id)
+	{
+		U64 id = results->GetTransactionContainingPacket(packet_id);
+
+		U64 first_frame, last_frame;
+		results->GetFramesContainedInPacket(packet_id, &first_frame, &last_frame);
+		U8 radio = results->GetFrame(first_frame).mType;
+
+		// a radio either carries on with its operation or starts the next new one
+		bool in_order = id == last_operation[radio]  ||  id == next_new;
+		if (!in_order  ||  !operations.GetOperation(id, op)  ||  op.mRadio != radio)
+		{
+			::fprintf(stderr, "FAIL: packet %llu of radio %u is in operation %llu\n", packet_id, radio, id);
+			return false;
+		}
+
+		if (id == next_new)
+			++next_new;
+
+		last_operation[radio] = id;
+		++in_operation[size_t(id)];
+	}
+
+	for (U64 id = 0; id < num_operations; ++id)
+	{
+		if (!operations.GetOperation(id, op)  ||  op.mNumTransactions != in_operation[size_t(id)])
+		{
+			::fprintf(stderr, "FAIL: operation %llu has %u packets\n", id, in_operation[size_t(id)]);
+			return false;
+		}
+	}
+
+	return next_new == num_operations;
+}
+
+// the packet and transaction tables, all of them
+static double render_operations(nRF24L01_AnalyzerResults* results, U64& hash)
+{
+	U64 num_packets = results->GetNumPackets();
+	U64 num_operations = results->GetOperations().GetNumOperations();
+	hash = 0xcbf29ce484222325ull;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (U64 id = 0; id < num_operations; ++id)
+	{
+		results->GenerateTransactionTabularText(id, Hexadecimal);
+		hash = hash_result_strings(results, hash);
+	}
+
+	for (U64 id = 0; id < num_packets; ++id)
+	{
+		results->GeneratePacketTabularText(id, Hexadecimal);
+		hash = hash_result_strings(results, hash);
+	}
+
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// looks the patterns up with the index and by going through every frame, they have to agree
+static bool check_payload_search(nRF24L01_AnalyzerResults* results, double& indexed_s, double& scan_s, U64& num_found)
+{
+	static const U8 PATTERNS[][4] = {
+		{2,		0x00, 0x21, 0},			// the sequence number of the long payloads
+		{2,		0x7F, 0x21, 0},
+		{3,		0x05, 0x04, 0x03},		// in the W_TX_PAYLOAD every cycle
+		{3,		0x0D, 0x0E, 0x0F},		// the end of the NOACK payload
+		{2,		0x42, 0x43, 0},			// in no payload
+		{1,		0x07, 0, 0},			// single bytes aren't indexed
+	};
+
+	indexed_s = scan_s = 0;
+	num_found = 0;
+
+	std::vector<U64> found;
+	U64 num_frames = results->GetNumFrames();
+	for (size_t p = 0; p < sizeof(PATTERNS) / sizeof(PATTERNS[0]); ++p)
+	{
+		const U8* pattern = PATTERNS[p] + 1;
+		U32 length = PATTERNS[p][0];
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		results->FindPayload(pattern, length, found);
+		indexed_s += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		// the slow way
+		start = std::chrono::steady_clock::now();
+		std::vector<U64> expected;
+		U8 data[32];
+		for (U64 fcnt = 1; fcnt < num_frames; ++fcnt)
+		{
+			Frame f = results->GetFrame(fcnt);
+			if ((f.mFlags & IS_COMMAND)  ||  (GetCommandInfo(U8(results->GetFrame(fcnt - 1).mData1)).mFlags & CMD_HAS_PAYLOAD) == 0)
+				continue;
+
+			U32 data_length = f.mType;
+			if (f.mFlags & IS_EXTENDED)
+			{
+				data_length = results->GetExtendedData().Get(f.mData1, data);
+			} else {
+				::memcpy(data, &f.mData1, 8);
+				::memcpy(data + 8, &f.mData2, 8);
+			}
+
+			if (std::search(data, data + data_length, pattern, pattern + length) != data + data_length)
+				expected.push_back(fcnt);
+		}
+		scan_s += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		if (found != expected)
+		{
+			::fprintf(stderr, "FAIL: payload search %zu found %zu frames, expected %zu\n", p, found.size(), expected.size());
+			return false;
+		}
+
+		num_found += found.size();
+	}
+
+	return true;
+}
+
+// is the command frame in the set? only the STATUS and command sets
+static bool in_event_set(const Frame& cmd_frame, U8 set)
+{
+	U8 status = U8(cmd_frame.mData2);
+	switch (set)
+	{
+	case SET_RX_DR:		return (status & STATUS_RX_DR) != 0;
+	case SET_TX_DS:		return (status & STATUS_TX_DS) != 0;
+	case SET_MAX_RT:	return (status & STATUS_MAX_RT) != 0;
+	case SET_TX_FULL:	return (status & 0x01) != 0;
+	}
+
+	return set == SET_COMMAND + GetCommandInfo(U8(cmd_frame.mData1)).mCommand;
+}
+
+// jumps to the next event from random places, with the index and by scanning the frames
+static bool check_event_index(nRF24L01_AnalyzerResults* results, U64 end_sample, double& indexed_us, double& scan_us)
+{
+	static const U8 QUERIES[][3] = {
+		{2,		SET_TX_DS,		SET_COMMAND + NOP},
+		{2,		SET_RX_DR,		SET_COMMAND + R_RX_PAYLOAD},
+		{1,		SET_COMMAND + W_TX_PAYLOAD_NOACK},
+		{2,		SET_MAX_RT,		SET_COMMAND + W_TX_PAYLOAD},		// never happens
+	};
+	const size_t NUM_QUERIES = sizeof(QUERIES) / sizeof(QUERIES[0]);
+	const int NUM_JUMPS = 1000;
+
+	U64 num_frames = results->GetNumFrames();
+	U64 random = 0x9e3779b97f4a7c15ull;
+	indexed_us = scan_us = 0;
+
+	for (int j = 0; j < NUM_JUMPS; ++j)
+	{
+		random = random * 6364136223846793005ull + 1442695040888963407ull;
+		U64 from_sample = (random >> 16) % (end_sample + 1);
+		const U8* query = QUERIES[j % NUM_QUERIES];
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		U64 found = results->FindNextEvent(query + 1, query[0], from_sample);
+		indexed_us += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+		start = std::chrono::steady_clock::now();
+		U64 expected = INVALID_RESULT_INDEX;
+		for (U64 fcnt = frame_at_sample(results, from_sample); fcnt < num_frames  &&  expected == INVALID_RESULT_INDEX; ++fcnt)
+		{
+			Frame f = results->GetFrame(fcnt);
+			if ((f.mFlags & IS_COMMAND) == 0)
+				continue;
+
+			bool in_all = true;
+			for (U8 s = 0; s < query[0]; ++s)
+				in_all = in_all  &&  in_event_set(f, query[1 + s]);
+
+			if (in_all)
+				expected = fcnt;
+		}
+		scan_us += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+		if (found != expected)
+		{
+			::fprintf(stderr, "FAIL: event query %zu from sample %llu found frame %llu, expected %llu\n",
+						j % NUM_QUERIES, from_sample, found, expected);
+			return false;
+		}
+	}
+
+	indexed_us /= NUM_JUMPS;
+	scan_us /= NUM_JUMPS;
+
+	return true;
+}
+
+// point and range lookups from random samples, with the index and with GetFrame binary searches
+static bool check_sample_index(nRF24L01_AnalyzerResults* results, U64 end_sample, double& indexed_us, double& search_us)
+{
+	const nRFSampleIndex& index = results->GetSampleIndex();
+	const int NUM_LOOKUPS = 100000;
+	U64 num_frames = results->GetNumFrames();
+	U64 random = 0x2545f4914f6cdd1dull;
+	U64 check = 0;
+
+	// with the index
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (int c = 0; c < NUM_LOOKUPS; ++c)
+	{
+		random = random * 6364136223846793005ull + 1442695040888963407ull;
+		U64 sample = (random >> 16) % (end_sample + 1);
+
+		nRFSampleIndex::Entry entry;
+		if (index.FindCovering(sample, entry))
+			check += entry.mFrameIndex;
+		check += index.CountInRange(sample, sample + 100000);
+	}
+	indexed_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / NUM_LOOKUPS;
+
+	// and the same lookups without it
+	random = 0x2545f4914f6cdd1dull;
+	start = std::chrono::steady_clock::now();
+	for (int c = 0; c < NUM_LOOKUPS; ++c)
+	{
+		random = random * 6364136223846793005ull + 1442695040888963407ull;
+		U64 sample = (random >> 16) % (end_sample + 1);
+
+		// the command frame of the last transaction that starts at or before the sample
+		U64 frame_index = frame_at_sample(results, sample + 1);
+		while (frame_index > 0  &&  (results->GetFrame(--frame_index).mFlags & IS_COMMAND) == 0)
+			;
+
+		if (frame_index < num_frames)
+		{
+			Frame f = results->GetFrame(frame_index);
+			U64 end = (f.mFlags & HAS_DATA_FRAME) ? results->GetFrame(frame_index + 1).mEndingSampleInclusive : f.mEndingSampleInclusive;
+			if (U64(f.mStartingSampleInclusive) <= sample  &&  end >= sample)
+				check -= frame_index;
+		}
+
+		U64 first = frame_at_sample(results, sample), last = frame_at_sample(results, sample + 100001);
+		for (U64 fcnt = first; fcnt < last; ++fcnt)
+			check -= (results->GetFrame(fcnt).mFlags & IS_COMMAND) ? 1 : 0;
+	}
+	search_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / NUM_LOOKUPS;
+
+	if (check != 0  ||  index.GetCount() == 0)
+	{
+		::fprintf(stderr, "FAIL: sample index lookups don't match the frames\n");
+		return false;
+	}
+
+	// and walk the whole thing
+	nRFSampleIndex::Cursor cursor(index, 0);
+	nRFSampleIndex::Entry entry;
+	U64 fcnt = 0;
+	while (cursor.Next(entry))
+	{
+		// the oversize bursts aren't indexed
+		Frame f;
+		while ((f = results->GetFrame(fcnt)).mFlags & IS_OVERSIZE_BURST)
+			++fcnt;
+
+		if (entry.mFrameIndex != fcnt  ||  entry.mStartSample != U64(f.mStartingSampleInclusive))
+		{
+			::fprintf(stderr, "FAIL: sample index entry %llu doesn't match frame %llu\n", cursor.GetPosition() - 1, fcnt);
+			return false;
+		}
+
+		fcnt += (f.mFlags & HAS_DATA_FRAME) ? 2 : 1;
+	}
+
+	while (fcnt < num_frames  &&  (results->GetFrame(fcnt).mFlags & IS_OVERSIZE_BURST))
+		++fcnt;
+
+	return fcnt == num_frames;
+}
+
+// Samples a channel from a list of its transitions, for decoding without a capture.
+class EdgeListSampler
+{
+public:
+	EdgeListSampler(const std::vector<U64>& edges)
+	:	mEdges(edges),
+		mNext(0),
+		mState(BIT_LOW)
+	{}
+
+	BitState At(U64 sample)
+	{
+		while (mNext < mEdges.size()  &&  mEdges[mNext] <= sample)
+		{
+			mState = Toggle(mState);
+			++mNext;
+		}
+
+		return mState;
+	}
+
+protected:
+	const std::vector<U64>&	mEdges;
+	size_t					mNext;
+	BitState				mState;
+};
+
+// CSN windows of random bytes clocked in one SPI mode, like the simulation does it
+struct SpiBus
+{
+	std::vector<SpiSckEdges>	mWindows;
+	std::vector<U64>			mMosiEdges;
+	std::vector<U64>			mMisoEdges;
+	U64							mNumBytes;
+
+	SpiBus(nRFSpiMode_e mode, size_t num_windows)
+	:	mWindows(num_windows),
+		mNumBytes(0)
+	{
+		const U64 HALF_PERIOD = 5;
+		bool cpha = !SpiSamplesOnLeadingEdge(mode);
+		BitState mosi = BIT_LOW, miso = BIT_LOW;
+		U64 random = 0x853c49e6748fea9bull;
+		U64 t = 100;
+
+		for (size_t w = 0; w < num_windows; ++w)
+		{
+			SpiSckEdges& sck = mWindows[w];
+			sck.mStart = t;
+			sck.mInitialState = SpiIdlesHigh(mode) ? BIT_HIGH : BIT_LOW;
+			sck.mNumEdges = 0;
+			sck.mOverflow = false;
+
+			t += 2 * HALF_PERIOD;
+
+			random = random * 6364136223846793005ull + 1442695040888963407ull;
+			U32 num_bytes = 1 + U32(random >> 33) % 33;
+			mNumBytes += num_bytes;
+
+			for (U32 c = 0; c < num_bytes; ++c)
+			{
+				random = random * 6364136223846793005ull + 1442695040888963407ull;
+				for (int bit = 15; bit >= 8; --bit)
+				{
+					if (cpha)
+						sck.mEdges[sck.mNumEdges++] = t;
+
+					set_bit(mMosiEdges, mosi, BitState((random >> (32 + bit)) & 1), t);
+					set_bit(mMisoEdges, miso, BitState((random >> (48 + bit)) & 1), t);
+
+					t += HALF_PERIOD;
+					sck.mEdges[sck.mNumEdges++] = t;
+					t += HALF_PERIOD;
+
+					if (!cpha)
+						sck.mEdges[sck.mNumEdges++] = t;
+				}
+
+				t += 2 * HALF_PERIOD;
+			}
+
+			t += 2 * HALF_PERIOD;
+		}
+	}
+
+	static void set_bit(std::vector<U64>& edges, BitState& state, BitState bit, U64 t)
+	{
+		if (bit != state)
+		{
+			edges.push_back(t);
+			state = bit;
+		}
+	}
+};
+
+// The mode checked on every edge, what the specialized loops do without the templates.
+static void decode_generic(nRFSpiMode_e mode, const SpiSckEdges& sck, EdgeListSampler& mosi, EdgeListSampler& miso, SpiTransactionBuffer& spi_bytes)
+{
+	BitState sck_state = sck.mInitialState;
+	SpiByte* b = NULL;
+	int num_bits = 0;
+
+	for (U32 e = 0; e < sck.mNumEdges; ++e)
+	{
+		U64 position = sck.mEdges[e];
+		sck_state = Toggle(sck_state);
+
+		if ((sck_state == BIT_HIGH) != SpiSamplesOnRisingEdge(mode))
+		{
+			// the edge after the last bit ends a CPHA=0 byte
+			if (num_bits == 8)
+			{
+				b->mEndingSample = position;
+				spi_bytes.AppendNext();
+				num_bits = 0;
+			}
+
+			continue;
+		}
+
+		if (num_bits == 0)
+		{
+			b = &spi_bytes.Next();
+			b->Clear();
+			if (!SpiSamplesOnRisingEdge(mode))
+				b->mFlags = SAMPLED_ON_FALLING_EDGE;
+			b->SetBitSample(0, position);
+		}
+
+		b->mValMiso = (b->mValMiso << 1) | (miso.At(position) == BIT_HIGH ? 1 : 0);
+		b->mValMosi = (b->mValMosi << 1) | (mosi.At(position) == BIT_HIGH ? 1 : 0);
+
+		if (++num_bits == 8  &&  !SpiSamplesOnLeadingEdge(mode))
+		{
+			b->mEndingSample = position;
+			spi_bytes.AppendNext();
+			num_bits = 0;
+		}
+	}
+}
+
+static U64 hash_spi_bytes(U64 hash, const SpiTransactionBuffer& spi_bytes)
+{
+	for (const SpiByte* b = spi_bytes.begin(); b != spi_bytes.end(); ++b)
+	{
+		U64 fields[] = {b->mStartingSample, b->mEndingSample, U64(b->mValMosi) << 16 | U64(b->mValMiso) << 8 | b->mFlags};
+		hash = hash_bytes(hash, fields, sizeof(fields));
+	}
+
+	return hash;
+}
+
+// decodes an SpiBus with DECODE and returns the hash of the bytes, the timed runs don't hash
+template <typename DECODE>
+static U64 decode_bus(const SpiBus& bus, double& ns_per_byte, DECODE decode)
+{
+	const int NUM_RUNS = 10;
+	SpiTransactionBuffer spi_bytes;
+	U64 check = 0;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (int run = 0; run < NUM_RUNS; ++run)
+	{
+		EdgeListSampler mosi(bus.mMosiEdges), miso(bus.mMisoEdges);
+		for (size_t w = 0; w < bus.mWindows.size(); ++w)
+		{
+			spi_bytes.clear();
+			decode(bus.mWindows[w], mosi, miso, spi_bytes);
+			check += spi_bytes.size();
+		}
+	}
+	ns_per_byte = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / (NUM_RUNS * bus.mNumBytes);
+
+	EdgeListSampler mosi(bus.mMosiEdges), miso(bus.mMisoEdges);
+	U64 hash = hash_bytes(0xcbf29ce484222325ull, &check, sizeof(check));
+	for (size_t w = 0; w < bus.mWindows.size(); ++w)
+	{
+		spi_bytes.clear();
+		decode(bus.mWindows[w], mosi, miso, spi_bytes);
+		hash = hash_spi_bytes(hash, spi_bytes);
+	}
+
+	return hash;
+}
+
+template <nRFSpiMode_e MODE>
+static bool bench_spi_mode(const char* name)
+{
+	SpiBus bus(MODE, 2000);
+
+	double specialized_ns, generic_ns;
+	U64 specialized = decode_bus(bus, specialized_ns, DecodeSpiBytes<MODE, false, EdgeListSampler, EdgeListSampler>);
+	U64 generic = decode_bus(bus, generic_ns,
+						[](const SpiSckEdges& sck, EdgeListSampler& mosi, EdgeListSampler& miso, SpiTransactionBuffer& spi_bytes)
+						{
+							decode_generic(MODE, sck, mosi, miso, spi_bytes);
+						});
+
+	::printf("spi %s:     %.2f ns/byte specialized, %.2f ns/byte generic", name, specialized_ns, generic_ns);
+
+	if (specialized != generic)
+	{
+		::printf("\n");
+		::fprintf(stderr, "FAIL: spi %s specialized and generic loops decoded different bytes\n", name);
+		return false;
+	}
+
+	// the heuristics of the auto mode get mode 0 right
+	if (MODE == SPI_MODE_0)
+	{
+		double auto_ns;
+		U64 auto_hash = decode_bus(bus, auto_ns, DecodeSpiBytes<SPI_MODE_AUTO, false, EdgeListSampler, EdgeListSampler>);
+		::printf(", %.2f ns/byte auto", auto_ns);
+
+		if (auto_hash != specialized)
+		{
+			::printf("\n");
+			::fprintf(stderr, "FAIL: spi %s auto decoded different bytes\n", name);
+			return false;
+		}
+	}
+
+	::printf("\n");
+
+	return true;
+}
+
+// filtered exports, against the same filters written out by hand
+static bool check_filtered_export(AnalyzerSettings* settings, nRF24L01_AnalyzerResults* results, const char* file,
+									U64 trigger_sample, U32 sample_rate, U64 from_sample, U64 to_sample)
+{
+	static const U8 PATTERN[] = {0x05, 0x04, 0x03};
+	std::vector<U64> payload_frames;
+	results->FindPayload(PATTERN, sizeof(PATTERN), payload_frames);
+
+	U64 from_time = trigger_sample + sample_rate / 100, to_time = trigger_sample + sample_rate / 20;
+
+	struct Query
+	{
+		const char*		mFilter;
+		std::function<bool (U64 fcnt, const nRFCommandInfo& info, U8 status, U8 radio, U64 start)>	mMatches;
+	};
+
+	const Query QUERIES[] = {
+		{"W_TX_PAYLOAD_NOACK",
+			[&](U64, const nRFCommandInfo& info, U8, U8, U64) { return info.mCommand == W_TX_PAYLOAD_NOACK; }},
+		{"nop && tx_ds",
+			[&](U64, const nRFCommandInfo& info, U8 status, U8, U64) { return info.mCommand == NOP  &&  (status & STATUS_TX_DS); }},
+		{"reg=RF_CH or reg=0x07",
+			[&](U64, const nRFCommandInfo& info, U8, U8, U64) { return (info.mFlags & CMD_IS_REGISTER)  &&  (info.mRegister == 5  ||  info.mRegister == 7); }},
+		{"not (NOP or R_REGISTER) and pipe=0 and time>=0.01 and time<=0.05",
+			[&](U64, const nRFCommandInfo& info, U8 status, U8, U64 start) {
+				return info.mCommand != NOP  &&  info.mCommand != R_REGISTER  &&  ((status >> 1) & 7) == 0
+						&&  start >= from_time  &&  start <= to_time; }},
+		{"W_TX_PAYLOAD and data has 050403",
+			[&](U64 fcnt, const nRFCommandInfo& info, U8, U8, U64) {
+				return info.mCommand == W_TX_PAYLOAD  &&  std::binary_search(payload_frames.begin(), payload_frames.end(), fcnt + 1); }},
+		{"(RX_DR or MAX_RT) and !W_REGISTER",
+			[&](U64, const nRFCommandInfo& info, U8 status, U8, U64) { return (status & (STATUS_RX_DR | STATUS_MAX_RT))  &&  info.mCommand != W_REGISTER; }},
+		{"",
+			[&](U64, const nRFCommandInfo&, U8, U8, U64) { return true; }},
+	};
+
+	U64 num_frames = results->GetNumFrames();
+	for (size_t q = 0; q < sizeof(QUERIES) / sizeof(QUERIES[0]); ++q)
+	{
+		if (!set_text(settings, "Export filter", QUERIES[q].mFilter)  ||  !settings->SetSettingsFromInterfaces())
+		{
+			::fprintf(stderr, "FAIL: filter '%s' rejected: %s\n", QUERIES[q].mFilter, settings->GetErrorText());
+			return false;
+		}
+
+		results->GenerateExportFile(file, Hexadecimal, EXPORT_FILTERED);
+
+		U64 expected = 0;
+		for (U64 fcnt = 0; fcnt < num_frames; ++fcnt)
+		{
+			Frame f = results->GetFrame(fcnt);
+			U64 start = f.mStartingSampleInclusive;
+			if ((f.mFlags & IS_COMMAND)  &&  start >= from_sample  &&  start <= to_sample
+					&&  QUERIES[q].mMatches(fcnt, GetCommandInfo(U8(f.mData1)), U8(f.mData2), f.mType, start))
+				++expected;
+		}
+
+		if (results->GetExportedRows() != expected)
+		{
+			::fprintf(stderr, "FAIL: filter '%s' exported %llu rows, expected %llu\n", QUERIES[q].mFilter, results->GetExportedRows(), expected);
+			return false;
+		}
+	}
+
+	// and the ones that shouldn't compile
+	static const char* const BAD_FILTERS[] = {"reg=FOO", "NOP and", "(NOP", "data has 123", "time>0", "pipe=8", "csn=0", "csn=5", "NOP NOP"};
+	for (size_t b = 0; b < sizeof(BAD_FILTERS) / sizeof(BAD_FILTERS[0]); ++b)
+	{
+		set_text(settings, "Export filter", BAD_FILTERS[b]);
+		if (settings->SetSettingsFromInterfaces())
+		{
+			::fprintf(stderr, "FAIL: bad filter '%s' accepted\n", BAD_FILTERS[b]);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// sets the analyzer up from the options and starts its simulation as the capture
+static bool setup_analyzer(nRF24L01_Analyzer& analyzer, HeadlessCapture& capture, const BenchOptions& opt)
+{
+	AnalyzerSettings* settings = analyzer.GetAnalyzerSettings();
+	if (!set_channel(settings, "MOSI", MOSI_CH)  ||  !set_channel(settings, "MISO", MISO_CH)
+			||  !set_channel(settings, "SCK", SCK_CH)  ||  !set_channel(settings, "CSN", CSN_CH))
+	{
+		::fprintf(stderr, "channel settings not found\n");
+		return false;
+	}
+
+	for (U32 radio = 1; radio < opt.mRadios; ++radio)
+	{
+		if (!set_channel(settings, nRF24L01_AnalyzerSettings::GetCsnName(radio), MORE_CSN_CH[radio - 1]))
+		{
+			::fprintf(stderr, "%s setting not found\n", nRF24L01_AnalyzerSettings::GetCsnName(radio));
+			return false;
+		}
+	}
+
+	if (!set_number(settings, "Decoder", opt.mDecoder)  ||  !set_number(settings, "Markers", opt.mMarkers)
+			||  !set_number(settings, "SPI mode", opt.mSpiMode)
+			||  !set_integer(settings, "Payload RAM (MB)", opt.mPayloadRamMB))
+	{
+		::fprintf(stderr, "decoder settings not found\n");
+		return false;
+	}
+
+	if (!settings->SetSettingsFromInterfaces())
+	{
+		::fprintf(stderr, "settings rejected: %s\n", settings->GetErrorText());
+		return false;
+	}
+
+	analyzer.SetCapture(&capture);
+	analyzer.SetSimulateOversizeBursts(true);
+	if (opt.mLiveChunk > 0)
+	{
+		capture.UseSimulation(&analyzer, CSN_CH, opt.mTransactions, opt.mLiveChunk);
+		capture.SetLive(true);
+	} else {
+		capture.UseSimulation(&analyzer, CSN_CH, opt.mTransactions);
+	}
+
+	// The simulation has started with all the channels. The bus still has them,
+	// the decoder just doesn't get them, so the CSN windows can be counted the same.
+	if (opt.mNoCsn  ||  opt.mNoMiso)
+	{
+		// between the bytes SCK pauses for about 2 half periods, between the commands for 14
+		U64 gap_ns = opt.mSckGapNs > 0 ? opt.mSckGapNs : 8 * 5 * 1000000000ull / opt.mSampleRate;
+
+		if ((opt.mNoCsn  &&  !set_channel(settings, "CSN", UNDEFINED_CHANNEL))
+				||  (opt.mNoMiso  &&  !set_channel(settings, "MISO", UNDEFINED_CHANNEL))
+				||  !set_integer(settings, "SCK idle gap (ns)", int(gap_ns))
+				||  !settings->SetSettingsFromInterfaces())
+		{
+			::fprintf(stderr, "settings rejected: %s\n", settings->GetErrorText());
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// Decodes the same capture again offline, on 1, 2, 4... threads.
+// The results have to be the same as the streaming decoder's.
+static bool check_offline_decode(const BenchOptions& opt, U64 results_hash, double streaming_s)
+{
+	nRF24L01_Analyzer analyzer;
+	HeadlessCapture capture(opt.mSampleRate);
+	if (!setup_analyzer(analyzer, capture, opt))
+		return false;
+
+	// CSN first, the capture ends on that
+	nRFBusEdges bus;
+	load_transitions(capture, CSN_CH, bus.mCsns[0].mInitialState, bus.mCsns[0].mEdges);
+	for (U32 radio = 1; radio < opt.mRadios; ++radio)
+		load_transitions(capture, MORE_CSN_CH[radio - 1], bus.mCsns[radio].mInitialState, bus.mCsns[radio].mEdges);
+	load_transitions(capture, MOSI_CH, bus.mMosi.mInitialState, bus.mMosi.mEdges);
+	load_transitions(capture, MISO_CH, bus.mMiso.mInitialState, bus.mMiso.mEdges);
+	load_transitions(capture, SCK_CH, bus.mSck.mInitialState, bus.mSck.mEdges);
+
+	// the two passes alone, without making the frames
+	nRF24L01_AnalyzerSettings* settings = (nRF24L01_AnalyzerSettings*) analyzer.GetAnalyzerSettings();
+	nRFSegmentDecoder decoder(settings->mSpiMode, opt.mMarkers == MARKERS_SCK  ||  opt.mMarkers == MARKERS_FULL);
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	decoder.FindWindows(bus.mCsns, opt.mRadios);
+	double scan_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	U64 num_bytes = 0;
+	start = std::chrono::steady_clock::now();
+	decoder.Decode(bus.mSck, bus.mMosi, opt.mNoMiso ? NULL : &bus.mMiso, 1,
+					[&num_bytes](const nRFSegmentDecoder::Window&, const SpiTransactionBuffer& spi_bytes)
+					{
+						num_bytes += spi_bytes.size();
+					});
+	double bytes_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	::printf("offline passes: %llu windows scanned in %.3f s, %llu bytes decoded in %.3f s on one thread\n",
+				U64(decoder.GetNumWindows()), scan_s, num_bytes, bytes_s);
+
+	double one_thread_s = 0;
+	for (U32 num_threads = 1;; num_threads *= 2)
+	{
+		if (num_threads > opt.mOfflineThreads)
+			num_threads = opt.mOfflineThreads;
+
+		start = std::chrono::steady_clock::now();
+		bool decoded = analyzer.DecodeOffline(bus, num_threads);
+		double decode_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		if (!decoded)
+		{
+			::fprintf(stderr, "FAIL: the offline decoder refused the settings\n");
+			return false;
+		}
+
+		if (num_threads == 1)
+			one_thread_s = decode_s;
+
+		nRF24L01_AnalyzerResults* results = (nRF24L01_AnalyzerResults*) analyzer.GetAnalyzerResults();
+		U64 num_transactions;
+		U64 hash = hash_results(results, num_transactions);
+
+		::printf("offline decode: %u threads, %.3f s, %.0f transactions/s, %.2fx one thread, %.2fx streaming\n",
+					num_threads, decode_s, num_transactions / decode_s, one_thread_s / decode_s, streaming_s / decode_s);
+
+		if (hash != results_hash)
+		{
+			::fprintf(stderr, "FAIL: the offline decode on %u threads made different results\n", num_threads);
+			return false;
+		}
+
+		if (num_threads == opt.mOfflineThreads)
+			break;
+	}
+
+	return true;
+}
+
+// Writes the simulated capture as packed samples with bit n for channel n, like a logic analyzer
+// would record it, so nrf24-decode can be checked against the bench. The channels are merged edge
+// by edge as the simulation makes them, none of it is kept.
+static bool save_capture(const BenchOptions& opt, U64& num_samples, double& save_s)
+{
+	nRF24L01_Analyzer analyzer;
+	HeadlessCapture capture(opt.mSampleRate);
+	if (!setup_analyzer(analyzer, capture, opt))
+		return false;
+
+	// the bus has all the channels, whatever the decoder was given
+	std::vector<AnalyzerChannelData*> channels;
+	channels.push_back(capture.GetChannelData(MOSI_CH));
+	channels.push_back(capture.GetChannelData(MISO_CH));
+	channels.push_back(capture.GetChannelData(SCK_CH));
+	channels.push_back(capture.GetChannelData(CSN_CH));
+	for (U32 radio = 1; radio < opt.mRadios; ++radio)
+		channels.push_back(capture.GetChannelData(MORE_CSN_CH[radio - 1]));
+
+	FILE* file = ::fopen(opt.mCaptureFile, "wb");
+	if (file == NULL)
+	{
+		::fprintf(stderr, "FAIL: can't write %s\n", opt.mCaptureFile);
+		return false;
+	}
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	U8 state = 0;
+	for (size_t c = 0; c < channels.size(); ++c)
+		state |= channels[c]->GetBitState() == BIT_HIGH ? U8(1 << c) : 0;
+
+	std::vector<U8> run(1 << 20);
+	U64 sample = 0;
+
+	// writes the samples up to to_sample in the current state
+	auto write_to = [&](U64 to_sample)
+	{
+		while (sample < to_sample)
+		{
+			size_t num = size_t(std::min<U64>(run.size(), to_sample - sample));
+			std::fill(run.begin(), run.begin() + num, state);
+			::fwrite(run.data(), 1, num, file);
+			sample += num;
+		}
+	};
+
+	for (;;)
+	{
+		U64 next = ~U64(0);
+		for (size_t c = 0; c < channels.size(); ++c)
+		{
+			if (channels[c]->DoMoreTransitionsExistInCurrentData())
+				next = std::min(next, channels[c]->GetSampleOfNextEdge());
+		}
+
+		if (next == ~U64(0))
+			break;
+
+		write_to(next);
+
+		for (size_t c = 0; c < channels.size(); ++c)
+		{
+			if (channels[c]->DoMoreTransitionsExistInCurrentData()  &&  channels[c]->GetSampleOfNextEdge() == next)
+			{
+				channels[c]->AdvanceToNextEdge();
+				state ^= U8(1 << c);
+			}
+		}
+	}
+
+	// a sample after the last edge too, or it wouldn't be in the file
+	write_to(std::max(capture.GetEndSample(), sample + 1));
+
+	bool written = ::ferror(file) == 0;
+	written = ::fclose(file) == 0  &&  written;
+
+	num_samples = sample;
+	save_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	return written;
+}
+
+int main(int argc, char* argv[])
+{
+	BenchOptions opt;
+	if (!parse_options(argc, argv, opt))
+		usage();
+
+	nRF24L01_Analyzer analyzer;
+	HeadlessCapture capture(opt.mSampleRate);
+	if (!setup_analyzer(analyzer, capture, opt))
+		return 1;
+
+	AnalyzerSettings* settings = analyzer.GetAnalyzerSettings();
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	capture.RunWorker(&analyzer);
+	double total_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	// the simulation runs interleaved with the decoder; don't count it
+	double decode_s = total_s - capture.GetLoadSeconds();
+
+	nRF24L01_AnalyzerResults* results = (nRF24L01_AnalyzerResults*) analyzer.GetAnalyzerResults();
+	U64 num_transactions;
+	U64 hash = hash_results(results, num_transactions);
+
+	::printf("transactions:   %llu\n", num_transactions);
+	::printf("frames:         %llu\n", results->GetNumFrames());
+	::printf("markers:        %llu (%.1f MB)\n", results->GetMarkerCount(), results->GetMarkerBytes() / 1048576.0);
+	::printf("commits:        %llu\n", results->GetNumCommits());
+	const nRFPayloadStore& payloads = results->GetExtendedData();
+	::printf("long payloads:  %llu (%llu interned, %llu deltas), %.2fx compression\n",
+				payloads.GetNumPayloads(), payloads.GetNumInterned(), payloads.GetNumDeltas(), payloads.GetCompressionRatio());
+	::printf("payload store:  %.1f MB in RAM, %.1f MB on disk\n",
+				payloads.GetArena().GetResidentBytes() / 1048576.0, payloads.GetArena().GetSpilledBytes() / 1048576.0);
+	::printf("edges:          %llu\n", capture.GetNumTransitions());
+	::printf("capture:        %.3f s\n", double(capture.GetEndSample()) / opt.mSampleRate);
+	::printf("simulation:     %.3f s\n", capture.GetLoadSeconds());
+	::printf("decode:         %.3f s\n", decode_s);
+	::printf("transactions/s: %.0f\n", num_transactions / decode_s);
+	::printf("edges/s:        %.0f\n", capture.GetNumTransitions() / decode_s);
+	::printf("peak RSS:       %.1f MB\n", peak_rss_mb());
+	::printf("results hash:   %016llx\n", hash);
+	::printf("content hash:   %016llx\n", hash_content(results));
+
+	if (opt.mRadios > 1)
+	{
+		U64 per_radio[MAX_RADIOS] = {0};
+		for (U64 fcnt = 0; fcnt < results->GetNumFrames(); ++fcnt)
+		{
+			Frame f = results->GetFrame(fcnt);
+			if (f.mFlags & IS_COMMAND)
+				++per_radio[f.mType];
+		}
+
+		::printf("radios:        ");
+		for (U32 radio = 0; radio < opt.mRadios; ++radio)
+			::printf(" %s %llu", nRF24L01_AnalyzerSettings::GetCsnName(radio), per_radio[radio]);
+		::printf("\n");
+	}
+
+	if (num_transactions > 0)
+	{
+		if (!check_register_shadow(results))
+			return 1;
+
+		const U64 NUM_QUERIES = 1000000;
+		U32 check;
+		double shadow_s = time_register_shadow(results, NUM_QUERIES, check);
+
+		U64 num_changes = 0, num_checkpoints = 0;
+		for (U32 radio = 0; radio < opt.mRadios; ++radio)
+		{
+			num_changes += results->GetRegisterShadow(radio).GetNumChanges();
+			num_checkpoints += results->GetRegisterShadow(radio).GetNumCheckpoints();
+		}
+
+		::printf("register shadow: %llu changes, %llu checkpoints, %.0f ns per lookup (%u)\n",
+					num_changes, num_checkpoints, shadow_s * 1e9 / NUM_QUERIES, check);
+	}
+
+	if (num_transactions > 0)
+	{
+		if (!check_operations(results, num_transactions))
+			return 1;
+
+		U64 operations_hash;
+		double operations_s = render_operations(results, operations_hash);
+		U64 num_operations = results->GetOperations().GetNumOperations();
+
+		::printf("operations:     %llu, %llu packet and transaction texts in %.3f s\n",
+					num_operations, num_operations + results->GetNumPackets(), operations_s);
+		::printf("operations hash: %016llx\n", operations_hash);
+	}
+
+	if (num_transactions > 0)
+	{
+		double indexed_s, scan_s;
+		U64 num_found;
+		if (!check_payload_search(results, indexed_s, scan_s, num_found))
+			return 1;
+
+		const nRFPayloadIndex& index = results->GetPayloadIndex();
+		::printf("payload index:  %llu payloads, %.1f MB%s\n", index.GetNumPayloads(), index.GetMemoryBytes() / 1048576.0,
+					index.GetIndexedEnd() < results->GetNumFrames() ? ", full" : "");
+		::printf("payload search: %llu found, %.3f ms with the index, %.3f ms without\n", num_found, indexed_s * 1000, scan_s * 1000);
+	}
+
+	if (num_transactions > 0)
+	{
+		double indexed_us, search_us;
+		if (!check_sample_index(results, capture.GetEndSample(), indexed_us, search_us))
+			return 1;
+
+		::printf("sample index:   %.1f MB, %.2f us per lookup with the index, %.2f us without\n",
+					results->GetSampleIndex().GetMemoryBytes() / 1048576.0, indexed_us, search_us);
+	}
+
+	if (num_transactions > 0)
+	{
+		double indexed_us, scan_us;
+		if (!check_event_index(results, capture.GetEndSample(), indexed_us, scan_us))
+			return 1;
+
+		const nRFEventIndex& events = results->GetEventIndex();
+		::printf("event index:    %.1f MB, %.1f us per jump with the index, %.1f us without\n",
+					events.GetMemoryBytes() / 1048576.0, indexed_us, scan_us);
+	}
+
+	const nRFStatistics& stats = results->GetStatistics();
+	U64 command_total = 0;
+	for (U8 cmd = 0; cmd <= undefined_cmd; ++cmd)
+		command_total += stats.GetCommandCount(cmd);
+
+	if (stats.GetNumTransactions() != num_transactions  ||  command_total != num_transactions)
+	{
+		::fprintf(stderr, "FAIL: statistics counted %llu transactions, %llu commands\n", stats.GetNumTransactions(), command_total);
+		return 1;
+	}
+
+	::printf("statistics:     %llu TX_DS, %llu MAX_RT, %llu RX_DR, %llu windows\n",
+				stats.GetEventCount(EVENT_TX_DS), stats.GetEventCount(EVENT_MAX_RT), stats.GetEventCount(EVENT_RX_DR), stats.GetNumWindows());
+	::printf("oversize bursts: %llu, %.3f s of %.3f s skipped\n", stats.GetNumOversizeBursts(),
+				double(stats.GetOversizeSamples()) / opt.mSampleRate, double(capture.GetEndSample()) / opt.mSampleRate);
+
+	if (!bench_spi_mode<SPI_MODE_0>("mode 0")  ||  !bench_spi_mode<SPI_MODE_1>("mode 1")
+			||  !bench_spi_mode<SPI_MODE_2>("mode 2")  ||  !bench_spi_mode<SPI_MODE_3>("mode 3"))
+		return 1;
+
+	if (opt.mBubbleViews > 0)
+	{
+		U64 num_texts;
+		U64 allocations = g_allocations;
+		start = std::chrono::steady_clock::now();
+		U64 bubble_hash = render_bubbles(results, opt.mBubbleViews, num_texts);
+		double bubbles_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		allocations = g_allocations - allocations;
+
+		const nRFCommandCache& cache = results->GetCommandCache();
+		::printf("bubble texts:   %llu in %.3f s, %.0f/s\n", num_texts, bubbles_s, num_texts / bubbles_s);
+		::printf("allocations:    %llu, %.3f per text\n", allocations, double(allocations) / num_texts);
+		::printf("command cache:  %llu hits, %llu misses\n", cache.GetHits(), cache.GetMisses());
+		::printf("bubble hash:    %016llx\n", bubble_hash);
+	}
+
+	results->SetExportRange(opt.mExportFrom, opt.mExportTo);
+
+	if (opt.mExportFile != NULL)
+	{
+		U64 allocations = g_allocations;
+		start = std::chrono::steady_clock::now();
+		results->GenerateExportFile(opt.mExportFile, Hexadecimal, 0);
+		double export_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		allocations = g_allocations - allocations;
+
+		U64 num_rows = results->GetExportedRows();
+		::printf("export:         %llu rows in %.3f s, %.0f rows/s\n", num_rows, export_s, num_rows / export_s);
+		::printf("allocations:    %llu, %.3f per row\n", allocations, double(allocations) / num_rows);
+	}
+
+	if (opt.mBinaryExportFile != NULL)
+	{
+		start = std::chrono::steady_clock::now();
+		results->GenerateExportFile(opt.mBinaryExportFile, Hexadecimal, EXPORT_BINARY);
+		double export_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		double read_s;
+		U64 num_rows = results->GetExportedRows();
+		if (!check_binary_export(results, opt.mBinaryExportFile, opt.mExportFrom, opt.mExportTo, read_s))
+			return 1;
+
+		::printf("binary export:  %llu rows in %.3f s, %.0f rows/s\n", num_rows, export_s, num_rows / export_s);
+		::printf("binary read:    %.3f s, %.0f rows/s\n", read_s, num_rows / read_s);
+	}
+
+	if (opt.mFilteredFile != NULL)
+	{
+		if (!check_filtered_export(settings, results, opt.mFilteredFile, analyzer.GetTriggerSample(), opt.mSampleRate,
+									opt.mExportFrom, opt.mExportTo))
+			return 1;
+
+		if (!set_text(settings, "Export filter", opt.mFilter)  ||  !settings->SetSettingsFromInterfaces())
+		{
+			::fprintf(stderr, "filter rejected: %s\n", settings->GetErrorText());
+			return 1;
+		}
+
+		start = std::chrono::steady_clock::now();
+		results->GenerateExportFile(opt.mFilteredFile, Hexadecimal, EXPORT_FILTERED);
+		double export_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		::printf("filtered export: %llu rows in %.3f s\n", results->GetExportedRows(), export_s);
+	}
+
+	if (opt.mStatisticsFile != NULL)
+	{
+		start = std::chrono::steady_clock::now();
+		results->GenerateExportFile(opt.mStatisticsFile, Hexadecimal, EXPORT_STATISTICS);
+		double export_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		::printf("statistics export: %.3f ms\n", export_s * 1000);
+	}
+
+	// Every CSN window of the simulation is either a valid command or an oversize burst.
+	// The capture ends on the first CSN, the others have had however many pulses by then.
+	U64 num_windows = opt.mTransactions;
+	for (U32 radio = 1; radio < opt.mRadios; ++radio)
+		num_windows += capture.GetChannelData(MORE_CSN_CH[radio - 1])->GetNumTransitionsLoaded() / 2;
+
+	if (num_transactions + stats.GetNumOversizeBursts() != num_windows)
+	{
+		::fprintf(stderr, "FAIL: decoded %llu transactions and %llu oversize bursts, expected %llu in all\n",
+					num_transactions, stats.GetNumOversizeBursts(), num_windows);
+		return 1;
+	}
+
+	// nothing may be left uncommitted once the decoder has caught up with the end of the capture
+	if (results->GetNumCommittedFrames() != results->GetNumFrames())
+	{
+		::fprintf(stderr, "FAIL: %llu of %llu frames committed\n", results->GetNumCommittedFrames(), results->GetNumFrames());
+		return 1;
+	}
+
+	// the offline decoder finds the windows by CSN
+	if (opt.mOfflineThreads > 0  &&  opt.mNoCsn)
+		::printf("offline decode: needs CSN\n");
+	else if (opt.mOfflineThreads > 0  &&  !check_offline_decode(opt, hash, decode_s))
+		return 1;
+
+	if (opt.mCaptureFile != NULL)
+	{
+		U64 num_samples;
+		double save_s;
+		if (!save_capture(opt, num_samples, save_s))
+			return 1;
+
+		::printf("saved capture:  %llu samples in %.3f s\n", num_samples, save_s);
+	}
+
+	return 0;
+}
@@ -0,0 +1,657 @@
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+#include "nRFCaptureReaders.h"
+
+static bool parse_number(const char* text, U64& number)
+{
+	char* end;
+	number = ::strtoull(text, &end, 10);
+	return end != text  &&  *end == '\0';
+}
+
+bool nRFCaptureReader::FindChannel(const char* name, U32& channel_index) const
+{
+	U64 number;
+	if (!parse_number(name, number)  ||  number > 0xFFFF)
+		return false;
+
+	BitState state;
+	channel_index = U32(number);
+	return const_cast<nRFCaptureReader*>(this)->GetInitialState(channel_index, state);
+}
+
+nRFFileStream::nRFFileStream()
+:	mFile(NULL),
+	mBuffer(BUFFER_SIZE),
+	mPos(0),
+	mFill(0)
+{}
+
+nRFFileStream::~nRFFileStream()
+{
+	if (mFile != NULL  &&  mFile != stdin)
+		::fclose(mFile);
+}
+
+bool nRFFileStream::Open(const char* path)
+{
+	mFile = ::strcmp(path, "-") == 0 ? stdin : ::fopen(path, "rb");
+	return mFile != NULL;
+}
+
+bool nRFFileStream::Fill()
+{
+	mPos = 0;
+	mFill = ::fread(mBuffer.data(), 1, BUFFER_SIZE, mFile);
+	return mFill > 0;
+}
+
+size_t nRFFileStream::Peek(const U8*& data, size_t size)
+{
+	if (mPos == mFill  &&  !Fill())
+		return 0;
+
+	data = mBuffer.data() + mPos;
+	return std::min(size, mFill - mPos);
+}
+
+bool nRFFileStream::Read(void* data, size_t size)
+{
+	U8* write = (U8*) data;
+	while (size > 0)
+	{
+		const U8* read;
+		size_t got = Peek(read, size);
+		if (got == 0)
+			return false;
+
+		::memcpy(write, read, got);
+		Skip(got);
+
+		write += got;
+		size -= got;
+	}
+
+	return true;
+}
+
+//
+// packed samples
+//
+
+nRFPackedReader::nRFPackedReader(U32 sample_bytes)
+:	mSampleBytes(sample_bytes),
+	mSample(0),
+	mState(0),
+	mMask(0),
+	mAtEnd(false)
+{}
+
+bool nRFPackedReader::Open(const char* path, std::string& error)
+{
+	if (mSampleRate == 0)
+	{
+		error = "the sample rate isn't in the file";
+		return false;
+	}
+
+	if (!mFile.Open(path))
+	{
+		error = std::string("can't open ") + path;
+		return false;
+	}
+
+	// the first sample is the initial state, it's read again as sample 0 but nothing changes there
+	const U8* data;
+	if (mFile.Peek(data, mSampleBytes) < mSampleBytes)
+	{
+		error = "the capture is empty";
+		return false;
+	}
+
+	::memcpy(&mState, data, mSampleBytes);
+
+	return true;
+}
+
+bool nRFPackedReader::GetInitialState(U32 channel_index, BitState& state)
+{
+	if (channel_index >= mSampleBytes * 8)
+		return false;
+
+	state = (mState >> channel_index) & 1 ? BIT_HIGH : BIT_LOW;
+	return true;
+}
+
+template <typename T>
+size_t nRFPackedReader::Scan(const U8* data, size_t num_samples, U64 end_sample, const std::vector<AnalyzerChannelData*>& channels)
+{
+	T state = T(mState), mask = T(mMask);
+
+	size_t num = size_t(std::min<U64>(num_samples, end_sample - mSample));
+	for (size_t c = 0; c < num; ++c)
+	{
+		T value;
+		::memcpy(&value, data + c * sizeof(T), sizeof(T));
+
+		// mostly nothing changes
+		T changed = (value ^ state) & mask;
+		if (changed == 0)
+			continue;
+
+		for (U32 channel_index = 0; changed != 0; ++channel_index, changed >>= 1)
+		{
+			if (changed & 1)
+				channels[channel_index]->AppendTransition(mSample + c);
+		}
+
+		state = value;
+	}
+
+	mState = state;
+
+	return num;
+}
+
+bool nRFPackedReader::Read(U64& end_sample, const std::vector<AnalyzerChannelData*>& channels)
+{
+	// only the channels that are read can change
+	mMask = 0;
+	for (size_t c = 0; c < channels.size()  &&  c < mSampleBytes * 8; ++c)
+	{
+		if (channels[c] != NULL)
+			mMask |= U64(1) << c;
+	}
+
+	while (!mAtEnd  &&  mSample < end_sample)
+	{
+		const U8* data;
+		size_t num_samples = mFile.Peek(data, ~size_t(0)) / mSampleBytes;
+
+		// a partial sample at the end doesn't count
+		if (num_samples == 0)
+		{
+			mAtEnd = true;
+			break;
+		}
+
+		size_t num;
+		switch (mSampleBytes)
+		{
+		case 1:		num = Scan<U8>(data, num_samples, end_sample, channels);	break;
+		case 2:		num = Scan<U16>(data, num_samples, end_sample, channels);	break;
+		case 4:		num = Scan<U32>(data, num_samples, end_sample, channels);	break;
+		default:	num = Scan<U64>(data, num_samples, end_sample, channels);	break;
+		}
+
+		mFile.Skip(num * mSampleBytes);
+		mSample += num;
+	}
+
+	if (mAtEnd)
+		end_sample = mSample;
+
+	return !mAtEnd;
+}
+
+//
+// Saleae Logic 2 binary export
+//
+
+#define SALEAE_MAGIC			"<SALEAE>"
+#define SALEAE_MAX_CHANNELS		64
+
+nRFSaleaeReader::nRFSaleaeReader()
+:	mBeginTime(0),
+	mEndTime(0),
+	mLastSample(0)
+{}
+
+nRFSaleaeReader::~nRFSaleaeReader()
+{
+	for (size_t c = 0; c < mChannels.size(); ++c)
+		delete mChannels[c];
+}
+
+bool nRFSaleaeReader::OpenChannel(const std::string& path, ChannelFile& channel, std::string& error)
+{
+	if (!channel.mFile.Open(path.c_str()))
+		return false;
+
+	// the digital files are the same in versions 0 and 1
+	char magic[8];
+	S32 version, type;
+	U32 initial_state;
+	if (!channel.mFile.Read(magic, sizeof(magic))  ||  ::memcmp(magic, SALEAE_MAGIC, sizeof(magic)) != 0
+			||  !channel.mFile.Read(&version, sizeof(version))  ||  !channel.mFile.Read(&type, sizeof(type))
+			||  (version != 0  &&  version != 1)  ||  type != 0
+			||  !channel.mFile.Read(&initial_state, sizeof(initial_state))
+			||  !channel.mFile.Read(&channel.mBeginTime, sizeof(channel.mBeginTime))
+			||  !channel.mFile.Read(&channel.mEndTime, sizeof(channel.mEndTime))
+			||  !channel.mFile.Read(&channel.mNumTransitions, sizeof(channel.mNumTransitions)))
+	{
+		error = path + " isn't a digital channel of a Logic 2 binary export";
+		return false;
+	}
+
+	channel.mInitialState = initial_state ? BIT_HIGH : BIT_LOW;
+	channel.mNumRead = 0;
+	channel.mHasNext = false;
+
+	return true;
+}
+
+bool nRFSaleaeReader::Open(const char* path, std::string& error)
+{
+	if (mSampleRate == 0)
+	{
+		error = "the sample rate isn't in the files";
+		return false;
+	}
+
+	// the channels that were exported, they don't have to be all of them
+	for (U32 channel_index = 0; channel_index < SALEAE_MAX_CHANNELS; ++channel_index)
+	{
+		ChannelFile* channel = new ChannelFile;
+		std::string channel_path = std::string(path) + "/digital_" + std::to_string(channel_index) + ".bin";
+		if (!OpenChannel(channel_path, *channel, error))
+		{
+			delete channel;
+			if (!error.empty())
+				return false;
+
+			continue;
+		}
+
+		if (mChannels.empty()  ||  channel->mBeginTime < mBeginTime)
+			mBeginTime = channel->mBeginTime;
+		if (mChannels.empty()  ||  channel->mEndTime > mEndTime)
+			mEndTime = channel->mEndTime;
+
+		mChannels.resize(channel_index + 1, NULL);
+		mChannels[channel_index] = channel;
+	}
+
+	if (mChannels.empty())
+	{
+		error = std::string("no digital_N.bin files in ") + path;
+		return false;
+	}
+
+	// the transitions that round to sample 0 are part of the initial state
+	for (size_t c = 0; c < mChannels.size(); ++c)
+	{
+		ChannelFile* channel = mChannels[c];
+		if (channel == NULL)
+			continue;
+
+		while (ReadNext(*channel)  &&  channel->mNext == 0)
+			channel->mInitialState = Toggle(channel->mInitialState);
+	}
+
+	return true;
+}
+
+U64 nRFSaleaeReader::ToSample(double time) const
+{
+	double sample = ::floor((time - mBeginTime) * mSampleRate + 0.5);
+	return sample > 0 ? U64(sample) : 0;
+}
+
+bool nRFSaleaeReader::ReadNext(ChannelFile& channel)
+{
+	double time;
+	channel.mHasNext = channel.mNumRead < channel.mNumTransitions  &&  channel.mFile.Read(&time, sizeof(time));
+	if (channel.mHasNext)
+	{
+		++channel.mNumRead;
+		channel.mNext = ToSample(time);
+	}
+
+	return channel.mHasNext;
+}
+
+bool nRFSaleaeReader::GetInitialState(U32 channel_index, BitState& state)
+{
+	if (channel_index >= mChannels.size()  ||  mChannels[channel_index] == NULL)
+		return false;
+
+	state = mChannels[channel_index]->mInitialState;
+	return true;
+}
+
+bool nRFSaleaeReader::Read(U64& end_sample, const std::vector<AnalyzerChannelData*>& channels)
+{
+	// past the end everything that's left goes in
+	U64 capture_end = ToSample(mEndTime);
+	bool at_end = end_sample >= capture_end;
+	U64 read_to = at_end ? ~U64(0) : end_sample;
+
+	// the channels nobody wants are never read
+	for (size_t c = 0; c < mChannels.size()  &&  c < channels.size(); ++c)
+	{
+		ChannelFile* channel = mChannels[c];
+		if (channel == NULL  ||  channels[c] == NULL)
+			continue;
+
+		while (channel->mHasNext  &&  channel->mNext < read_to)
+		{
+			channel->mRounder.Add(channel->mNext, channels[c]);
+			mLastSample = std::max(mLastSample, channel->mNext);
+
+			ReadNext(*channel);
+		}
+
+		// the next one is in a later chunk
+		channel->mRounder.Flush(channels[c]);
+	}
+
+	if (at_end)
+		end_sample = std::max(capture_end, mLastSample + 1);
+
+	return !at_end;
+}
+
+//
+// VCD
+//
+
+nRFVcdReader::nRFVcdReader()
+:	mUnitsPerSecond(0),
+	mTime(0),
+	mAtEnd(false)
+{}
+
+// the control characters don't belong in a VCD anyway
+static inline bool is_space(U8 c)
+{
+	return c <= ' ';
+}
+
+bool nRFVcdReader::NextToken(std::string& token)
+{
+	token.clear();
+
+	// straight from the buffer, a token can still straddle two fills of it
+	const U8* data;
+	size_t size;
+	while ((size = mFile.Peek(data, ~size_t(0))) > 0)
+	{
+		size_t c = 0;
+		if (token.empty())
+		{
+			while (c < size  &&  is_space(data[c]))
+				++c;
+		}
+
+		size_t start = c;
+		while (c < size  &&  !is_space(data[c]))
+			++c;
+
+		token.append((const char*) data + start, c - start);
+		mFile.Skip(c);
+
+		if (c < size  &&  !token.empty())
+			return true;
+	}
+
+	return !token.empty();
+}
+
+bool nRFVcdReader::SkipToEnd()
+{
+	while (NextToken(mToken))
+	{
+		if (mToken == "$end")
+			return true;
+	}
+
+	return false;
+}
+
+bool nRFVcdReader::ParseTimescale(std::string& error)
+{
+	// "1ns", or "1 ns"
+	std::string timescale;
+	while (NextToken(mToken)  &&  mToken != "$end")
+		timescale += mToken;
+
+	static const char* const UNITS[] = {"s", "ms", "us", "ns", "ps", "fs"};
+
+	char* unit;
+	U64 number = ::strtoull(timescale.c_str(), &unit, 10);
+
+	U64 per_second = 1;
+	for (size_t u = 0; u < sizeof(UNITS) / sizeof(UNITS[0]); ++u, per_second *= 1000)
+	{
+		if (::strcmp(unit, UNITS[u]) == 0  &&  (number == 1  ||  number == 10  ||  number == 100)  &&  per_second % number == 0)
+		{
+			mUnitsPerSecond = per_second / number;
+			return true;
+		}
+	}
+
+	// 10 s and 100 s don't divide anything, nobody records that slowly anyway
+	error = "can't use the timescale " + timescale;
+	return false;
+}
+
+bool nRFVcdReader::ParseVar(std::string& error)
+{
+	// $var wire 1 ! name [range] $end
+	std::vector<std::string> fields;
+	while (NextToken(mToken)  &&  mToken != "$end")
+		fields.push_back(mToken);
+
+	if (fields.size() < 4)
+	{
+		error = "a $var without a name";
+		return false;
+	}
+
+	// only the single bits are channels
+	if (fields[1] != "1")
+		return true;
+
+	mIds[fields[2]].push_back(U32(mVariables.size()));
+
+	mVariables.push_back(Variable());
+	mVariables.back().mName = fields[3];
+	mVariables.back().mState = BIT_LOW;
+
+	return true;
+}
+
+bool nRFVcdReader::Open(const char* path, std::string& error)
+{
+	if (!mFile.Open(path))
+	{
+		error = std::string("can't open ") + path;
+		return false;
+	}
+
+	// the definitions
+	for (;;)
+	{
+		if (!NextToken(mToken)  ||  mToken[0] != '$')
+		{
+			error = std::string(path) + " isn't a VCD file";
+			return false;
+		}
+
+		if (mToken == "$timescale")
+		{
+			if (!ParseTimescale(error))
+				return false;
+		} else if (mToken == "$var") {
+			if (!ParseVar(error))
+				return false;
+		} else {
+			// $scope, $upscope, $date, $version, $comment; we don't need them
+			bool definitions_done = mToken == "$enddefinitions";
+			if (!SkipToEnd())
+			{
+				error = std::string(path) + " ends in the definitions";
+				return false;
+			}
+
+			if (definitions_done)
+				break;
+		}
+	}
+
+	if (mVariables.empty())
+	{
+		error = std::string(path) + " has no 1-bit variables";
+		return false;
+	}
+
+	// without a timescale it's 1 ns, like most tools write it
+	if (mUnitsPerSecond == 0)
+		mUnitsPerSecond = 1000000000;
+
+	if (mSampleRate == 0)
+	{
+		if (mUnitsPerSecond > 0xFFFFFFFF)
+		{
+			error = "the timescale is finer than any sample rate we can decode at, set one";
+			return false;
+		}
+
+		mSampleRate = mUnitsPerSecond;
+	}
+
+	// whatever is at sample 0, in $dumpvars or not, is the initial state
+	while (NextToken(mToken))
+	{
+		if (mToken[0] == '#')
+		{
+			mTime = ::strtoull(mToken.c_str() + 1, NULL, 10);
+			if (ToSample(mTime) > 0)
+				return true;
+		} else if (mToken == "$comment") {
+			SkipToEnd();
+		} else if (mToken[0] != '$') {
+			ValueChange(mToken, NULL);
+		}
+	}
+
+	mAtEnd = true;
+
+	return true;
+}
+
+bool nRFVcdReader::FindChannel(const char* name, U32& channel_index) const
+{
+	if (nRFCaptureReader::FindChannel(name, channel_index))
+		return true;
+
+	for (size_t c = 0; c < mVariables.size(); ++c)
+	{
+		if (mVariables[c].mName == name)
+		{
+			channel_index = U32(c);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool nRFVcdReader::GetInitialState(U32 channel_index, BitState& state)
+{
+	if (channel_index >= mVariables.size())
+		return false;
+
+	state = mVariables[channel_index].mState;
+	return true;
+}
+
+U64 nRFVcdReader::ToSample(U64 time) const
+{
+	if (mSampleRate == mUnitsPerSecond)
+		return time;
+
+	return U64(::floorl((long double) time * mSampleRate / mUnitsPerSecond + 0.5L));
+}
+
+void nRFVcdReader::ValueChange(const std::string& token, const std::vector<AnalyzerChannelData*>* channels)
+{
+	BitState value;
+	switch (token[0])
+	{
+	case '1':
+		value = BIT_HIGH;
+		break;
+
+	// x and z read as low, like a floating line with a pull-down
+	case '0':	case 'x':	case 'X':	case 'z':	case 'Z':
+		value = BIT_LOW;
+		break;
+
+	// vectors and reals have the identifier in a token of its own
+	case 'b':	case 'B':	case 'r':	case 'R':
+		NextToken(mToken);
+		return;
+
+	default:
+		return;
+	}
+
+	mId.assign(token, 1, std::string::npos);
+	std::unordered_map<std::string, std::vector<U32> >::const_iterator it = mIds.find(mId);
+	if (it == mIds.end())
+		return;
+
+	for (size_t v = 0; v < it->second.size(); ++v)
+	{
+		U32 channel_index = it->second[v];
+		Variable& variable = mVariables[channel_index];
+		if (variable.mState == value)
+			continue;
+
+		variable.mState = value;
+
+		if (channels != NULL)
+		{
+			AnalyzerChannelData* channel = channel_index < channels->size() ? (*channels)[channel_index] : NULL;
+			variable.mRounder.Add(ToSample(mTime), channel);
+		}
+	}
+}
+
+bool nRFVcdReader::Read(U64& end_sample, const std::vector<AnalyzerChannelData*>& channels)
+{
+	// the changes up to the first time that's in a later chunk
+	while (!mAtEnd  &&  ToSample(mTime) < end_sample)
+	{
+		if (!NextToken(mToken))
+		{
+			mAtEnd = true;
+			break;
+		}
+
+		if (mToken[0] == '#')
+		{
+			// the time never goes back
+			mTime = std::max<U64>(mTime, ::strtoull(mToken.c_str() + 1, NULL, 10));
+		} else if (mToken == "$comment") {
+			SkipToEnd();
+		} else if (mToken[0] != '$') {
+			// $dumpvars, $dumpon, $end and the like only wrap value changes
+			ValueChange(mToken, &channels);
+		}
+	}
+
+	for (size_t c = 0; c < mVariables.size(); ++c)
+		mVariables[c].mRounder.Flush(c < channels.size() ? channels[c] : NULL);
+
+	// the last time is where the dump ends
+	if (mAtEnd)
+		end_sample = ToSample(mTime) + 1;
+
+	return !mAtEnd;
+}
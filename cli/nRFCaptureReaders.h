@@ -0,0 +1,213 @@
+#pragma once
+
+#include <LogicPublicTypes.h>
+#include <AnalyzerChannelData.h>
+#include <HeadlessCapture.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+// The capture files nrf24-decode reads. They're all read front to back a chunk at a time,
+// so nothing but the current chunk is ever in memory.
+class nRFCaptureReader : public HeadlessCaptureReader
+{
+public:
+	// The samples are counted at this rate, set it before Open().
+	// With 0 the file's own is taken, if it has one.
+	void SetSampleRate(U64 sample_rate)				{ mSampleRate = sample_rate; }
+	U64 GetSampleRate() const						{ return mSampleRate; }
+
+	// false with the error set if the file can't be read
+	virtual bool Open(const char* path, std::string& error) = 0;
+
+	// the channel by its number, or by its name if the file has them
+	virtual bool FindChannel(const char* name, U32& channel_index) const;
+
+protected:
+	nRFCaptureReader()
+	:	mSampleRate(0)
+	{}
+
+	U64		mSampleRate;
+};
+
+// One channel's transitions on their way into the capture. The times of the files that don't
+// count samples are rounded to the sample rate, and two transitions that land on the same sample
+// cancel out, a channel can't go and come back in one sample.
+class nRFEdgeRounder
+{
+public:
+	nRFEdgeRounder()
+	:	mHasPending(false),
+		mPending(0)
+	{}
+
+	// a transition at sample, which can't be before the last one
+	void Add(U64 sample, AnalyzerChannelData* channel)
+	{
+		if (mHasPending  &&  mPending == sample)
+		{
+			mHasPending = false;
+			return;
+		}
+
+		Flush(channel);
+
+		mHasPending = true;
+		mPending = sample;
+	}
+
+	// nothing can land on the pending one's sample anymore
+	void Flush(AnalyzerChannelData* channel)
+	{
+		if (mHasPending  &&  channel != NULL)
+			channel->AppendTransition(mPending);
+
+		mHasPending = false;
+	}
+
+protected:
+	bool	mHasPending;
+	U64		mPending;
+};
+
+// Reads files through a buffer of our own; stdin if the path is "-".
+class nRFFileStream
+{
+public:
+	nRFFileStream();
+	~nRFFileStream();
+
+	bool Open(const char* path);
+
+	// false at the end of the file
+	bool Read(void* data, size_t size);
+
+	// a run of bytes straight from the buffer, at most size of them; 0 at the end of the file
+	size_t Peek(const U8*& data, size_t size);
+	void Skip(size_t size)		{ mPos += size; }
+
+protected:
+	enum { BUFFER_SIZE = 1 << 20 };
+
+	bool Fill();
+
+	FILE*				mFile;
+	std::vector<U8>		mBuffer;
+	size_t				mPos;
+	size_t				mFill;
+};
+
+// Raw samples, 1, 2, 4 or 8 bytes each, little endian. Bit n is channel n.
+// Some logic analyzers and sigrok's binary output write these.
+class nRFPackedReader : public nRFCaptureReader
+{
+public:
+	nRFPackedReader(U32 sample_bytes);
+
+	virtual bool Open(const char* path, std::string& error);
+
+	virtual bool GetInitialState(U32 channel_index, BitState& state);
+	virtual bool Read(U64& end_sample, const std::vector<AnalyzerChannelData*>& channels);
+
+protected:
+	// scans num_samples samples of type T, stops early at end_sample
+	template <typename T>
+	size_t Scan(const U8* data, size_t num_samples, U64 end_sample, const std::vector<AnalyzerChannelData*>& channels);
+
+	nRFFileStream	mFile;
+	U32				mSampleBytes;
+
+	U64				mSample;		// the next sample to read
+	U64				mState;			// the previous one
+	U64				mMask;			// the channels that are read
+	bool			mAtEnd;
+};
+
+// The binary export of Saleae's Logic 2: a digital_N.bin file for each channel N in a directory,
+// with the time of every transition in seconds.
+class nRFSaleaeReader : public nRFCaptureReader
+{
+public:
+	nRFSaleaeReader();
+	~nRFSaleaeReader();
+
+	virtual bool Open(const char* path, std::string& error);
+
+	virtual bool GetInitialState(U32 channel_index, BitState& state);
+	virtual bool Read(U64& end_sample, const std::vector<AnalyzerChannelData*>& channels);
+
+protected:
+	struct ChannelFile
+	{
+		nRFFileStream	mFile;
+		BitState		mInitialState;
+		double			mBeginTime;
+		double			mEndTime;
+		U64				mNumTransitions;
+
+		U64				mNumRead;
+		bool			mHasNext;		// read, but not in the capture yet
+		U64				mNext;
+
+		nRFEdgeRounder	mRounder;
+	};
+
+	bool OpenChannel(const std::string& path, ChannelFile& channel, std::string& error);
+	bool ReadNext(ChannelFile& channel);
+	U64 ToSample(double time) const;
+
+	std::vector<ChannelFile*>	mChannels;		// by channel index, NULL for the missing ones
+
+	double		mBeginTime;
+	double		mEndTime;
+	U64			mLastSample;	// of the last transition read
+};
+
+// Value Change Dump, as written by simulators, sigrok and most logic analyzer software.
+// Only the 1-bit variables are channels, numbered in the order they're declared.
+class nRFVcdReader : public nRFCaptureReader
+{
+public:
+	nRFVcdReader();
+
+	virtual bool Open(const char* path, std::string& error);
+
+	virtual bool FindChannel(const char* name, U32& channel_index) const;
+
+	virtual bool GetInitialState(U32 channel_index, BitState& state);
+	virtual bool Read(U64& end_sample, const std::vector<AnalyzerChannelData*>& channels);
+
+protected:
+	bool NextToken(std::string& token);
+	bool SkipToEnd();
+	bool ParseTimescale(std::string& error);
+	bool ParseVar(std::string& error);
+
+	// A value change at mTime, the ones that aren't of a channel are skipped.
+	// Without the channels it's the state at sample 0.
+	void ValueChange(const std::string& token, const std::vector<AnalyzerChannelData*>* channels);
+
+	U64 ToSample(U64 time) const;
+
+	struct Variable
+	{
+		std::string		mName;
+		BitState		mState;
+		nRFEdgeRounder	mRounder;
+	};
+
+	nRFFileStream				mFile;
+	std::string					mToken;
+	std::string					mId;
+
+	U64							mUnitsPerSecond;
+
+	std::vector<Variable>		mVariables;
+	std::unordered_map<std::string, std::vector<U32> >	mIds;	// the variables of each identifier code
+
+	U64							mTime;			// of the value changes we're reading
+	bool						mAtEnd;
+};
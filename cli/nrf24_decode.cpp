@@ -0,0 +1,590 @@
+// nrf24-decode: decodes a logic capture file without the Logic application.
+// The capture is streamed through the analyzer a chunk at a time and the frames are written
+// out and dropped as soon as they're committed, so the memory use doesn't grow with the
+// length of the capture.
+// With --threads the capture is read into memory first and decoded offline on a pool of threads.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/stat.h>
+
+#include <AnalyzerChannelData.h>
+#include <HeadlessCapture.h>
+#include <HeadlessTools.h>
+
+#include "nRF24L01_Analyzer.h"
+#include "nRF24L01_AnalyzerSettings.h"
+#include "nRFCsvExporter.h"
+#include "nRFBinaryWriter.h"
+#include "nRFTypes.h"
+
+#include "nRFCaptureReaders.h"
+
+enum CaptureFormat_e
+{
+	FORMAT_AUTO,
+	FORMAT_PACKED,
+	FORMAT_SALEAE,
+	FORMAT_VCD,
+};
+
+struct DecodeOptions
+{
+	const char*		mInput;
+	CaptureFormat_e	mFormat;
+	U64				mSampleRate;
+	U32				mSampleBytes;
+
+	const char*		mMosi;
+	const char*		mMiso;			// NULL if not connected
+	const char*		mSck;
+	const char*		mCsns[MAX_RADIOS];
+	U32				mNumCsns;
+
+	nRFSpiMode_e	mSpiMode;
+	U32				mSckGapNs;
+	int				mPayloadRamMB;
+	bool			mOffline;
+	U32				mThreads;		// for the offline decode, 0 for one per core
+
+	const char*		mOutput;		// NULL for stdout
+	bool			mBinary;
+	const char*		mStatisticsFile;
+	bool			mQuiet;
+
+	DecodeOptions()
+	:	mInput(NULL),
+		mFormat(FORMAT_AUTO),
+		mSampleRate(0),
+		mSampleBytes(1),
+		mMosi("0"),
+		mMiso("1"),
+		mSck("2"),
+		mNumCsns(0),
+		mSpiMode(SPI_MODE_AUTO),
+		mSckGapNs(0),
+		mPayloadRamMB(16),
+		mOffline(false),
+		mThreads(0),
+		mOutput(NULL),
+		mBinary(false),
+		mStatisticsFile(NULL),
+		mQuiet(false)
+	{}
+};
+
+static void usage()
+{
+	::fprintf(stderr,	"usage: nrf24-decode [options] CAPTURE\n"
+						"  CAPTURE             packed samples, a Logic 2 binary export directory or a .vcd file; - is stdin\n"
+						"  --format FORMAT     packed, saleae or vcd (default by the name of CAPTURE)\n"
+						"  --sample-rate HZ    the sample rate, needed for packed and saleae (vcd: 1/timescale)\n"
+						"  --sample-bytes N    bytes per packed sample, 1, 2, 4 or 8 (default 1)\n"
+						"  --mosi CH           the MOSI channel, a number or a VCD name (default 0)\n"
+						"  --miso CH           the MISO channel, or none (default 1)\n"
+						"  --sck CH            the SCK channel (default 2)\n"
+						"  --csn CH            a CSN channel, once for each radio on the bus; none without CSN (default 3)\n"
+						"  --spi-mode MODE     auto, 0, 1, 2 or 3 (default auto)\n"
+						"  --sck-gap NS        the SCK idle gap that ends a transaction without CSN\n"
+						"  --payload-ram MB    RAM for long payloads before they spill to disk (default 16)\n"
+						"  --threads N         read the whole capture into memory and decode it on N threads,\n"
+						"                      0 for one per core; needs CSN (default: streamed on one thread)\n"
+						"  --output FILE       write to FILE instead of stdout\n"
+						"  --binary            write the binary export instead of the text, needs --output\n"
+						"  --stats FILE        write the statistics export to FILE\n"
+						"  --quiet             no summary on stderr\n");
+	::exit(2);
+}
+
+static const NamedValue FORMATS[] = {{"packed", FORMAT_PACKED}, {"saleae", FORMAT_SALEAE}, {"vcd", FORMAT_VCD}, {NULL, 0}};
+static const NamedValue SPI_MODES[] = {{"auto", SPI_MODE_AUTO}, {"0", SPI_MODE_0}, {"1", SPI_MODE_1}, {"2", SPI_MODE_2}, {"3", SPI_MODE_3}, {NULL, 0}};
+
+static bool parse_options(int argc, char* argv[], DecodeOptions& opt)
+{
+	bool no_csn = false;
+
+	for (int c = 1; c < argc; ++c)
+	{
+		const char* option = argv[c];
+		int named;
+
+		// the flags
+		if (::strcmp(option, "--binary") == 0)
+		{
+			opt.mBinary = true;
+			continue;
+		}
+
+		if (::strcmp(option, "--quiet") == 0)
+		{
+			opt.mQuiet = true;
+			continue;
+		}
+
+		// the capture
+		if (::strncmp(option, "--", 2) != 0)
+		{
+			if (opt.mInput != NULL)
+				return false;
+
+			opt.mInput = option;
+			continue;
+		}
+
+		const char* value = ++c < argc ? argv[c] : NULL;
+		if (value == NULL)
+			return false;
+
+		if (::strcmp(option, "--format") == 0  &&  lookup(FORMATS, value, named))
+			opt.mFormat = CaptureFormat_e(named);
+		else if (::strcmp(option, "--sample-rate") == 0)
+			opt.mSampleRate = ::strtoull(value, NULL, 10);
+		else if (::strcmp(option, "--sample-bytes") == 0)
+			opt.mSampleBytes = U32(::strtoul(value, NULL, 10));
+		else if (::strcmp(option, "--mosi") == 0)
+			opt.mMosi = value;
+		else if (::strcmp(option, "--miso") == 0)
+			opt.mMiso = ::strcmp(value, "none") == 0 ? NULL : value;
+		else if (::strcmp(option, "--sck") == 0)
+			opt.mSck = value;
+		else if (::strcmp(option, "--csn") == 0  &&  ::strcmp(value, "none") == 0)
+			no_csn = true;
+		else if (::strcmp(option, "--csn") == 0  &&  opt.mNumCsns < MAX_RADIOS)
+			opt.mCsns[opt.mNumCsns++] = value;
+		else if (::strcmp(option, "--spi-mode") == 0  &&  lookup(SPI_MODES, value, named))
+			opt.mSpiMode = nRFSpiMode_e(named);
+		else if (::strcmp(option, "--sck-gap") == 0)
+			opt.mSckGapNs = U32(::strtoul(value, NULL, 10));
+		else if (::strcmp(option, "--payload-ram") == 0)
+			opt.mPayloadRamMB = ::atoi(value);
+		else if (::strcmp(option, "--threads") == 0)
+		{
+			opt.mOffline = true;
+			opt.mThreads = U32(::strtoul(value, NULL, 10));
+		}
+		else if (::strcmp(option, "--output") == 0)
+			opt.mOutput = value;
+		else if (::strcmp(option, "--stats") == 0)
+			opt.mStatisticsFile = value;
+		else
+			return false;
+	}
+
+	if (opt.mNumCsns == 0  &&  !no_csn)
+		opt.mCsns[opt.mNumCsns++] = "3";
+
+	return opt.mInput != NULL  &&  !(no_csn  &&  opt.mNumCsns > 0)  &&  !(opt.mOffline  &&  no_csn)
+			&&  (opt.mSampleBytes == 1  ||  opt.mSampleBytes == 2  ||  opt.mSampleBytes == 4  ||  opt.mSampleBytes == 8)
+			&&  !(opt.mBinary  &&  opt.mOutput == NULL);
+}
+
+static nRFCaptureReader* open_reader(const DecodeOptions& opt, std::string& error)
+{
+	CaptureFormat_e format = opt.mFormat;
+	if (format == FORMAT_AUTO)
+	{
+		size_t length = ::strlen(opt.mInput);
+		struct stat st;
+		if (::stat(opt.mInput, &st) == 0  &&  S_ISDIR(st.st_mode))
+			format = FORMAT_SALEAE;
+		else if (length > 4  &&  ::strcmp(opt.mInput + length - 4, ".vcd") == 0)
+			format = FORMAT_VCD;
+		else
+			format = FORMAT_PACKED;
+	}
+
+	std::unique_ptr<nRFCaptureReader> reader;
+	switch (format)
+	{
+	case FORMAT_SALEAE:		reader.reset(new nRFSaleaeReader);							break;
+	case FORMAT_VCD:		reader.reset(new nRFVcdReader);								break;
+	default:				reader.reset(new nRFPackedReader(opt.mSampleBytes));		break;
+	}
+
+	reader->SetSampleRate(opt.mSampleRate);
+	if (!reader->Open(opt.mInput, error))
+		return NULL;
+
+	if (reader->GetSampleRate() > 0xFFFFFFFF)
+	{
+		error = "the sample rate is too high";
+		return NULL;
+	}
+
+	return reader.release();
+}
+
+// the channels by their names in the capture
+static bool find_channel(nRFCaptureReader* reader, const char* title, const char* name, Channel& channel)
+{
+	U32 channel_index;
+	if (!reader->FindChannel(name, channel_index))
+	{
+		::fprintf(stderr, "the capture has no channel %s for %s\n", name, title);
+		return false;
+	}
+
+	channel = Channel(0, channel_index);
+	return true;
+}
+
+static bool setup_analyzer(nRF24L01_Analyzer& analyzer, nRFCaptureReader* reader, const DecodeOptions& opt)
+{
+	AnalyzerSettings* settings = analyzer.GetAnalyzerSettings();
+
+	Channel mosi, miso = UNDEFINED_CHANNEL, sck, csn = UNDEFINED_CHANNEL;
+	if (!find_channel(reader, "MOSI", opt.mMosi, mosi)  ||  !find_channel(reader, "SCK", opt.mSck, sck)
+			||  (opt.mMiso != NULL  &&  !find_channel(reader, "MISO", opt.mMiso, miso))
+			||  (opt.mNumCsns > 0  &&  !find_channel(reader, "CSN", opt.mCsns[0], csn)))
+		return false;
+
+	if (!set_channel(settings, "MOSI", mosi)  ||  !set_channel(settings, "MISO", miso)
+			||  !set_channel(settings, "SCK", sck)  ||  !set_channel(settings, "CSN", csn))
+	{
+		::fprintf(stderr, "channel settings not found\n");
+		return false;
+	}
+
+	for (U32 radio = 1; radio < opt.mNumCsns; ++radio)
+	{
+		const char* title = nRF24L01_AnalyzerSettings::GetCsnName(radio);
+		Channel more_csn;
+		if (!find_channel(reader, title, opt.mCsns[radio], more_csn))
+			return false;
+
+		if (!set_channel(settings, title, more_csn))
+		{
+			::fprintf(stderr, "%s setting not found\n", title);
+			return false;
+		}
+	}
+
+	// nobody looks at the markers
+	if (!set_number(settings, "Decoder", DECODER_BATCH)  ||  !set_number(settings, "Markers", MARKERS_NONE)
+			||  !set_number(settings, "SPI mode", opt.mSpiMode)
+			||  !set_integer(settings, "Payload RAM (MB)", opt.mPayloadRamMB)
+			||  (opt.mSckGapNs > 0  &&  !set_integer(settings, "SCK idle gap (ns)", int(opt.mSckGapNs))))
+	{
+		::fprintf(stderr, "decoder settings not found\n");
+		return false;
+	}
+
+	if (!settings->SetSettingsFromInterfaces())
+	{
+		::fprintf(stderr, "settings rejected: %s\n", settings->GetErrorText());
+		return false;
+	}
+
+	analyzer.SetStreaming(true);
+
+	return true;
+}
+
+// The rows on their way from the decoder thread to the output.
+// Only a few chunks are let in, the decoder waits for the output when it's ahead.
+class RowQueue
+{
+public:
+	enum { MAX_CHUNKS = 4 };
+
+	RowQueue()
+	:	mDone(false)
+	{}
+
+	// takes the rows, and leaves rows empty
+	void Push(std::vector<nRFExportRow>& rows)
+	{
+		std::unique_lock<std::mutex> lock(mLock);
+		while (mChunks.size() >= MAX_CHUNKS)
+			mChanged.wait(lock);
+
+		mChunks.push_back(std::vector<nRFExportRow>());
+		mChunks.back().swap(rows);
+		mChanged.notify_all();
+	}
+
+	// no more rows after these
+	void Finish()
+	{
+		std::lock_guard<std::mutex> lock(mLock);
+		mDone = true;
+		mChanged.notify_all();
+	}
+
+	// false once all of them have been popped
+	bool Pop(std::vector<nRFExportRow>& rows)
+	{
+		std::unique_lock<std::mutex> lock(mLock);
+		while (mChunks.empty()  &&  !mDone)
+			mChanged.wait(lock);
+
+		if (mChunks.empty())
+			return false;
+
+		rows.swap(mChunks.front());
+		mChunks.pop_front();
+		mChanged.notify_all();
+
+		return true;
+	}
+
+protected:
+	std::mutex									mLock;
+	std::condition_variable						mChanged;
+	std::deque<std::vector<nRFExportRow> >		mChunks;
+	bool										mDone;
+};
+
+// Makes rows of the committed frames and drops them, on the decoder thread.
+class FrameDrain
+{
+public:
+	FrameDrain(nRF24L01_Analyzer& analyzer, RowQueue& queue)
+	:	mAnalyzer(analyzer),
+		mQueue(queue),
+		mNextFrame(0),
+		mNumRows(0)
+	{}
+
+	void Drain()
+	{
+		nRF24L01_AnalyzerResults* results = (nRF24L01_AnalyzerResults*) mAnalyzer.GetAnalyzerResults();
+		if (results == NULL)
+			return;
+
+		U64 num_committed = results->GetNumCommittedFrames();
+		Frame cmd_frame, data_frame;
+		while (mNextFrame < num_committed)
+		{
+			cmd_frame = results->GetFrame(mNextFrame);
+
+			// like the text export, the oversize bursts aren't in it
+			if (cmd_frame.mFlags & IS_OVERSIZE_BURST)
+			{
+				++mNextFrame;
+				continue;
+			}
+
+			mRows.push_back(nRFExportRow());
+			nRFExportRow& row = mRows.back();
+
+			row.mHasData = (cmd_frame.mFlags & HAS_DATA_FRAME) != 0;
+			if (row.mHasData)
+				data_frame = results->GetFrame(mNextFrame + 1);
+
+			row.mCommand.Decode(&cmd_frame, &data_frame, results->GetExtendedData());
+			row.mStartingSample = cmd_frame.mStartingSampleInclusive;
+
+			mNextFrame += row.mHasData ? 2 : 1;
+
+			if (mRows.size() == nRFCsvExporter::CHUNK_ROWS)
+			{
+				mNumRows += mRows.size();
+				mQueue.Push(mRows);
+			}
+		}
+
+		results->DiscardCommittedFrames();
+		results->ReleaseDrainedPayloads();
+	}
+
+	// after the end of the capture
+	void Finish()
+	{
+		nRF24L01_AnalyzerResults* results = (nRF24L01_AnalyzerResults*) mAnalyzer.GetAnalyzerResults();
+		if (results != NULL)
+			results->CommitResults();
+
+		Drain();
+
+		mNumRows += mRows.size();
+		if (!mRows.empty())
+			mQueue.Push(mRows);
+
+		mQueue.Finish();
+	}
+
+	U64 GetNumRows() const		{ return mNumRows; }
+
+protected:
+	nRF24L01_Analyzer&			mAnalyzer;
+	RowQueue&					mQueue;
+
+	U64							mNextFrame;
+	std::vector<nRFExportRow>	mRows;
+	U64							mNumRows;
+};
+
+static bool decode_offline(nRF24L01_Analyzer& analyzer, HeadlessCapture& capture, U32 num_threads)
+{
+	nRF24L01_AnalyzerSettings* settings = (nRF24L01_AnalyzerSettings*) analyzer.GetAnalyzerSettings();
+
+	// the reader only fills the channels asked for before it reads anything
+	capture.GetChannelData(settings->mMosiChannel);
+	capture.GetChannelData(settings->mSckChannel);
+	if (settings->mMisoChannel != UNDEFINED_CHANNEL)
+		capture.GetChannelData(settings->mMisoChannel);
+	for (U32 radio = 0; radio < settings->mNumRadios; ++radio)
+		capture.GetChannelData(settings->mCsnChannels[radio]);
+
+	nRFBusEdges bus;
+	for (U32 radio = 0; radio < settings->mNumRadios; ++radio)
+		load_transitions(capture, settings->mCsnChannels[radio], bus.mCsns[radio].mInitialState, bus.mCsns[radio].mEdges);
+	load_transitions(capture, settings->mMosiChannel, bus.mMosi.mInitialState, bus.mMosi.mEdges);
+	load_transitions(capture, settings->mSckChannel, bus.mSck.mInitialState, bus.mSck.mEdges);
+	if (settings->mMisoChannel != UNDEFINED_CHANNEL)
+		load_transitions(capture, settings->mMisoChannel, bus.mMiso.mInitialState, bus.mMiso.mEdges);
+
+	return analyzer.DecodeOffline(bus, num_threads);
+}
+
+static bool write_text(RowQueue& queue, std::ostream& out, U64 sample_rate, bool csn_column)
+{
+	nRFCsvExporter::ReadRowsFn read_rows = [&](std::vector<nRFExportRow>& rows, U64& frames_done)
+	{
+		// the exporter hands us an empty chunk
+		queue.Pop(rows);
+
+		frames_done = 0;
+		return rows.size();
+	};
+
+	nRFCsvExporter::ProgressFn progress = [](U64)
+	{
+		return false;
+	};
+
+	nRFCsvExporter exporter(Hexadecimal, 0, U32(sample_rate), csn_column);
+	exporter.Export(out, read_rows, progress);
+
+	out.flush();
+	return !out.fail();
+}
+
+static bool write_binary(RowQueue& queue, std::ostream& out, U64 sample_rate)
+{
+	// the number of rows is only known at the end
+	nRFBinaryWriter writer(out, sample_rate, 0);
+
+	std::vector<nRFExportRow> rows;
+	while (queue.Pop(rows))
+	{
+		for (size_t r = 0; r < rows.size(); ++r)
+		{
+			nRFCommand& cmd = rows[r].mCommand;
+			if (!rows[r].mHasData)
+				cmd.mDataLength = 0;
+
+			writer.AddRow(rows[r].mStartingSample, cmd);
+		}
+	}
+
+	return writer.Finish();
+}
+
+int main(int argc, char* argv[])
+{
+	DecodeOptions opt;
+	if (!parse_options(argc, argv, opt))
+		usage();
+
+	std::string error;
+	std::unique_ptr<nRFCaptureReader> reader(open_reader(opt, error));
+	if (reader == NULL)
+	{
+		::fprintf(stderr, "%s: %s\n", opt.mInput, error.c_str());
+		return 1;
+	}
+
+	U64 sample_rate = reader->GetSampleRate();
+
+	nRF24L01_Analyzer analyzer;
+	HeadlessCapture capture((U32) sample_rate);
+	analyzer.SetCapture(&capture);
+
+	if (!setup_analyzer(analyzer, reader.get(), opt))
+		return 1;
+
+	std::ofstream file;
+	if (opt.mOutput != NULL)
+	{
+		file.open(opt.mOutput, std::ios::out | std::ios::binary);
+		if (!file)
+		{
+			::fprintf(stderr, "can't write %s\n", opt.mOutput);
+			return 1;
+		}
+	}
+
+	std::ostream& out = opt.mOutput != NULL ? file : std::cout;
+
+	// the decoder drops the frames each time it asks for more of the capture
+	RowQueue queue;
+	FrameDrain drain(analyzer, queue);
+	capture.UseReader(reader.get());
+	capture.SetLoadCallback([&drain]() { drain.Drain(); });
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	bool decoded = true;
+	std::thread decoder([&]()
+	{
+		// the frames of the offline decode are only drained at the end
+		if (opt.mOffline)
+			decoded = decode_offline(analyzer, capture, opt.mThreads);
+		else
+			capture.RunWorker(&analyzer);
+
+		drain.Finish();
+	});
+
+	bool written = opt.mBinary ? write_binary(queue, out, sample_rate) : write_text(queue, out, sample_rate, opt.mNumCsns > 1);
+	decoder.join();
+
+	double decode_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	if (!decoded)
+	{
+		::fprintf(stderr, "the offline decoder refused the settings\n");
+		return 1;
+	}
+
+	if (!written)
+	{
+		::fprintf(stderr, "can't write %s\n", opt.mOutput != NULL ? opt.mOutput : "the output");
+		return 1;
+	}
+
+	nRF24L01_AnalyzerResults* results = (nRF24L01_AnalyzerResults*) analyzer.GetAnalyzerResults();
+	if (opt.mStatisticsFile != NULL  &&  results != NULL)
+	{
+		std::ofstream stats(opt.mStatisticsFile, std::ios::out);
+		results->GetStatistics().Write(stats, 0, U32(sample_rate));
+		if (stats.fail())
+		{
+			::fprintf(stderr, "can't write %s\n", opt.mStatisticsFile);
+			return 1;
+		}
+	}
+
+	if (!opt.mQuiet)
+	{
+		double capture_s = double(capture.GetEndSample()) / sample_rate;
+		::fprintf(stderr, "%llu transactions, %llu edges, %.3f s of capture decoded in %.3f s (%.1fx real time), peak RSS %.1f MB\n",
+					drain.GetNumRows(), capture.GetNumTransitions(), capture_s, decode_s, capture_s / decode_s, peak_rss_mb());
+	}
+
+	return 0;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "LogicPublicTypes.h"
+#include "AnalyzerTypes.h"
+#include "AnalyzerSettings.h"
+#include "AnalyzerResults.h"
+#include "SimulationChannelDescriptor.h"
+
+class AnalyzerChannelData;
+class HeadlessCapture;
+
+class LOGICAPI Analyzer
+{
+public:
+	Analyzer();
+	virtual ~Analyzer();
+
+	virtual void WorkerThread() = 0;
+	virtual U32 GenerateSimulationData(U64 newest_sample_requested, U32 sample_rate, SimulationChannelDescriptor** simulation_channels) = 0;
+	virtual U32 GetMinimumSampleRateHz() = 0;
+	virtual const char* GetAnalyzerName() const = 0;
+	virtual bool NeedsRerun() = 0;
+
+	void SetAnalyzerSettings(AnalyzerSettings* settings);
+	void KillThread();
+	void CheckIfThreadShouldExit();
+
+	AnalyzerChannelData* GetAnalyzerChannelData(Channel& channel);
+	void ReportProgress(U64 sample_number);
+	void SetAnalyzerResults(AnalyzerResults* results);
+
+	U32 GetSimulationSampleRate();
+	U32 GetSampleRate();
+	U64 GetTriggerSample();
+
+public:	// headless only
+	void SetCapture(HeadlessCapture* capture)		{ mCapture = capture; }
+	AnalyzerSettings* GetAnalyzerSettings()			{ return mAnalyzerSettings; }
+	AnalyzerResults* GetAnalyzerResults()			{ return mAnalyzerResults; }
+	U64 GetProgress() const							{ return mProgress; }
+
+protected:
+	HeadlessCapture*	mCapture;
+	AnalyzerSettings*	mAnalyzerSettings;
+	AnalyzerResults*	mAnalyzerResults;
+	U64					mProgress;
+};
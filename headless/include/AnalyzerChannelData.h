@@ -0,0 +1,80 @@
+#pragma once
+
+#include <vector>
+
+#include "LogicPublicTypes.h"
+
+class AnalyzerCaptureSource;
+
+// Thrown from a blocking channel call when the capture has no more data.
+// The real SDK never returns from such a call and kills the worker thread instead.
+struct AnalyzerEndOfCapture {};
+
+class LOGICAPI AnalyzerChannelData
+{
+public:
+	AnalyzerChannelData(AnalyzerCaptureSource* source, BitState initial_bit_state);
+	~AnalyzerChannelData();
+
+	// SDK interface
+	U64 GetSampleNumber();
+	BitState GetBitState();
+
+	U32 Advance(U32 num_samples);
+	U32 AdvanceToAbsPosition(U64 sample_number);
+	void AdvanceToNextEdge();
+
+	U64 GetSampleOfNextEdge();
+	bool WouldAdvancingCauseTransition(U32 num_samples);
+	bool WouldAdvancingToAbsPositionCauseTransition(U64 sample_number);
+
+	void TrackMinimumPulseWidth();
+	U64 GetMinimumPulseWidthSoFar();
+
+	bool DoMoreTransitionsExistInCurrentData();
+
+public:	// headless only, used by the capture source to feed the channel
+
+	void AppendTransition(U64 sample_number);
+	void SetLoadedUpTo(U64 sample_number);
+	void SetEndOfCapture();
+	void Compact();
+
+	// Like a capture that's still running: DoMoreTransitionsExistInCurrentData() only
+	// knows about what's been loaded so far, instead of loading more to find out.
+	void SetLive(bool live)		{ mLive = live; }
+
+	U64 GetNumTransitionsLoaded() const		{ return mNumTransitionsLoaded; }
+
+protected:
+	bool IsNextEdgeRecorded() const;
+	bool EnsureNextEdge();
+	void EnsureLoadedUpTo(U64 sample_number);
+
+	AnalyzerCaptureSource*	mSource;
+
+	std::vector<U64>	mEdges;
+	size_t				mNextEdge;
+	U64					mLoadedUpTo;		// every edge before this sample is in mEdges
+	bool				mEndOfCapture;
+	bool				mLive;
+
+	U64			mSampleNumber;
+	BitState	mBitState;
+
+	bool		mTrackPulseWidth;
+	U64			mLastEdge;
+	U64			mMinPulseWidth;
+
+	U64			mNumTransitionsLoaded;
+};
+
+// headless only: something which loads more transitions into the channels on demand
+class AnalyzerCaptureSource
+{
+public:
+	virtual ~AnalyzerCaptureSource() {}
+
+	// load the next chunk of the capture into the channels; false at the end of the capture
+	virtual bool LoadMore() = 0;
+};
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <string>
+
+#include "Analyzer.h"
+
+class LOGICAPI AnalyzerHelpers
+{
+public:
+	static bool IsEven(U64 value);
+	static bool IsOdd(U64 value);
+	static U32 GetOnesCount(U64 value);
+	static U32 Diff32(U32 a, U32 b);
+
+	static void GetNumberString(U64 number, DisplayBase display_base, U32 num_data_bits, char* result_string, U32 result_string_max_length);
+	static void GetTimeString(U64 sample, U64 trigger_sample, U32 sample_rate_hz, char* result_string, U32 result_string_max_length);
+
+	static bool DoChannelsOverlap(const Channel* channel_array, U32 num_channels);
+	static U64 AdjustSimulationTargetSample(U64 target_sample, U32 sample_rate, U32 simulation_sample_rate);
+};
+
+class LOGICAPI ClockGenerator
+{
+public:
+	ClockGenerator();
+	~ClockGenerator();
+
+	void Init(double target_frequency, U32 sample_rate_hz);
+	U32 AdvanceByHalfPeriod(double multiple = 1.0);
+	U32 AdvanceByTimeS(double time_s);
+
+protected:
+	double		mSampleRateHz;
+	double		mSamplesPerHalfPeriod;
+	double		mCarry;
+};
+
+class LOGICAPI BitExtractor
+{
+public:
+	BitExtractor(U64 data, AnalyzerEnums::ShiftOrder shift_order, U32 num_bits);
+	~BitExtractor();
+
+	BitState GetNextBit();
+
+protected:
+	U64			mData;
+	AnalyzerEnums::ShiftOrder	mShiftOrder;
+	U32			mNumBits;
+	U32			mIndex;
+};
+
+class LOGICAPI DataBuilder
+{
+public:
+	DataBuilder();
+	~DataBuilder();
+
+	void Reset(U64* data, AnalyzerEnums::ShiftOrder shift_order, U32 num_bits);
+	void AddBit(BitState bit);
+
+protected:
+	U64*		mData;
+	AnalyzerEnums::ShiftOrder	mShiftOrder;
+	U32			mNumBits;
+	U32			mIndex;
+};
+
+class LOGICAPI SimpleArchive
+{
+public:
+	SimpleArchive();
+	~SimpleArchive();
+
+	void SetString(const char* archive_string);
+	const char* GetString();
+
+	bool operator<<(U64 data);
+	bool operator<<(U32 data);
+	bool operator<<(S64 data);
+	bool operator<<(S32 data);
+	bool operator<<(double data);
+	bool operator<<(bool data);
+	bool operator<<(const char* data);
+	bool operator<<(Channel& data);
+
+	bool operator>>(U64& data);
+	bool operator>>(U32& data);
+	bool operator>>(S64& data);
+	bool operator>>(S32& data);
+	bool operator>>(double& data);
+	bool operator>>(bool& data);
+	bool operator>>(char const** data);
+	bool operator>>(Channel& data);
+
+protected:
+	bool NextToken(std::string& token);
+
+	std::string		mString;
+	size_t			mReadPos;
+	std::string		mLastText;
+};
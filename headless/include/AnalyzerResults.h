@@ -0,0 +1,125 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "LogicPublicTypes.h"
+#include "AnalyzerTypes.h"
+
+#define DISPLAY_AS_ERROR_FLAG		( 1 << 7 )
+#define DISPLAY_AS_WARNING_FLAG		( 1 << 6 )
+
+#define INVALID_RESULT_INDEX 0xFFFFFFFFFFFFFFFFull
+
+class LOGICAPI Frame
+{
+public:
+	Frame();
+	Frame(const Frame& frame);
+	~Frame();
+
+	S64 mStartingSampleInclusive;
+	S64 mEndingSampleInclusive;
+	U64 mData1;
+	U64 mData2;
+	U8 mType;
+	U8 mFlags;
+
+	bool HasFlag(U8 flag);
+};
+
+class LOGICAPI AnalyzerResults
+{
+public:
+	enum MarkerType { Dot, ErrorDot, Square, ErrorSquare, UpArrow, DownArrow, X, ErrorX, Start, Stop, One, Zero };
+
+	AnalyzerResults();
+	virtual ~AnalyzerResults();
+
+	virtual void GenerateBubbleText(U64 frame_index, Channel& channel, DisplayBase display_base) = 0;
+	virtual void GenerateExportFile(const char* file, DisplayBase display_base, U32 export_type_user_id) = 0;
+	virtual void GenerateFrameTabularText(U64 frame_index, DisplayBase display_base) = 0;
+	virtual void GeneratePacketTabularText(U64 packet_id, DisplayBase display_base) = 0;
+	virtual void GenerateTransactionTabularText(U64 transaction_id, DisplayBase display_base) = 0;
+
+public:	// adding results
+	void AddMarker(U64 sample_number, MarkerType marker_type, Channel& channel);
+
+	U64 AddFrame(const Frame& frame);
+	U64 CommitPacketAndStartNewPacket();
+	void CancelPacketAndStartNewPacket();
+	void AddPacketToTransaction(U64 transaction_id, U64 packet_id);
+	void AddChannelBubblesWillAppearOn(const Channel& channel);
+
+	void CommitResults();
+
+public:	// reading results
+	U64 GetNumFrames();
+	U64 GetNumPackets();
+	Frame GetFrame(U64 frame_id);
+
+	U64 GetPacketContainingFrame(U64 frame_id);
+	U64 GetPacketContainingFrameSequential(U64 frame_id);
+	void GetFramesContainedInPacket(U64 packet_id, U64* first_frame_id, U64* last_frame_id);
+
+	U32 GetTransactionContainingPacket(U64 packet_id);
+	void GetPacketsContainedInTransaction(U64 transaction_id, U64** packet_id_array, U64* packet_id_count);
+
+public:	// text results
+	void ClearResultStrings();
+	void AddResultString(const char* str1, const char* str2 = NULL, const char* str3 = NULL,
+							const char* str4 = NULL, const char* str5 = NULL, const char* str6 = NULL);
+	void GetResultStrings(char const*** result_string_array, U32* num_strings);
+
+protected:
+	bool UpdateExportProgressAndCheckForCancel(U64 completed_frames, U64 total_frames);
+
+public:	// headless only, for the test harness
+	U64 GetNumMarkers() const				{ return mFirstMarker + mMarkers.size(); }
+	void GetMarker(U64 index, U64& sample_number, U32& channel_index, MarkerType& type) const
+	{
+		const Marker& marker = mMarkers[size_t(index - mFirstMarker)];
+		sample_number = marker.mSampleNumber;
+		channel_index = marker.mChannelIndex;
+		type = MarkerType(marker.mType);
+	}
+	U64 GetNumCommits() const				{ return mNumCommits; }
+	U64 GetNumCommittedFrames() const		{ return mNumCommittedFrames; }
+
+	// Drops the committed frames with their packets and markers, for a decoder that writes them
+	// out as it goes. The frames and packets keep their indexes, the dropped ones can't be read.
+	// Transactions aren't dropped.
+	void DiscardCommittedFrames();
+
+protected:
+	struct Marker
+	{
+		U64		mSampleNumber;
+		U32		mChannelIndex;
+		U32		mType;
+	};
+
+	std::vector<Frame>			mFrames;
+	std::vector<Marker>			mMarkers;
+
+	// what DiscardCommittedFrames() has dropped
+	U64							mFirstFrame;
+	U64							mFirstPacket;
+	U64							mFirstMarker;
+	std::vector<Channel>		mBubbleChannels;
+
+	std::vector<U64>			mPacketFirstFrame;		// first frame of each committed packet
+	std::vector<U64>			mPacketLastFrame;		// and its last, cancelled packets leave gaps
+	U64							mPacketStartFrame;		// first frame of the packet being built
+	std::vector<std::vector<U64> >	mTransactions;		// packets per transaction id
+	std::vector<U32>			mPacketTransaction;
+
+	// kept between ClearResultStrings calls so the strings reuse their buffers
+	std::vector<std::string>	mResultStrings;
+	size_t						mNumResultStrings;
+	std::vector<const char*>	mResultStringPtrs;
+
+	U64		mNumCommits;
+	U64		mNumCommittedFrames;
+	U64		mNumCommittedMarkers;
+};
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "LogicPublicTypes.h"
+#include "AnalyzerTypes.h"
+#include "AnalyzerSettingInterface.h"
+
+class LOGICAPI AnalyzerSettings
+{
+public:
+	AnalyzerSettings();
+	virtual ~AnalyzerSettings();
+
+	virtual bool SetSettingsFromInterfaces() = 0;
+	virtual void LoadSettings(const char* settings) = 0;
+	virtual const char* SaveSettings() = 0;
+
+	void ClearChannels();
+	void AddChannel(Channel& channel, const char* channel_label, bool is_used);
+
+	void SetErrorText(const char* error_text);
+	void AddInterface(AnalyzerSettingInterface* analyzer_setting_interface);
+
+	void AddExportOption(U32 user_id, const char* menu_text);
+	void AddExportExtension(U32 user_id, const char* extension_description, const char* extension);
+
+	const char* SetReturnString(const char* str);
+
+	U32 GetSettingsInterfacesCount();
+	AnalyzerSettingInterface* GetSettingsInterface(U32 index);
+
+public:	// headless only
+	const char* GetErrorText()					{ return mErrorText.c_str(); }
+	U32 GetExportOptionsCount()					{ return U32(mExportOptions.size()); }
+	U32 GetExportOptionId(U32 index)			{ return mExportOptions[index]; }
+
+	// looks up an interface by its title, NULL if there is none
+	AnalyzerSettingInterface* FindInterface(const char* title);
+
+protected:
+	std::vector<AnalyzerSettingInterface*>	mInterfaces;
+	std::vector<U32>						mExportOptions;
+	std::string								mErrorText;
+	std::string								mReturnString;
+};
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <map>
+#include <vector>
+#include <functional>
+
+#include "Analyzer.h"
+#include "AnalyzerChannelData.h"
+
+// A capture read from a file a chunk at a time, see HeadlessCapture::UseReader().
+class HeadlessCaptureReader
+{
+public:
+	virtual ~HeadlessCaptureReader() {}
+
+	// the state of the channel at sample 0, false if the capture doesn't have it
+	virtual bool GetInitialState(U32 channel_index, BitState& state) = 0;
+
+	// Appends the transitions before end_sample to channels[channel_index], skipping the NULLs.
+	// Returns false once the capture has ended, with end_sample set to its end.
+	virtual bool Read(U64& end_sample, const std::vector<AnalyzerChannelData*>& channels) = 0;
+};
+
+// Feeds an Analyzer's worker thread without the Logic application.
+// The capture is pulled in chunks from the analyzer's own simulation data
+// generator or from a reader, so memory use does not depend on the length of the capture.
+class HeadlessCapture : public AnalyzerCaptureSource
+{
+public:
+	HeadlessCapture(U32 sample_rate_hz);
+	virtual ~HeadlessCapture();
+
+	U32 GetSampleRate() const			{ return mSampleRateHz; }
+
+	// Use the simulation data of analyzer as the capture.
+	// The capture ends after num_pulses complete pulses on stop_channel.
+	void UseSimulation(Analyzer* analyzer, const Channel& stop_channel, U64 num_pulses, U64 chunk_samples = 1 << 20);
+
+	// Use what reader reads as the capture. Only the channels asked for before
+	// the first chunk is loaded get any data, the others are left out of the reads.
+	void UseReader(HeadlessCaptureReader* reader, U64 chunk_samples = 1 << 20);
+
+	// The decoder sees the capture as if it was still being recorded, a chunk at a time,
+	// see AnalyzerChannelData::SetLive(). Set it before RunWorker().
+	void SetLive(bool live);
+
+	// called on the worker thread before each chunk is loaded
+	void SetLoadCallback(const std::function<void ()>& callback)		{ mLoadCallback = callback; }
+
+	// Runs the analyzer's worker thread until the capture is exhausted.
+	void RunWorker(Analyzer* analyzer);
+
+	AnalyzerChannelData* GetChannelData(const Channel& channel);
+
+	virtual bool LoadMore();
+
+	// stats
+	U64 GetNumTransitions() const		{ return mNumTransitions; }
+	U64 GetEndSample() const			{ return mEndSample; }
+	double GetLoadSeconds() const		{ return mLoadSeconds; }
+
+protected:
+	void LoadSimulationChunk();
+	void LoadReaderChunk();
+	void CompactChannels();
+
+	AnalyzerChannelData* AddChannel(const Channel& channel, BitState initial_state);
+
+	U32			mSampleRateHz;
+
+	Analyzer*	mSimulationAnalyzer;
+	Channel		mStopChannel;
+	U64			mStopTransitions;
+	U64			mStopChannelTransitions;
+	U64			mChunkSamples;
+	U64			mRequestedSample;
+	bool		mLive;
+
+	bool		mEnded;
+	U64			mEndSample;
+	U64			mNumTransitions;
+	double		mLoadSeconds;
+
+	HeadlessCaptureReader*				mReader;
+	std::vector<AnalyzerChannelData*>	mReaderChannels;	// by channel index, NULL for the ones nobody wants
+
+	std::function<void ()>		mLoadCallback;
+
+	std::map<Channel, AnalyzerChannelData*>		mChannels;
+	std::vector<U64>							mTransitions;
+};
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <vector>
+
+#include "AnalyzerSettings.h"
+#include "HeadlessCapture.h"
+
+// What the bench and nrf24-decode both need to drive an analyzer from the command line.
+
+// a name an option can take and what it means, the list ends with a NULL name
+struct NamedValue
+{
+	const char*		mName;
+	int				mValue;
+};
+
+bool lookup(const NamedValue* values, const char* name, int& value);
+
+// set a setting by its title, false if the analyzer has no such setting of that type
+bool set_channel(AnalyzerSettings* settings, const char* title, const Channel& channel);
+bool set_number(AnalyzerSettings* settings, const char* title, double number);
+bool set_integer(AnalyzerSettings* settings, const char* title, int integer);
+bool set_text(AnalyzerSettings* settings, const char* title, const char* text);
+
+// all of a channel's transitions, read to the end of the capture
+void load_transitions(HeadlessCapture& capture, const Channel& channel, BitState& initial_state, std::vector<U64>& transitions);
+
+double peak_rss_mb();
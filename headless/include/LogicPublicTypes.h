@@ -0,0 +1,37 @@
+#pragma once
+
+// Headless stand-in for the Saleae AnalyzerSDK.
+// Only the subset of the SDK surface used by the nRF24L01 analyzer is provided.
+
+#include <cstddef>
+
+typedef signed char			S8;
+typedef short				S16;
+typedef int					S32;
+typedef long long int		S64;
+
+typedef unsigned char		U8;
+typedef unsigned short		U16;
+typedef unsigned int		U32;
+typedef unsigned long long int	U64;
+
+#ifndef __cdecl
+# define __cdecl
+#endif
+
+#ifndef __stdcall
+# define __stdcall
+#endif
+
+#ifndef __fastcall
+# define __fastcall
+#endif
+
+#define LOGICAPI
+#define ANALYZER_EXPORT __attribute__ ((visibility("default")))
+
+enum DisplayBase { Binary, Decimal, Hexadecimal, ASCII, AsciiHex };
+enum BitState { BIT_LOW, BIT_HIGH };
+
+#define Toggle(x)	( x == BIT_LOW ? BIT_HIGH : BIT_LOW )
+#define Invert(x)	( x == BIT_LOW ? BIT_HIGH : BIT_LOW )
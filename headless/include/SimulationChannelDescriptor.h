@@ -0,0 +1,62 @@
+#pragma once
+
+#include <vector>
+
+#include "LogicPublicTypes.h"
+#include "AnalyzerTypes.h"
+
+class LOGICAPI SimulationChannelDescriptor
+{
+public:
+	SimulationChannelDescriptor();
+	SimulationChannelDescriptor(const SimulationChannelDescriptor& other);
+	~SimulationChannelDescriptor();
+	SimulationChannelDescriptor& operator=(const SimulationChannelDescriptor& other);
+
+	void Transition();
+	void TransitionIfNeeded(BitState bit_state);
+	void Advance(U32 num_samples_to_advance);
+
+	BitState GetCurrentBitState();
+	U64 GetCurrentSampleNumber();
+
+	void SetChannel(Channel& channel);
+	void SetSampleRate(U32 sample_rate_hz);
+	void SetInitialBitState(BitState intial_bit_state);
+
+	Channel GetChannel();
+	U32 GetSampleRate();
+	BitState GetInitialBitState();
+
+public:	// headless only
+	// moves the transitions generated so far into transitions
+	void TakeTransitions(std::vector<U64>& transitions);
+
+protected:
+	Channel				mChannel;
+	U32					mSampleRateHz;
+	BitState			mInitialBitState;
+	BitState			mCurrentBitState;
+	U64					mCurrentSampleNumber;
+	std::vector<U64>	mTransitions;
+};
+
+class LOGICAPI SimulationChannelDescriptorGroup
+{
+public:
+	SimulationChannelDescriptorGroup();
+	~SimulationChannelDescriptorGroup();
+
+	SimulationChannelDescriptor* Add(Channel& channel, U32 sample_rate, BitState intial_bit_state);
+
+	void AdvanceAll(U32 num_samples_to_advance);
+
+	SimulationChannelDescriptor* GetArray();
+	U32 GetCount();
+
+protected:
+	enum { MAX_CHANNELS = 16 };
+
+	SimulationChannelDescriptor		mChannels[MAX_CHANNELS];
+	U32								mCount;
+};
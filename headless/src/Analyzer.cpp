@@ -0,0 +1,54 @@
+#include "Analyzer.h"
+#include "AnalyzerChannelData.h"
+#include "HeadlessCapture.h"
+
+Analyzer::Analyzer()
+:	mCapture(NULL),
+	mAnalyzerSettings(NULL),
+	mAnalyzerResults(NULL),
+	mProgress(0)
+{}
+
+Analyzer::~Analyzer()
+{}
+
+void Analyzer::SetAnalyzerSettings(AnalyzerSettings* settings)
+{
+	mAnalyzerSettings = settings;
+}
+
+void Analyzer::KillThread()
+{}
+
+void Analyzer::CheckIfThreadShouldExit()
+{}
+
+AnalyzerChannelData* Analyzer::GetAnalyzerChannelData(Channel& channel)
+{
+	return mCapture->GetChannelData(channel);
+}
+
+void Analyzer::ReportProgress(U64 sample_number)
+{
+	mProgress = sample_number;
+}
+
+void Analyzer::SetAnalyzerResults(AnalyzerResults* results)
+{
+	mAnalyzerResults = results;
+}
+
+U32 Analyzer::GetSimulationSampleRate()
+{
+	return GetSampleRate();
+}
+
+U32 Analyzer::GetSampleRate()
+{
+	return mCapture != NULL ? mCapture->GetSampleRate() : 0;
+}
+
+U64 Analyzer::GetTriggerSample()
+{
+	return 0;
+}
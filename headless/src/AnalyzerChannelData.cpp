@@ -0,0 +1,167 @@
+#include "AnalyzerChannelData.h"
+
+AnalyzerChannelData::AnalyzerChannelData(AnalyzerCaptureSource* source, BitState initial_bit_state)
+:	mSource(source),
+	mNextEdge(0),
+	mLoadedUpTo(0),
+	mEndOfCapture(false),
+	mLive(false),
+	mSampleNumber(0),
+	mBitState(initial_bit_state),
+	mTrackPulseWidth(false),
+	mLastEdge(0),
+	mMinPulseWidth(0),
+	mNumTransitionsLoaded(0)
+{}
+
+AnalyzerChannelData::~AnalyzerChannelData()
+{}
+
+U64 AnalyzerChannelData::GetSampleNumber()
+{
+	return mSampleNumber;
+}
+
+BitState AnalyzerChannelData::GetBitState()
+{
+	return mBitState;
+}
+
+U32 AnalyzerChannelData::Advance(U32 num_samples)
+{
+	return AdvanceToAbsPosition(mSampleNumber + num_samples);
+}
+
+U32 AnalyzerChannelData::AdvanceToAbsPosition(U64 sample_number)
+{
+	if (sample_number <= mSampleNumber)
+		return 0;
+
+	EnsureLoadedUpTo(sample_number);
+
+	U32 num_transitions = 0;
+	while (mNextEdge < mEdges.size()  &&  mEdges[mNextEdge] <= sample_number)
+	{
+		mBitState = Toggle(mBitState);
+
+		if (mTrackPulseWidth)
+		{
+			U64 width = mEdges[mNextEdge] - mLastEdge;
+			if (mMinPulseWidth == 0  ||  width < mMinPulseWidth)
+				mMinPulseWidth = width;
+			mLastEdge = mEdges[mNextEdge];
+		}
+
+		++mNextEdge;
+		++num_transitions;
+	}
+
+	mSampleNumber = sample_number;
+
+	return num_transitions;
+}
+
+void AnalyzerChannelData::AdvanceToNextEdge()
+{
+	AdvanceToAbsPosition(GetSampleOfNextEdge());
+}
+
+U64 AnalyzerChannelData::GetSampleOfNextEdge()
+{
+	if (!EnsureNextEdge())
+		throw AnalyzerEndOfCapture();
+
+	return mEdges[mNextEdge];
+}
+
+bool AnalyzerChannelData::WouldAdvancingCauseTransition(U32 num_samples)
+{
+	return WouldAdvancingToAbsPositionCauseTransition(mSampleNumber + num_samples);
+}
+
+bool AnalyzerChannelData::WouldAdvancingToAbsPositionCauseTransition(U64 sample_number)
+{
+	EnsureLoadedUpTo(sample_number);
+
+	return mNextEdge < mEdges.size()  &&  mEdges[mNextEdge] <= sample_number;
+}
+
+void AnalyzerChannelData::TrackMinimumPulseWidth()
+{
+	mTrackPulseWidth = true;
+	mLastEdge = mSampleNumber;
+}
+
+U64 AnalyzerChannelData::GetMinimumPulseWidthSoFar()
+{
+	return mMinPulseWidth;
+}
+
+bool AnalyzerChannelData::DoMoreTransitionsExistInCurrentData()
+{
+	// the SDK doesn't wait for more data here, in a live capture the answer is whatever has been recorded
+	if (mLive)
+		return IsNextEdgeRecorded();
+
+	// otherwise the whole capture is available to a headless run, so "current data" is all of it
+	return EnsureNextEdge();
+}
+
+void AnalyzerChannelData::AppendTransition(U64 sample_number)
+{
+	mEdges.push_back(sample_number);
+	++mNumTransitionsLoaded;
+}
+
+void AnalyzerChannelData::SetLoadedUpTo(U64 sample_number)
+{
+	mLoadedUpTo = sample_number;
+}
+
+void AnalyzerChannelData::SetEndOfCapture()
+{
+	mEndOfCapture = true;
+}
+
+bool AnalyzerChannelData::IsNextEdgeRecorded() const
+{
+	// a live capture may have edges of the next chunk already, they're not there for the decoder yet
+	return mNextEdge < mEdges.size()  &&  (!mLive  ||  mEndOfCapture  ||  mEdges[mNextEdge] < mLoadedUpTo);
+}
+
+bool AnalyzerChannelData::EnsureNextEdge()
+{
+	if (IsNextEdgeRecorded())
+		return true;
+
+	Compact();
+
+	while (!IsNextEdgeRecorded()  &&  !mEndOfCapture)
+	{
+		if (!mSource->LoadMore())
+			break;
+	}
+
+	return mNextEdge < mEdges.size();
+}
+
+void AnalyzerChannelData::EnsureLoadedUpTo(U64 sample_number)
+{
+	while (mLoadedUpTo <= sample_number  &&  !mEndOfCapture)
+	{
+		Compact();
+
+		if (!mSource->LoadMore())
+			break;
+	}
+}
+
+void AnalyzerChannelData::Compact()
+{
+	// drop the edges we've already passed so memory stays bounded
+	if (mNextEdge > 4096  &&  mNextEdge * 2 > mEdges.size())
+	{
+		mEdges.erase(mEdges.begin(), mEdges.begin() + mNextEdge);
+		mNextEdge = 0;
+	}
+}
@@ -0,0 +1,358 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+#include "AnalyzerHelpers.h"
+
+bool AnalyzerHelpers::IsEven(U64 value)
+{
+	return (value & 1) == 0;
+}
+
+bool AnalyzerHelpers::IsOdd(U64 value)
+{
+	return (value & 1) != 0;
+}
+
+U32 AnalyzerHelpers::GetOnesCount(U64 value)
+{
+	U32 count = 0;
+	for (; value != 0; value &= value - 1)
+		++count;
+
+	return count;
+}
+
+U32 AnalyzerHelpers::Diff32(U32 a, U32 b)
+{
+	return a > b ? a - b : b - a;
+}
+
+void AnalyzerHelpers::GetNumberString(U64 number, DisplayBase display_base, U32 num_data_bits, char* result_string, U32 result_string_max_length)
+{
+	if (num_data_bits < 64)
+		number &= (1ull << num_data_bits) - 1;
+
+	switch (display_base)
+	{
+	case Binary:
+		{
+			char buff[72] = "0b";
+			U32 c;
+			for (c = 0; c < num_data_bits; ++c)
+				buff[2 + c] = (number & (1ull << (num_data_bits - 1 - c))) ? '1' : '0';
+			buff[2 + c] = '\0';
+			::snprintf(result_string, result_string_max_length, "%s", buff);
+		}
+		break;
+
+	case Hexadecimal:
+		::snprintf(result_string, result_string_max_length, "0x%0*llX", int((num_data_bits + 3) / 4), number);
+		break;
+
+	case ASCII:
+		if (number >= 32  &&  number < 127)
+			::snprintf(result_string, result_string_max_length, "%c", char(number));
+		else
+			::snprintf(result_string, result_string_max_length, "'%llu'", number);
+		break;
+
+	case AsciiHex:
+		if (number >= 32  &&  number < 127)
+			::snprintf(result_string, result_string_max_length, "'%c' (0x%0*llX)", char(number), int((num_data_bits + 3) / 4), number);
+		else
+			::snprintf(result_string, result_string_max_length, "0x%0*llX", int((num_data_bits + 3) / 4), number);
+		break;
+
+	case Decimal:
+	default:
+		::snprintf(result_string, result_string_max_length, "%llu", number);
+		break;
+	}
+}
+
+void AnalyzerHelpers::GetTimeString(U64 sample, U64 trigger_sample, U32 sample_rate_hz, char* result_string, U32 result_string_max_length)
+{
+	double seconds = double(S64(sample - trigger_sample)) / double(sample_rate_hz);
+	::snprintf(result_string, result_string_max_length, "%.9f", seconds);
+}
+
+bool AnalyzerHelpers::DoChannelsOverlap(const Channel* channel_array, U32 num_channels)
+{
+	for (U32 i = 0; i < num_channels; ++i)
+	{
+		for (U32 j = i + 1; j < num_channels; ++j)
+		{
+			if (channel_array[i] == channel_array[j])
+				return true;
+		}
+	}
+
+	return false;
+}
+
+U64 AnalyzerHelpers::AdjustSimulationTargetSample(U64 target_sample, U32 sample_rate, U32 simulation_sample_rate)
+{
+	if (sample_rate == simulation_sample_rate)
+		return target_sample;
+
+	return U64(double(target_sample) * double(simulation_sample_rate) / double(sample_rate));
+}
+
+ClockGenerator::ClockGenerator()
+:	mSampleRateHz(0),
+	mSamplesPerHalfPeriod(0),
+	mCarry(0)
+{}
+
+ClockGenerator::~ClockGenerator()
+{}
+
+void ClockGenerator::Init(double target_frequency, U32 sample_rate_hz)
+{
+	mSampleRateHz = sample_rate_hz;
+	mSamplesPerHalfPeriod = double(sample_rate_hz) / (target_frequency * 2.0);
+	mCarry = 0;
+}
+
+U32 ClockGenerator::AdvanceByHalfPeriod(double multiple)
+{
+	double samples = mSamplesPerHalfPeriod * multiple + mCarry;
+	U32 whole = U32(samples);
+	mCarry = samples - whole;
+
+	return whole;
+}
+
+U32 ClockGenerator::AdvanceByTimeS(double time_s)
+{
+	double samples = mSampleRateHz * time_s + mCarry;
+	U32 whole = U32(samples);
+	mCarry = samples - whole;
+
+	return whole;
+}
+
+BitExtractor::BitExtractor(U64 data, AnalyzerEnums::ShiftOrder shift_order, U32 num_bits)
+:	mData(data),
+	mShiftOrder(shift_order),
+	mNumBits(num_bits),
+	mIndex(0)
+{}
+
+BitExtractor::~BitExtractor()
+{}
+
+BitState BitExtractor::GetNextBit()
+{
+	U32 bit = mShiftOrder == AnalyzerEnums::MsbFirst ? mNumBits - 1 - mIndex : mIndex;
+	++mIndex;
+
+	return (mData & (1ull << bit)) ? BIT_HIGH : BIT_LOW;
+}
+
+DataBuilder::DataBuilder()
+:	mData(NULL),
+	mShiftOrder(AnalyzerEnums::MsbFirst),
+	mNumBits(0),
+	mIndex(0)
+{}
+
+DataBuilder::~DataBuilder()
+{}
+
+void DataBuilder::Reset(U64* data, AnalyzerEnums::ShiftOrder shift_order, U32 num_bits)
+{
+	mData = data;
+	mShiftOrder = shift_order;
+	mNumBits = num_bits;
+	mIndex = 0;
+	*mData = 0;
+}
+
+void DataBuilder::AddBit(BitState bit)
+{
+	if (bit == BIT_HIGH)
+	{
+		U32 pos = mShiftOrder == AnalyzerEnums::MsbFirst ? mNumBits - 1 - mIndex : mIndex;
+		*mData |= 1ull << pos;
+	}
+
+	++mIndex;
+}
+
+SimpleArchive::SimpleArchive()
+:	mReadPos(0)
+{}
+
+SimpleArchive::~SimpleArchive()
+{}
+
+void SimpleArchive::SetString(const char* archive_string)
+{
+	mString = archive_string;
+	mReadPos = 0;
+}
+
+const char* SimpleArchive::GetString()
+{
+	return mString.c_str();
+}
+
+bool SimpleArchive::operator<<(U64 data)
+{
+	std::ostringstream os;
+	os << data << ' ';
+	mString += os.str();
+	return true;
+}
+
+bool SimpleArchive::operator<<(U32 data)
+{
+	return *this << U64(data);
+}
+
+bool SimpleArchive::operator<<(S64 data)
+{
+	std::ostringstream os;
+	os << data << ' ';
+	mString += os.str();
+	return true;
+}
+
+bool SimpleArchive::operator<<(S32 data)
+{
+	return *this << S64(data);
+}
+
+bool SimpleArchive::operator<<(double data)
+{
+	std::ostringstream os;
+	os.precision(17);
+	os << data << ' ';
+	mString += os.str();
+	return true;
+}
+
+bool SimpleArchive::operator<<(bool data)
+{
+	return *this << U64(data ? 1 : 0);
+}
+
+bool SimpleArchive::operator<<(const char* data)
+{
+	// strings are stored as <length>:<text>
+	std::ostringstream os;
+	os << ::strlen(data) << ':' << data << ' ';
+	mString += os.str();
+	return true;
+}
+
+bool SimpleArchive::operator<<(Channel& data)
+{
+	return *this << data.mDeviceId  &&  *this << data.mChannelIndex;
+}
+
+bool SimpleArchive::NextToken(std::string& token)
+{
+	while (mReadPos < mString.size()  &&  mString[mReadPos] == ' ')
+		++mReadPos;
+
+	if (mReadPos >= mString.size())
+		return false;
+
+	size_t end = mString.find(' ', mReadPos);
+	if (end == std::string::npos)
+		end = mString.size();
+
+	token = mString.substr(mReadPos, end - mReadPos);
+	mReadPos = end;
+
+	return true;
+}
+
+bool SimpleArchive::operator>>(U64& data)
+{
+	std::string token;
+	if (!NextToken(token))
+		return false;
+
+	data = ::strtoull(token.c_str(), NULL, 10);
+	return true;
+}
+
+bool SimpleArchive::operator>>(U32& data)
+{
+	U64 val;
+	if (!(*this >> val))
+		return false;
+
+	data = U32(val);
+	return true;
+}
+
+bool SimpleArchive::operator>>(S64& data)
+{
+	std::string token;
+	if (!NextToken(token))
+		return false;
+
+	data = ::strtoll(token.c_str(), NULL, 10);
+	return true;
+}
+
+bool SimpleArchive::operator>>(S32& data)
+{
+	S64 val;
+	if (!(*this >> val))
+		return false;
+
+	data = S32(val);
+	return true;
+}
+
+bool SimpleArchive::operator>>(double& data)
+{
+	std::string token;
+	if (!NextToken(token))
+		return false;
+
+	data = ::strtod(token.c_str(), NULL);
+	return true;
+}
+
+bool SimpleArchive::operator>>(bool& data)
+{
+	U64 val;
+	if (!(*this >> val))
+		return false;
+
+	data = val != 0;
+	return true;
+}
+
+bool SimpleArchive::operator>>(char const** data)
+{
+	while (mReadPos < mString.size()  &&  mString[mReadPos] == ' ')
+		++mReadPos;
+
+	size_t colon = mString.find(':', mReadPos);
+	if (colon == std::string::npos)
+		return false;
+
+	size_t len = ::strtoull(mString.c_str() + mReadPos, NULL, 10);
+	if (colon + 1 + len > mString.size())
+		return false;
+
+	mLastText = mString.substr(colon + 1, len);
+	mReadPos = colon + 1 + len;
+
+	*data = mLastText.c_str();
+	return true;
+}
+
+bool SimpleArchive::operator>>(Channel& data)
+{
+	return *this >> data.mDeviceId  &&  *this >> data.mChannelIndex;
+}
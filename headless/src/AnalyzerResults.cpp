@@ -0,0 +1,208 @@
+#include <algorithm>
+
+#include "AnalyzerResults.h"
+
+Frame::Frame()
+:	mStartingSampleInclusive(0),
+	mEndingSampleInclusive(0),
+	mData1(0),
+	mData2(0),
+	mType(0),
+	mFlags(0)
+{}
+
+Frame::Frame(const Frame& frame)
+:	mStartingSampleInclusive(frame.mStartingSampleInclusive),
+	mEndingSampleInclusive(frame.mEndingSampleInclusive),
+	mData1(frame.mData1),
+	mData2(frame.mData2),
+	mType(frame.mType),
+	mFlags(frame.mFlags)
+{}
+
+Frame::~Frame()
+{}
+
+bool Frame::HasFlag(U8 flag)
+{
+	return (mFlags & flag) != 0;
+}
+
+AnalyzerResults::AnalyzerResults()
+:	mFirstFrame(0),
+	mFirstPacket(0),
+	mFirstMarker(0),
+	mPacketStartFrame(0),
+	mNumResultStrings(0),
+	mNumCommits(0),
+	mNumCommittedFrames(0),
+	mNumCommittedMarkers(0)
+{}
+
+AnalyzerResults::~AnalyzerResults()
+{}
+
+void AnalyzerResults::AddMarker(U64 sample_number, MarkerType marker_type, Channel& channel)
+{
+	Marker m;
+	m.mSampleNumber = sample_number;
+	m.mChannelIndex = channel.mChannelIndex;
+	m.mType = marker_type;
+	mMarkers.push_back(m);
+}
+
+U64 AnalyzerResults::AddFrame(const Frame& frame)
+{
+	mFrames.push_back(frame);
+	return GetNumFrames() - 1;
+}
+
+U64 AnalyzerResults::CommitPacketAndStartNewPacket()
+{
+	if (mPacketStartFrame == GetNumFrames())
+		return INVALID_RESULT_INDEX;
+
+	mPacketFirstFrame.push_back(mPacketStartFrame);
+	mPacketLastFrame.push_back(GetNumFrames() - 1);
+	mPacketTransaction.push_back(0xFFFFFFFF);
+	mPacketStartFrame = GetNumFrames();
+
+	return GetNumPackets() - 1;
+}
+
+void AnalyzerResults::CancelPacketAndStartNewPacket()
+{
+	mPacketStartFrame = GetNumFrames();
+}
+
+void AnalyzerResults::AddPacketToTransaction(U64 transaction_id, U64 packet_id)
+{
+	if (packet_id < mFirstPacket  ||  packet_id >= GetNumPackets())
+		return;
+
+	if (transaction_id >= mTransactions.size())
+		mTransactions.resize(size_t(transaction_id + 1));
+
+	mTransactions[size_t(transaction_id)].push_back(packet_id);
+	mPacketTransaction[size_t(packet_id - mFirstPacket)] = U32(transaction_id);
+}
+
+void AnalyzerResults::AddChannelBubblesWillAppearOn(const Channel& channel)
+{
+	mBubbleChannels.push_back(channel);
+}
+
+void AnalyzerResults::CommitResults()
+{
+	++mNumCommits;
+	mNumCommittedFrames = GetNumFrames();
+	mNumCommittedMarkers = GetNumMarkers();
+}
+
+void AnalyzerResults::DiscardCommittedFrames()
+{
+	// the packets that are all in the committed frames
+	size_t num_packets = std::lower_bound(mPacketLastFrame.begin(), mPacketLastFrame.end(), mNumCommittedFrames) - mPacketLastFrame.begin();
+	mPacketFirstFrame.erase(mPacketFirstFrame.begin(), mPacketFirstFrame.begin() + num_packets);
+	mPacketLastFrame.erase(mPacketLastFrame.begin(), mPacketLastFrame.begin() + num_packets);
+	mPacketTransaction.erase(mPacketTransaction.begin(), mPacketTransaction.begin() + num_packets);
+	mFirstPacket += num_packets;
+
+	mFrames.erase(mFrames.begin(), mFrames.begin() + size_t(mNumCommittedFrames - mFirstFrame));
+	mFirstFrame = mNumCommittedFrames;
+
+	mMarkers.erase(mMarkers.begin(), mMarkers.begin() + size_t(mNumCommittedMarkers - mFirstMarker));
+	mFirstMarker = mNumCommittedMarkers;
+}
+
+U64 AnalyzerResults::GetNumFrames()
+{
+	return mFirstFrame + mFrames.size();
+}
+
+U64 AnalyzerResults::GetNumPackets()
+{
+	return mFirstPacket + mPacketFirstFrame.size();
+}
+
+Frame AnalyzerResults::GetFrame(U64 frame_id)
+{
+	return mFrames[size_t(frame_id - mFirstFrame)];
+}
+
+U64 AnalyzerResults::GetPacketContainingFrame(U64 frame_id)
+{
+	std::vector<U64>::const_iterator it = std::upper_bound(mPacketFirstFrame.begin(), mPacketFirstFrame.end(), frame_id);
+	if (it == mPacketFirstFrame.begin())
+		return INVALID_RESULT_INDEX;
+
+	size_t ndx = (it - mPacketFirstFrame.begin()) - 1;
+
+	// past the end of the packet?
+	if (frame_id > mPacketLastFrame[ndx])
+		return INVALID_RESULT_INDEX;
+
+	return mFirstPacket + ndx;
+}
+
+U64 AnalyzerResults::GetPacketContainingFrameSequential(U64 frame_id)
+{
+	return GetPacketContainingFrame(frame_id);
+}
+
+void AnalyzerResults::GetFramesContainedInPacket(U64 packet_id, U64* first_frame_id, U64* last_frame_id)
+{
+	*first_frame_id = mPacketFirstFrame[size_t(packet_id - mFirstPacket)];
+	*last_frame_id = mPacketLastFrame[size_t(packet_id - mFirstPacket)];
+}
+
+U32 AnalyzerResults::GetTransactionContainingPacket(U64 packet_id)
+{
+	return mPacketTransaction[size_t(packet_id - mFirstPacket)];
+}
+
+void AnalyzerResults::GetPacketsContainedInTransaction(U64 transaction_id, U64** packet_id_array, U64* packet_id_count)
+{
+	if (transaction_id >= mTransactions.size()  ||  mTransactions[size_t(transaction_id)].empty())
+	{
+		*packet_id_array = NULL;
+		*packet_id_count = 0;
+		return;
+	}
+
+	*packet_id_array = &mTransactions[size_t(transaction_id)].front();
+	*packet_id_count = mTransactions[size_t(transaction_id)].size();
+}
+
+void AnalyzerResults::ClearResultStrings()
+{
+	mNumResultStrings = 0;
+}
+
+void AnalyzerResults::AddResultString(const char* str1, const char* str2, const char* str3, const char* str4, const char* str5, const char* str6)
+{
+	if (mNumResultStrings == mResultStrings.size())
+		mResultStrings.push_back(std::string());
+
+	std::string& str = mResultStrings[mNumResultStrings++];
+	str.assign(str1);
+
+	const char* more[] = {str2, str3, str4, str5, str6};
+	for (int c = 0; c < 5  &&  more[c] != NULL; ++c)
+		str += more[c];
+}
+
+void AnalyzerResults::GetResultStrings(char const*** result_string_array, U32* num_strings)
+{
+	mResultStringPtrs.clear();
+	for (size_t c = 0; c < mNumResultStrings; ++c)
+		mResultStringPtrs.push_back(mResultStrings[c].c_str());
+
+	*result_string_array = mResultStringPtrs.empty() ? NULL : &mResultStringPtrs.front();
+	*num_strings = U32(mResultStringPtrs.size());
+}
+
+bool AnalyzerResults::UpdateExportProgressAndCheckForCancel(U64 completed_frames, U64 total_frames)
+{
+	return false;
+}
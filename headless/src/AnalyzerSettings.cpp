@@ -0,0 +1,275 @@
+#include <cstring>
+
+#include "AnalyzerSettings.h"
+
+AnalyzerSettings::AnalyzerSettings()
+{}
+
+AnalyzerSettings::~AnalyzerSettings()
+{}
+
+void AnalyzerSettings::ClearChannels()
+{}
+
+void AnalyzerSettings::AddChannel(Channel& channel, const char* channel_label, bool is_used)
+{}
+
+void AnalyzerSettings::SetErrorText(const char* error_text)
+{
+	mErrorText = error_text;
+}
+
+void AnalyzerSettings::AddInterface(AnalyzerSettingInterface* analyzer_setting_interface)
+{
+	mInterfaces.push_back(analyzer_setting_interface);
+}
+
+void AnalyzerSettings::AddExportOption(U32 user_id, const char* menu_text)
+{
+	mExportOptions.push_back(user_id);
+}
+
+void AnalyzerSettings::AddExportExtension(U32 user_id, const char* extension_description, const char* extension)
+{}
+
+const char* AnalyzerSettings::SetReturnString(const char* str)
+{
+	mReturnString = str;
+	return mReturnString.c_str();
+}
+
+U32 AnalyzerSettings::GetSettingsInterfacesCount()
+{
+	return U32(mInterfaces.size());
+}
+
+AnalyzerSettingInterface* AnalyzerSettings::GetSettingsInterface(U32 index)
+{
+	return mInterfaces[index];
+}
+
+AnalyzerSettingInterface* AnalyzerSettings::FindInterface(const char* title)
+{
+	for (std::vector<AnalyzerSettingInterface*>::iterator it(mInterfaces.begin()); it != mInterfaces.end(); ++it)
+	{
+		if (::strcmp((*it)->GetTitle(), title) == 0)
+			return *it;
+	}
+
+	return NULL;
+}
+
+AnalyzerSettingInterface::AnalyzerSettingInterface()
+{}
+
+AnalyzerSettingInterface::~AnalyzerSettingInterface()
+{}
+
+AnalyzerInterfaceTypeId AnalyzerSettingInterface::GetType()
+{
+	return INTERFACE_BASE;
+}
+
+const char* AnalyzerSettingInterface::GetToolTip()
+{
+	return mTooltip.c_str();
+}
+
+const char* AnalyzerSettingInterface::GetTitle()
+{
+	return mTitle.c_str();
+}
+
+bool AnalyzerSettingInterface::IsDisabled()
+{
+	return false;
+}
+
+void AnalyzerSettingInterface::SetTitleAndTooltip(const char* title, const char* tooltip)
+{
+	mTitle = title;
+	mTooltip = tooltip;
+}
+
+AnalyzerSettingInterfaceChannel::AnalyzerSettingInterfaceChannel()
+:	mNoneIsAllowed(false)
+{}
+
+AnalyzerSettingInterfaceChannel::~AnalyzerSettingInterfaceChannel()
+{}
+
+AnalyzerInterfaceTypeId AnalyzerSettingInterfaceChannel::GetType()
+{
+	return INTERFACE_CHANNEL;
+}
+
+Channel AnalyzerSettingInterfaceChannel::GetChannel()
+{
+	return mChannel;
+}
+
+void AnalyzerSettingInterfaceChannel::SetChannel(const Channel& channel)
+{
+	mChannel = channel;
+}
+
+bool AnalyzerSettingInterfaceChannel::GetSelectionOfNoneIsAllowed()
+{
+	return mNoneIsAllowed;
+}
+
+void AnalyzerSettingInterfaceChannel::SetSelectionOfNoneIsAllowed(bool is_allowed)
+{
+	mNoneIsAllowed = is_allowed;
+}
+
+AnalyzerSettingInterfaceNumberList::AnalyzerSettingInterfaceNumberList()
+:	mNumber(0)
+{}
+
+AnalyzerSettingInterfaceNumberList::~AnalyzerSettingInterfaceNumberList()
+{}
+
+AnalyzerInterfaceTypeId AnalyzerSettingInterfaceNumberList::GetType()
+{
+	return INTERFACE_NUMBER_LIST;
+}
+
+double AnalyzerSettingInterfaceNumberList::GetNumber()
+{
+	return mNumber;
+}
+
+void AnalyzerSettingInterfaceNumberList::SetNumber(double number)
+{
+	mNumber = number;
+}
+
+U32 AnalyzerSettingInterfaceNumberList::GetListboxNumbersCount()
+{
+	return U32(mNumbers.size());
+}
+
+double AnalyzerSettingInterfaceNumberList::GetListboxNumber(U32 index)
+{
+	return mNumbers[index];
+}
+
+U32 AnalyzerSettingInterfaceNumberList::GetListboxStringsCount()
+{
+	return U32(mStrings.size());
+}
+
+const char* AnalyzerSettingInterfaceNumberList::GetListboxString(U32 index)
+{
+	return mStrings[index].c_str();
+}
+
+void AnalyzerSettingInterfaceNumberList::AddNumber(double number, const char* str, const char* tooltip)
+{
+	mNumbers.push_back(number);
+	mStrings.push_back(str);
+}
+
+void AnalyzerSettingInterfaceNumberList::ClearNumbers()
+{
+	mNumbers.clear();
+	mStrings.clear();
+}
+
+AnalyzerSettingInterfaceInteger::AnalyzerSettingInterfaceInteger()
+:	mInteger(0),
+	mMin(0),
+	mMax(0x7FFFFFFF)
+{}
+
+AnalyzerSettingInterfaceInteger::~AnalyzerSettingInterfaceInteger()
+{}
+
+AnalyzerInterfaceTypeId AnalyzerSettingInterfaceInteger::GetType()
+{
+	return INTERFACE_INTEGER;
+}
+
+int AnalyzerSettingInterfaceInteger::GetInteger()
+{
+	return mInteger;
+}
+
+void AnalyzerSettingInterfaceInteger::SetInteger(int integer)
+{
+	mInteger = integer;
+}
+
+int AnalyzerSettingInterfaceInteger::GetMax()
+{
+	return mMax;
+}
+
+int AnalyzerSettingInterfaceInteger::GetMin()
+{
+	return mMin;
+}
+
+void AnalyzerSettingInterfaceInteger::SetMax(int max)
+{
+	mMax = max;
+}
+
+void AnalyzerSettingInterfaceInteger::SetMin(int min)
+{
+	mMin = min;
+}
+
+AnalyzerSettingInterfaceText::AnalyzerSettingInterfaceText()
+{}
+
+AnalyzerSettingInterfaceText::~AnalyzerSettingInterfaceText()
+{}
+
+AnalyzerInterfaceTypeId AnalyzerSettingInterfaceText::GetType()
+{
+	return INTERFACE_TEXT;
+}
+
+const char* AnalyzerSettingInterfaceText::GetText()
+{
+	return mText.c_str();
+}
+
+void AnalyzerSettingInterfaceText::SetText(const char* text)
+{
+	mText = text;
+}
+
+AnalyzerSettingInterfaceBool::AnalyzerSettingInterfaceBool()
+:	mValue(false)
+{}
+
+AnalyzerSettingInterfaceBool::~AnalyzerSettingInterfaceBool()
+{}
+
+AnalyzerInterfaceTypeId AnalyzerSettingInterfaceBool::GetType()
+{
+	return INTERFACE_BOOL;
+}
+
+bool AnalyzerSettingInterfaceBool::GetValue()
+{
+	return mValue;
+}
+
+void AnalyzerSettingInterfaceBool::SetValue(bool value)
+{
+	mValue = value;
+}
+
+const char* AnalyzerSettingInterfaceBool::GetCheckBoxText()
+{
+	return mCheckBoxText.c_str();
+}
+
+void AnalyzerSettingInterfaceBool::SetCheckBoxText(const char* text)
+{
+	mCheckBoxText = text;
+}
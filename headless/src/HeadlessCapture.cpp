@@ -0,0 +1,236 @@
+#include <chrono>
+
+#include "HeadlessCapture.h"
+
+HeadlessCapture::HeadlessCapture(U32 sample_rate_hz)
+:	mSampleRateHz(sample_rate_hz),
+	mSimulationAnalyzer(NULL),
+	mStopChannel(UNDEFINED_CHANNEL),
+	mStopTransitions(0),
+	mStopChannelTransitions(0),
+	mChunkSamples(0),
+	mRequestedSample(0),
+	mLive(false),
+	mEnded(false),
+	mEndSample(0),
+	mNumTransitions(0),
+	mLoadSeconds(0),
+	mReader(NULL)
+{}
+
+HeadlessCapture::~HeadlessCapture()
+{
+	for (std::map<Channel, AnalyzerChannelData*>::iterator it(mChannels.begin()); it != mChannels.end(); ++it)
+		delete it->second;
+}
+
+void HeadlessCapture::UseSimulation(Analyzer* analyzer, const Channel& stop_channel, U64 num_pulses, U64 chunk_samples)
+{
+	mSimulationAnalyzer = analyzer;
+	mStopChannel = stop_channel;
+	mStopTransitions = num_pulses * 2;
+	mChunkSamples = chunk_samples;
+
+	// the first chunk tells us which channels exist and their idle states
+	LoadSimulationChunk();
+}
+
+void HeadlessCapture::UseReader(HeadlessCaptureReader* reader, U64 chunk_samples)
+{
+	mReader = reader;
+	mChunkSamples = chunk_samples;
+}
+
+void HeadlessCapture::SetLive(bool live)
+{
+	mLive = live;
+
+	for (std::map<Channel, AnalyzerChannelData*>::iterator it(mChannels.begin()); it != mChannels.end(); ++it)
+		it->second->SetLive(live);
+}
+
+AnalyzerChannelData* HeadlessCapture::AddChannel(const Channel& channel, BitState initial_state)
+{
+	AnalyzerChannelData* data = mChannels[channel] = new AnalyzerChannelData(this, initial_state);
+	data->SetLive(mLive);
+
+	return data;
+}
+
+void HeadlessCapture::RunWorker(Analyzer* analyzer)
+{
+	analyzer->SetCapture(this);
+
+	try
+	{
+		analyzer->WorkerThread();
+	} catch (const AnalyzerEndOfCapture&) {
+		// this is where the SDK would kill the worker thread
+	}
+}
+
+AnalyzerChannelData* HeadlessCapture::GetChannelData(const Channel& channel)
+{
+	std::map<Channel, AnalyzerChannelData*>::iterator it = mChannels.find(channel);
+	if (it != mChannels.end())
+		return it->second;
+
+	// the reader has it, and nothing has been read yet?
+	BitState state;
+	if (mReader != NULL  &&  mRequestedSample == 0  &&  mReader->GetInitialState(channel.mChannelIndex, state))
+	{
+		AnalyzerChannelData* data = AddChannel(channel, state);
+
+		if (mReaderChannels.size() <= channel.mChannelIndex)
+			mReaderChannels.resize(channel.mChannelIndex + 1, NULL);
+		mReaderChannels[channel.mChannelIndex] = data;
+
+		return data;
+	}
+
+	// a channel with no data at all
+	AnalyzerChannelData* data = AddChannel(channel, BIT_LOW);
+	data->SetEndOfCapture();
+
+	return data;
+}
+
+bool HeadlessCapture::LoadMore()
+{
+	if (mEnded  ||  (mSimulationAnalyzer == NULL  &&  mReader == NULL))
+		return false;
+
+	if (mLoadCallback)
+		mLoadCallback();
+
+	if (mReader != NULL)
+		LoadReaderChunk();
+	else
+		LoadSimulationChunk();
+
+	return true;
+}
+
+void HeadlessCapture::CompactChannels()
+{
+	// a channel only compacts itself when it's the one asking for more, so do it for all of them here
+	for (std::map<Channel, AnalyzerChannelData*>::iterator it(mChannels.begin()); it != mChannels.end(); ++it)
+		it->second->Compact();
+}
+
+void HeadlessCapture::LoadReaderChunk()
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	CompactChannels();
+
+	mRequestedSample += mChunkSamples;
+
+	U64 loaded_before = 0, loaded_after = 0;
+	for (size_t c = 0; c < mReaderChannels.size(); ++c)
+		loaded_before += mReaderChannels[c] != NULL ? mReaderChannels[c]->GetNumTransitionsLoaded() : 0;
+
+	U64 end_sample = mRequestedSample;
+	bool more = mReader->Read(end_sample, mReaderChannels);
+
+	for (size_t c = 0; c < mReaderChannels.size(); ++c)
+		loaded_after += mReaderChannels[c] != NULL ? mReaderChannels[c]->GetNumTransitionsLoaded() : 0;
+	mNumTransitions += loaded_after - loaded_before;
+
+	for (std::map<Channel, AnalyzerChannelData*>::iterator it(mChannels.begin()); it != mChannels.end(); ++it)
+	{
+		it->second->SetLoadedUpTo(end_sample);
+		if (!more)
+			it->second->SetEndOfCapture();
+	}
+
+	mEnded = !more;
+	mEndSample = end_sample;
+
+	mLoadSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void HeadlessCapture::LoadSimulationChunk()
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	CompactChannels();
+
+	mRequestedSample += mChunkSamples;
+
+	SimulationChannelDescriptor* descriptors = NULL;
+	U32 count = mSimulationAnalyzer->GenerateSimulationData(mRequestedSample, mSampleRateHz, &descriptors);
+
+	// find where the capture ends if the stop channel gets there in this chunk
+	U64 loaded_up_to = 0xFFFFFFFFFFFFFFFFull;
+	U64 end_sample = 0xFFFFFFFFFFFFFFFFull;
+	for (U32 c = 0; c < count; ++c)
+	{
+		SimulationChannelDescriptor& desc = descriptors[c];
+		if (desc.GetCurrentSampleNumber() < loaded_up_to)
+			loaded_up_to = desc.GetCurrentSampleNumber();
+
+		if (desc.GetChannel() != mStopChannel)
+			continue;
+
+		desc.TakeTransitions(mTransitions);
+
+		U64 needed = mStopTransitions - mStopChannelTransitions;
+		if (mTransitions.size() >= needed)
+		{
+			end_sample = mTransitions[needed - 1];
+			mTransitions.resize(needed);
+		}
+
+		mStopChannelTransitions += mTransitions.size();
+
+		AnalyzerChannelData* data = mChannels[mStopChannel];
+		if (data == NULL)
+			data = AddChannel(mStopChannel, desc.GetInitialBitState());
+
+		for (std::vector<U64>::const_iterator it(mTransitions.begin()); it != mTransitions.end(); ++it)
+			data->AppendTransition(*it);
+
+		mNumTransitions += mTransitions.size();
+	}
+
+	// The simulation makes whole cycles, but a live capture has only been recorded up to where
+	// we asked for. The transitions after that are already in, they just aren't current data yet.
+	if (mLive  &&  loaded_up_to > mRequestedSample)
+		loaded_up_to = mRequestedSample;
+
+	for (U32 c = 0; c < count; ++c)
+	{
+		SimulationChannelDescriptor& desc = descriptors[c];
+		if (desc.GetChannel() == mStopChannel)
+			continue;
+
+		AnalyzerChannelData* data = mChannels[desc.GetChannel()];
+		if (data == NULL)
+			data = AddChannel(desc.GetChannel(), desc.GetInitialBitState());
+
+		desc.TakeTransitions(mTransitions);
+		for (std::vector<U64>::const_iterator it(mTransitions.begin()); it != mTransitions.end()  &&  *it <= end_sample; ++it)
+		{
+			data->AppendTransition(*it);
+			++mNumTransitions;
+		}
+	}
+
+	for (std::map<Channel, AnalyzerChannelData*>::iterator it(mChannels.begin()); it != mChannels.end(); ++it)
+	{
+		it->second->SetLoadedUpTo(loaded_up_to);
+		if (end_sample != 0xFFFFFFFFFFFFFFFFull)
+			it->second->SetEndOfCapture();
+	}
+
+	if (end_sample != 0xFFFFFFFFFFFFFFFFull)
+	{
+		mEnded = true;
+		mEndSample = end_sample;
+	} else {
+		mEndSample = loaded_up_to;
+	}
+
+	mLoadSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
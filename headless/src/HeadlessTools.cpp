@@ -0,0 +1,79 @@
+#include <cstring>
+
+#include <sys/resource.h>
+
+#include "HeadlessTools.h"
+
+bool lookup(const NamedValue* values, const char* name, int& value)
+{
+	for (; values->mName != NULL; ++values)
+	{
+		if (::strcmp(values->mName, name) == 0)
+		{
+			value = values->mValue;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool set_channel(AnalyzerSettings* settings, const char* title, const Channel& channel)
+{
+	AnalyzerSettingInterfaceChannel* iface = (AnalyzerSettingInterfaceChannel*) settings->FindInterface(title);
+	if (iface == NULL  ||  iface->GetType() != INTERFACE_CHANNEL)
+		return false;
+
+	iface->SetChannel(channel);
+	return true;
+}
+
+bool set_number(AnalyzerSettings* settings, const char* title, double number)
+{
+	AnalyzerSettingInterfaceNumberList* iface = (AnalyzerSettingInterfaceNumberList*) settings->FindInterface(title);
+	if (iface == NULL  ||  iface->GetType() != INTERFACE_NUMBER_LIST)
+		return false;
+
+	iface->SetNumber(number);
+	return true;
+}
+
+bool set_integer(AnalyzerSettings* settings, const char* title, int integer)
+{
+	AnalyzerSettingInterfaceInteger* iface = (AnalyzerSettingInterfaceInteger*) settings->FindInterface(title);
+	if (iface == NULL  ||  iface->GetType() != INTERFACE_INTEGER)
+		return false;
+
+	iface->SetInteger(integer);
+	return true;
+}
+
+bool set_text(AnalyzerSettings* settings, const char* title, const char* text)
+{
+	AnalyzerSettingInterfaceText* iface = (AnalyzerSettingInterfaceText*) settings->FindInterface(title);
+	if (iface == NULL  ||  iface->GetType() != INTERFACE_TEXT)
+		return false;
+
+	iface->SetText(text);
+	return true;
+}
+
+void load_transitions(HeadlessCapture& capture, const Channel& channel, BitState& initial_state, std::vector<U64>& transitions)
+{
+	AnalyzerChannelData* data = capture.GetChannelData(channel);
+
+	initial_state = data->GetBitState();
+	transitions.clear();
+	while (data->DoMoreTransitionsExistInCurrentData())
+	{
+		transitions.push_back(data->GetSampleOfNextEdge());
+		data->AdvanceToNextEdge();
+	}
+}
+
+double peak_rss_mb()
+{
+	struct rusage usage;
+	::getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_maxrss / 1024.0;
+}
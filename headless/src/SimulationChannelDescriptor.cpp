@@ -0,0 +1,131 @@
+#include <assert.h>
+
+#include "SimulationChannelDescriptor.h"
+
+SimulationChannelDescriptor::SimulationChannelDescriptor()
+:	mSampleRateHz(0),
+	mInitialBitState(BIT_LOW),
+	mCurrentBitState(BIT_LOW),
+	mCurrentSampleNumber(0)
+{}
+
+SimulationChannelDescriptor::SimulationChannelDescriptor(const SimulationChannelDescriptor& other)
+:	mChannel(other.mChannel),
+	mSampleRateHz(other.mSampleRateHz),
+	mInitialBitState(other.mInitialBitState),
+	mCurrentBitState(other.mCurrentBitState),
+	mCurrentSampleNumber(other.mCurrentSampleNumber),
+	mTransitions(other.mTransitions)
+{}
+
+SimulationChannelDescriptor::~SimulationChannelDescriptor()
+{}
+
+SimulationChannelDescriptor& SimulationChannelDescriptor::operator=(const SimulationChannelDescriptor& other)
+{
+	mChannel = other.mChannel;
+	mSampleRateHz = other.mSampleRateHz;
+	mInitialBitState = other.mInitialBitState;
+	mCurrentBitState = other.mCurrentBitState;
+	mCurrentSampleNumber = other.mCurrentSampleNumber;
+	mTransitions = other.mTransitions;
+	return *this;
+}
+
+void SimulationChannelDescriptor::Transition()
+{
+	mCurrentBitState = Toggle(mCurrentBitState);
+	mTransitions.push_back(mCurrentSampleNumber);
+}
+
+void SimulationChannelDescriptor::TransitionIfNeeded(BitState bit_state)
+{
+	if (bit_state != mCurrentBitState)
+		Transition();
+}
+
+void SimulationChannelDescriptor::Advance(U32 num_samples_to_advance)
+{
+	mCurrentSampleNumber += num_samples_to_advance;
+}
+
+BitState SimulationChannelDescriptor::GetCurrentBitState()
+{
+	return mCurrentBitState;
+}
+
+U64 SimulationChannelDescriptor::GetCurrentSampleNumber()
+{
+	return mCurrentSampleNumber;
+}
+
+void SimulationChannelDescriptor::SetChannel(Channel& channel)
+{
+	mChannel = channel;
+}
+
+void SimulationChannelDescriptor::SetSampleRate(U32 sample_rate_hz)
+{
+	mSampleRateHz = sample_rate_hz;
+}
+
+void SimulationChannelDescriptor::SetInitialBitState(BitState intial_bit_state)
+{
+	mInitialBitState = mCurrentBitState = intial_bit_state;
+}
+
+Channel SimulationChannelDescriptor::GetChannel()
+{
+	return mChannel;
+}
+
+U32 SimulationChannelDescriptor::GetSampleRate()
+{
+	return mSampleRateHz;
+}
+
+BitState SimulationChannelDescriptor::GetInitialBitState()
+{
+	return mInitialBitState;
+}
+
+void SimulationChannelDescriptor::TakeTransitions(std::vector<U64>& transitions)
+{
+	transitions.swap(mTransitions);
+	mTransitions.clear();
+}
+
+SimulationChannelDescriptorGroup::SimulationChannelDescriptorGroup()
+:	mCount(0)
+{}
+
+SimulationChannelDescriptorGroup::~SimulationChannelDescriptorGroup()
+{}
+
+SimulationChannelDescriptor* SimulationChannelDescriptorGroup::Add(Channel& channel, U32 sample_rate, BitState intial_bit_state)
+{
+	assert(mCount < MAX_CHANNELS);
+
+	SimulationChannelDescriptor* desc = &mChannels[mCount++];
+	desc->SetChannel(channel);
+	desc->SetSampleRate(sample_rate);
+	desc->SetInitialBitState(intial_bit_state);
+
+	return desc;
+}
+
+void SimulationChannelDescriptorGroup::AdvanceAll(U32 num_samples_to_advance)
+{
+	for (U32 c = 0; c < mCount; ++c)
+		mChannels[c].Advance(num_samples_to_advance);
+}
+
+SimulationChannelDescriptor* SimulationChannelDescriptorGroup::GetArray()
+{
+	return mChannels;
+}
+
+U32 SimulationChannelDescriptorGroup::GetCount()
+{
+	return mCount;
+}
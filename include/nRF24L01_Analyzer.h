@@ -1,10 +1,21 @@
 #pragma once
 
+#include <memory>
+
 #include <Analyzer.h>
 
 #include "nRF24L01_AnalyzerResults.h"
 #include "nRF24L01_AnalyzerSettings.h"
 #include "nRF24L01_SimulationDataGenerator.h"
+#include "nRFSpiDecoder.h"
+#include "nRFSegmentDecoder.h"
+
+// the optional channels that are connected, the decode loops are made for each combination
+enum nRFChannelSet_e
+{
+	CH_CSN		= (1 << 0),
+	CH_MISO		= (1 << 1),
+};
 
 class nRF24L01_Analyzer : public Analyzer
 {
@@ -19,25 +30,89 @@ public:
 	virtual const char* GetAnalyzerName() const;
 	virtual bool NeedsRerun();
 
+	// Decodes a capture that's all in memory on num_threads threads (0 is one per core) instead
+	// of streaming it through WorkerThread(), the frames are the same. Needs CSN to find the windows,
+	// returns false without it.
+	bool DecodeOffline(const nRFBusEdges& bus, U32 num_threads);
+
+	// the results of the next decode keep only what a streaming decoder needs, see nRF24L01_AnalyzerResults::SetStreaming()
+	void SetStreaming(bool streaming)		{ mStreaming = streaming; }
+
+	// the simulation puts an oversize burst into every 16th cycle, for the bench
+	void SetSimulateOversizeBursts(bool oversize_bursts)		{ mSimulationDataGenerator.SetOversizeBursts(oversize_bursts); }
+
 protected:	// vars
 
 	nRF24L01_AnalyzerSettings					mSettings;
 	std::unique_ptr<nRF24L01_AnalyzerResults>	mResults;
 
-	AnalyzerChannelData*	mMiso;
+	AnalyzerChannelData*	mMiso;		// NULL if not connected
 	AnalyzerChannelData*	mMosi;
 	AnalyzerChannelData*	mSck;
-	AnalyzerChannelData*	mCsn;
+	AnalyzerChannelData*	mCsn;		// of the radio whose transaction we're decoding, NULL if not connected
+
+	// without CSN a transaction ends when SCK has been idle this many samples
+	U64						mSckIdleGap;
+
+	// the radios share SCK, MOSI and MISO, we go through those once for all of them
+	AnalyzerChannelData*	mCsns[MAX_RADIOS];
+	U32						mNumRadios;
+
+	// a new results object and the channels its bubbles go on
+	void CreateResults();
+
+	// moves mCsn to the next falling edge of any radio's CSN, returns the radio
+	U8 NextCsnWindow();
+	bool IsCaughtUp();
 
 	nRF24L01_SimulationDataGenerator mSimulationDataGenerator;
 
 	bool mSimulationInitilized;
 
+	bool mStreaming;
+
+	// Gets the bytes of the window that starts at window_start. Picked once per capture from the decoder,
+	// the SPI mode, the markers and the connected channels, so the loops don't check those on every bit.
+	typedef void (nRF24L01_Analyzer::*GetBytesFn)(SpiTransactionBuffer& spi_bytes, U64 window_start);
+	GetBytesFn	mGetBytes;
+
+	template <nRFSpiMode_e MODE>
+	GetBytesFn SelectGetBytes() const;
+	template <nRFSpiMode_e MODE, U32 CH>
+	GetBytesFn SelectDecoder() const;
+
+	// edge-list batch decoder
+	SpiSckEdges		mSckEdges;
+	ChannelSampler	mMosiSampler;
+	ChannelSampler	mMisoSampler;
+
+	template <nRFSpiMode_e MODE, bool MARK_BITS, U32 CH>
+	void GetBytesBatch(SpiTransactionBuffer& spi_bytes, U64 window_start);
+	template <U32 CH>
+	void CollectSckEdges(U64 csn_edge);
+
+	// do we need the sample of every bit for the markers?
+	bool mMarkBits;
+
+	// per-bit decoder
+	template <nRFSpiMode_e MODE, U32 CH>
+	void GetBytesPerBit(SpiTransactionBuffer& spi_bytes, U64 window_start);
+	template <nRFSpiMode_e MODE, U32 CH>
 	bool GetByte(SpiByte& b, const bool is_first_byte_of_command);
+	template <U32 CH>
+	bool GetByteAuto(SpiByte& b, const bool is_first_byte_of_command);
+	template <U32 CH>
 	void SyncToSample(U64 sample);
-	void SyncToChannel(AnalyzerChannelData* channel);
 
-	bool AdvanceSck(U64 not_past_sample);
+	// the end of the window is the CSN edge, or the SCK idle gap without CSN
+	template <U32 CH>
+	U64 GetCsnEdge();
+	template <U32 CH>
+	bool IsSckEdgeInWindow(U64 csn_edge);
+	template <U32 CH>
+	void EndWindow(U64 csn_edge);
+	template <U32 CH>
+	bool AdvanceSck(U64 csn_edge);
 };
 
 extern "C" ANALYZER_EXPORT const char* __cdecl GetAnalyzerName();
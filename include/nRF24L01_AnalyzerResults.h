@@ -2,7 +2,17 @@
 
 #include <AnalyzerResults.h>
 
+#include "nRFCsvExporter.h"
+
 #include "nRFTypes.h"
+#include "nRFPayloadStore.h"
+#include "nRFCommandCache.h"
+#include "nRFRegisterShadow.h"
+#include "nRFOperations.h"
+#include "nRFStatistics.h"
+#include "nRFPayloadIndex.h"
+#include "nRFEventIndex.h"
+#include "nRFSampleIndex.h"
 
 class nRF24L01_Analyzer;
 class nRF24L01_AnalyzerSettings;
@@ -20,16 +30,114 @@ public:
 	virtual void GeneratePacketTabularText(U64 packet_id, DisplayBase display_base);
 	virtual void GenerateTransactionTabularText(U64 transaction_id, DisplayBase display_base);
 
-	bool CreateFramesFromSpiBytes(const std::vector<SpiByte>& spi_bytes, U64 csnLow, U64 csnHi);
+	// Returns true if the bytes made a command. radio is the index of the CSN they came in on.
+	// Oversize bursts get one error frame and no command, and return false.
+	bool CreateFramesFromSpiBytes(const SpiTransactionBuffer& spi_bytes, U64 csnLow, U64 csnHi, U8 radio);
+
+	// Commits the frames added since the last commit.
+	// While the decoder is behind the capture the commits are batched by count and sample span,
+	// once it has caught up with the data every transaction is committed right away.
+	void CommitIfNeeded(bool caught_up);
+
+	// adds the markers of a transaction for the selected marker density
+	void AddMarkers(const SpiTransactionBuffer& spi_bytes, U64 csnLow, U64 csnHi, U8 radio);
+
+	// how many markers we've added, and roughly how much memory they take in the SDK
+	U64 GetMarkerCount() const		{ return mMarkerCount; }
+	U64 GetMarkerBytes() const		{ return mMarkerCount * (sizeof(U64) + sizeof(MarkerType)); }
+
+	const nRFPayloadStore& GetExtendedData() const		{ return mExtendedData; }
+	const nRFCommandCache& GetCommandCache() const		{ return mCommandCache; }
+	const nRFRegisterShadow& GetRegisterShadow(U32 radio) const	{ return mRegisterShadows[radio]; }
+	const nRFOperationGrouper& GetOperations() const	{ return mOperations; }
+	const nRFStatistics& GetStatistics() const			{ return mStatistics; }
+	const nRFPayloadIndex& GetPayloadIndex() const		{ return mPayloadIndex; }
+
+	// the data frames of the payloads that contain the pattern, in order
+	void FindPayload(const U8* pattern, U32 length, std::vector<U64>& frame_indices);
+
+	const nRFEventIndex& GetEventIndex() const			{ return mEventIndex; }
+
+	// the first command frame at or after from_sample that's in all the sets (nRFEventSet_e),
+	// or INVALID_RESULT_INDEX
+	U64 FindNextEvent(const U8* sets, size_t num_sets, U64 from_sample);
+
+	const nRFSampleIndex& GetSampleIndex() const		{ return mSampleIndex; }
+
+	// the text, filtered and binary exports only write the transactions that start in [from_sample, to_sample]
+	void SetExportRange(U64 from_sample, U64 to_sample);
+
+	// the number of rows of the last export
+	U64 GetExportedRows() const		{ return mExportedRows; }
+
+	// For a decoder that writes the frames out as it goes and drops them: only the frames, the long
+	// payloads and the statistics are kept. The operations, the register shadows and the indexes
+	// all grow with the capture, so they're left empty, and so are the exports that need them.
+	void SetStreaming(bool streaming)	{ mStreaming = streaming; }
+
+	// The streaming decoder has written out and discarded the committed frames,
+	// so the long payloads only they needed can go.
+	void ReleaseDrainedPayloads();
+
+protected:
+	void GenerateBinaryExportFile(const char* file);
+	void GenerateStatisticsExportFile(const char* file);
+	void GenerateFilteredExportFile(const char* file, DisplayBase display_base);
+	void WriteTextExport(const char* file, DisplayBase display_base, const nRFCsvExporter::ReadRowsFn& read_rows);
+
+	void AddOversizeBurst(U64 csnLow, U64 csnHi, U8 radio);
+	void GetOversizeBurstTexts(const Frame& f, nRFTextList& texts);
+
+	// the decoded command of the transaction frame_index belongs to
+	void GetCommand(U64 frame_index, const Frame& f, nRFCommand& cmd);
+
+	bool PayloadContains(U64 frame_index, const U8* pattern, U32 length);
+
+	// the channel and address a payload went out on or came in from, as far as we know them
+	void GetEffectiveState(U64 cmd_frame_index, const nRFCommand& cmd, nRFShortText& text, DisplayBase display_base);
 
 protected:  //vars
 
 	// used for storing data that doesn't fit into Frame's mData1 and mData2
-	std::vector<U8>		mExtendedData;
+	nRFPayloadStore		mExtendedData;
 
 	nRF24L01_AnalyzerSettings*	mSettings;
 	nRF24L01_Analyzer*			mAnalyzer;
 
-	nRFCommand		mCommand;
-	U64				mCommandWordFrameIndex;
+	// the commands decoded for the bubbles
+	nRFCommandCache	mCommandCache;
+
+	// the registers of each radio as written and read so far
+	nRFRegisterShadow	mRegisterShadows[MAX_RADIOS];
+
+	// every transaction is a packet, the operations they make up are the SDK's transactions
+	nRFOperationGrouper	mOperations;
+
+	// counted while decoding, in 100ms windows
+	nRFStatistics		mStatistics;
+
+	// for searching the payloads
+	nRFPayloadIndex		mPayloadIndex;
+
+	// for jumping to the next event
+	nRFEventIndex		mEventIndex;
+
+	// for seeking by sample
+	nRFSampleIndex		mSampleIndex;
+
+	U64				mMarkerCount;
+
+	bool			mStreaming;
+
+	// the commit batch
+	U64				mPendingTransactions;
+	U64				mPendingStartSample;
+	U64				mPendingEndSample;
+	U64				mCommitSpan;
+
+	U64				mExportedRows;
+
+	// the range SetExportRange set
+	U64				mExportFromSample;
+	U64				mExportToSample;
 };
@@ -3,6 +3,33 @@
 #include <AnalyzerSettings.h>
 #include <AnalyzerTypes.h>
 
+#include <string>
+
+#include "nRFTypes.h"
+
+enum nRFDecoder_e
+{
+	DECODER_PER_BIT,	// resync all the channels on every SCK edge
+	DECODER_BATCH,		// collect the SCK edges of a CSN window, then sample MOSI/MISO on them
+};
+
+enum nRFMarkers_e
+{
+	MARKERS_NONE,
+	MARKERS_CSN,		// CSN start/stop only
+	MARKERS_SCK,		// SCK edges only
+	MARKERS_FULL,		// CSN, SCK and the MOSI/MISO bits
+};
+
+// the user_id of the export options
+enum nRFExport_e
+{
+	EXPORT_TEXT,		// text/csv, one line per transaction
+	EXPORT_BINARY,		// columnar binary, see nRFBinaryFormat.h
+	EXPORT_STATISTICS,	// counters and histograms, see nRFStatistics.h
+	EXPORT_FILTERED,	// like EXPORT_TEXT, only the transactions mExportFilter matches
+};
+
 class nRF24L01_AnalyzerSettings : public AnalyzerSettings
 {
 public:
@@ -15,20 +42,36 @@ public:
 
 	void UpdateInterfacesFromSettings();
 
+	// "CSN", "CSN 2" and so on
+	static const char* GetCsnName(U32 radio);
+
 	Channel		mMosiChannel;
 	Channel		mMisoChannel;
 	Channel		mSckChannel;
-	Channel		mCsnChannel;
+	Channel		mCsnChannels[MAX_RADIOS];	// one per radio on the bus, the first mNumRadios are set
+	U32			mNumRadios;
 
-	//bool		mMarkBits;
-	//bool		mMarkStartEnd;
+	nRFDecoder_e	mDecoder;
+	nRFMarkers_e	mMarkers;
+	nRFSpiMode_e	mSpiMode;
+	U32				mPayloadRamMB;		// long payloads above this go to a temp file, 0 for no limit
+	U32				mSckIdleGapNs;		// without CSN, this long without SCK edges ends a transaction
+	std::string		mExportFilter;		// see nRFExportFilter.h
 
 protected:
 	AnalyzerSettingInterfaceChannel		mMosiChannelInterface;
 	AnalyzerSettingInterfaceChannel		mMisoChannelInterface;
 	AnalyzerSettingInterfaceChannel		mSckChannelInterface;
-	AnalyzerSettingInterfaceChannel		mCsnChannelInterface;
+	AnalyzerSettingInterfaceChannel		mCsnChannelInterfaces[MAX_RADIOS];
+
+	AnalyzerSettingInterfaceNumberList	mDecoderInterface;
+	AnalyzerSettingInterfaceNumberList	mMarkersInterface;
+	AnalyzerSettingInterfaceNumberList	mSpiModeInterface;
+	AnalyzerSettingInterfaceInteger		mPayloadRamMBInterface;
+	AnalyzerSettingInterfaceInteger		mSckIdleGapNsInterface;
+	AnalyzerSettingInterfaceText		mExportFilterInterface;
+
+	std::string		mErrorText;
 
-	//AnalyzerSettingInterfaceBool		mMarkBitsInterface;
-	//AnalyzerSettingInterfaceBool		mMarkStartEndInterface;
+	void AddChannels(bool is_used);
 };
@@ -2,6 +2,8 @@
 
 #include <AnalyzerHelpers.h>
 
+#include "nRFTypes.h"
+
 class nRF24L01_AnalyzerSettings;
 
 class nRF24L01_SimulationDataGenerator
@@ -13,6 +15,9 @@ public:
 	void Initialize(U32 simulation_sample_rate, nRF24L01_AnalyzerSettings* settings);
 	U32 GenerateSimulationData( U64 newest_sample_requested, U32 sample_rate, SimulationChannelDescriptor** simulation_channels );
 
+	// every 16th cycle gets an oversize burst, off unless the bench wants them
+	void SetOversizeBursts(bool oversize_bursts)		{ mOversizeBursts = oversize_bursts; }
+
 protected:
 	nRF24L01_AnalyzerSettings*	mSettings;
 	U32			mSimulationSampleRateHz;
@@ -21,6 +26,10 @@ protected:	// SPI specific
 
 	ClockGenerator mClockGenerator;
 
+	U8	mSequence;		// goes into the long payload so it's not the same every time
+	U32	mRadio;			// whose CSN the next cycle is on
+	bool	mOversizeBursts;
+
 	void CreateNRFTransaction();
 	void NewCommand();
 
@@ -31,5 +40,6 @@ protected:	// SPI specific
 	SimulationChannelDescriptor* mMiso;
 	SimulationChannelDescriptor* mMosi;
 	SimulationChannelDescriptor* mSck;
-	SimulationChannelDescriptor* mCsn;
+	SimulationChannelDescriptor* mCsn;		// of the radio the current cycle is for
+	SimulationChannelDescriptor* mCsns[MAX_RADIOS];
 };
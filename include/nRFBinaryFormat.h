@@ -0,0 +1,63 @@
+#pragma once
+
+#include <LogicPublicTypes.h>
+
+// The binary export: a header, one array per column, then the payload bytes.
+// Numbers are in the byte order of the machine that wrote the file and every section
+// starts on an 8 byte boundary, so the file can be memory-mapped and the columns used
+// in place. mByteOrder tells a reader on a machine with the other byte order.
+// There is one row per transaction.
+
+#define NRF_BINARY_MAGIC		"nRF24col"
+#define NRF_BINARY_BYTE_ORDER	0x0102030405060708ULL
+
+enum
+{
+	NRF_BINARY_VERSION		= 3,
+	NRF_BINARY_ALIGN		= 8,
+};
+
+struct nRFBinaryHeader
+{
+	char	mMagic[8];			// NRF_BINARY_MAGIC, not terminated
+	U64		mByteOrder;			// NRF_BINARY_BYTE_ORDER as the writer stored it
+	U32		mVersion;
+	U32		mHeaderSize;		// sizeof(nRFBinaryHeader)
+
+	U64		mSampleRate;
+	U64		mTriggerSample;
+
+	U64		mNumRows;
+	U64		mPayloadBytes;
+
+	// where the sections start, from the beginning of the file
+	U64		mSampleColumn;		// U64: the first sample of the transaction
+	U64		mCommandColumn;		// U8: the command byte
+	U64		mStatusColumn;		// U8: the STATUS register
+	U64		mRegisterColumn;	// U8: the register, 0xFF if it's not a register command
+	U64		mLengthColumn;		// U8: the number of data bytes
+	U64		mRadioColumn;		// U8: whose CSN it came in on, 0 for CSN, 1 for CSN 2...
+	U64		mPayloadColumn;		// U64: where the data bytes start in the payload blob
+	U64		mPayloadBlob;
+};
+
+inline U64 nRFBinaryAlign(U64 offset)
+{
+	return (offset + NRF_BINARY_ALIGN - 1) & ~U64(NRF_BINARY_ALIGN - 1);
+}
+
+// lays out the columns for num_rows rows
+inline void nRFBinaryLayout(nRFBinaryHeader& header, U64 num_rows)
+{
+	U64 offset = nRFBinaryAlign(sizeof(nRFBinaryHeader));
+
+	header.mNumRows = num_rows;
+	header.mSampleColumn = offset;		offset = nRFBinaryAlign(offset + num_rows * sizeof(U64));
+	header.mCommandColumn = offset;		offset = nRFBinaryAlign(offset + num_rows);
+	header.mStatusColumn = offset;		offset = nRFBinaryAlign(offset + num_rows);
+	header.mRegisterColumn = offset;	offset = nRFBinaryAlign(offset + num_rows);
+	header.mLengthColumn = offset;		offset = nRFBinaryAlign(offset + num_rows);
+	header.mRadioColumn = offset;		offset = nRFBinaryAlign(offset + num_rows);
+	header.mPayloadColumn = offset;		offset = nRFBinaryAlign(offset + num_rows * sizeof(U64));
+	header.mPayloadBlob = offset;
+}
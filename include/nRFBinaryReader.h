@@ -0,0 +1,60 @@
+#pragma once
+
+#include <LogicPublicTypes.h>
+
+#include <string>
+
+#include "nRFBinaryFormat.h"
+#include "nRFTypes.h"
+
+// Reads the binary export by mapping it into memory. The column accessors point
+// straight into the mapping, nothing is parsed or copied.
+class nRFBinaryReader
+{
+public:
+	nRFBinaryReader();
+	~nRFBinaryReader();
+
+	bool Open(const char* file_name);
+	void Close();
+
+	// why Open failed
+	const std::string& GetError() const		{ return mError; }
+
+	const nRFBinaryHeader& GetHeader() const	{ return *mHeader; }
+	U64 GetNumRows() const					{ return mHeader->mNumRows; }
+
+	const U64* GetSamples() const			{ return (const U64*) (mData + mHeader->mSampleColumn); }
+	const U8* GetCommandBytes() const		{ return mData + mHeader->mCommandColumn; }
+	const U8* GetStatuses() const			{ return mData + mHeader->mStatusColumn; }
+	const U8* GetRegisters() const			{ return mData + mHeader->mRegisterColumn; }
+	const U8* GetLengths() const			{ return mData + mHeader->mLengthColumn; }
+	const U8* GetRadios() const				{ return mData + mHeader->mRadioColumn; }
+	const U64* GetPayloadOffsets() const	{ return (const U64*) (mData + mHeader->mPayloadColumn); }
+
+	// the data bytes of a row, GetLengths()[row] of them
+	const U8* GetPayload(U64 row) const		{ return mData + mHeader->mPayloadBlob + GetPayloadOffsets()[row]; }
+
+	// seconds from the trigger
+	double GetTime(U64 row) const
+	{
+		return double(S64(GetSamples()[row] - mHeader->mTriggerSample)) / double(mHeader->mSampleRate);
+	}
+
+	// rebuilds the decoded command of a row, as nRFCommand::Decode would from the frames
+	void GetCommand(U64 row, nRFCommand& cmd) const;
+
+protected:
+	bool Validate();
+
+	const U8*				mData;
+	U64						mSize;
+	const nRFBinaryHeader*	mHeader;
+
+	std::string				mError;
+
+#ifdef _WINDOWS
+	void*					mFile;
+	void*					mMapping;
+#endif
+};
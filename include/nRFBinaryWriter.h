@@ -0,0 +1,79 @@
+#pragma once
+
+#include <LogicPublicTypes.h>
+
+#include <cstdio>
+#include <ostream>
+#include <vector>
+
+#include "nRFBinaryFormat.h"
+#include "nRFTypes.h"
+
+// Writes the binary export. The columns are laid out by the number of rows; the rows
+// are buffered and written one column slice at a time, and the payloads go to the end
+// of the file. When the number of rows isn't known up front the columns are spooled
+// to temp files instead and copied into place by Finish().
+class nRFBinaryWriter
+{
+public:
+	enum { CHUNK_ROWS = 65536 };
+
+	nRFBinaryWriter(std::ostream& out, U64 num_rows, U64 sample_rate, U64 trigger_sample);
+
+	// spools the columns, for when the rows are still being decoded
+	nRFBinaryWriter(std::ostream& out, U64 sample_rate, U64 trigger_sample);
+
+	~nRFBinaryWriter();
+
+	void AddRow(U64 starting_sample, const nRFCommand& cmd);
+
+	// writes out the buffered rows, returns false if the stream failed
+	bool Flush();
+
+	// writes the header, call after the last row
+	bool Finish();
+
+	U64 GetNumRows() const			{ return mRowsWritten + mSamples.size(); }
+
+protected:
+	enum
+	{
+		SPOOL_SAMPLES,
+		SPOOL_COMMANDS,
+		SPOOL_STATUSES,
+		SPOOL_REGISTERS,
+		SPOOL_LENGTHS,
+		SPOOL_RADIOS,
+		SPOOL_PAYLOAD_OFFSETS,
+		SPOOL_PAYLOADS,
+
+		NUM_SPOOLS
+	};
+
+	void Init(U64 sample_rate, U64 trigger_sample);
+
+	void WriteAt(U64 offset, const void* data, size_t size);
+
+	bool Spool(int spool, const void* data, size_t size);
+	bool CopySpool(int spool, U64 offset);
+
+	std::ostream&		mOut;
+	nRFBinaryHeader		mHeader;
+
+	U64					mRowsWritten;
+
+	// the rows not written yet
+	std::vector<U64>	mSamples;
+	std::vector<U8>		mCommands;
+	std::vector<U8>		mStatuses;
+	std::vector<U8>		mRegisters;
+	std::vector<U8>		mLengths;
+	std::vector<U8>		mRadios;
+	std::vector<U64>	mPayloadOffsets;
+	std::vector<U8>		mPayloads;
+
+	// one temp file per column if we're spooling
+	bool				mSpooling;
+	FILE*				mSpools[NUM_SPOOLS];
+	bool				mSpoolFailed;
+};
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <LogicPublicTypes.h>
+
+#include <mutex>
+#include <atomic>
+
+#include "nRFTypes.h"
+
+// The recently decoded commands, by the frame index of their command frame.
+// The entries are spread over shards with a lock each, so the UI can look up
+// bubbles while the worker thread is still adding frames.
+class nRFCommandCache
+{
+public:
+	enum
+	{
+		NUM_SHARDS	= 16,
+		NUM_SETS	= 16,		// per shard
+		NUM_WAYS	= 4,		// per set
+	};
+
+	nRFCommandCache();
+
+	// copies the cached command into cmd, returns false on a miss
+	bool Find(U64 cmd_frame_index, nRFCommand& cmd);
+
+	void Insert(U64 cmd_frame_index, const nRFCommand& cmd);
+
+	void Clear();
+
+	U64 GetHits() const			{ return mHits; }
+	U64 GetMisses() const		{ return mMisses; }
+
+protected:
+	// a few entries a command can go into, the least recently used one is replaced
+	struct Set
+	{
+		U64			mFrameIndex[NUM_WAYS];
+		U64			mLastUsed[NUM_WAYS];		// 0 if the entry is empty
+		nRFCommand	mCommand[NUM_WAYS];
+	};
+
+	struct Shard
+	{
+		std::mutex	mLock;
+		U64			mTick;
+		Set			mSets[NUM_SETS];
+	};
+
+	// consecutive commands end up in different shards
+	Shard& GetShard(U64 cmd_frame_index)
+	{
+		return mShards[cmd_frame_index % NUM_SHARDS];
+	}
+
+	static Set& GetSet(Shard& shard, U64 cmd_frame_index)
+	{
+		return shard.mSets[(cmd_frame_index / NUM_SHARDS) % NUM_SETS];
+	}
+
+	static int FindWay(const Set& set, U64 cmd_frame_index)
+	{
+		for (int way = 0; way < NUM_WAYS; ++way)
+		{
+			if (set.mFrameIndex[way] == cmd_frame_index  &&  set.mLastUsed[way] != 0)
+				return way;
+		}
+
+		return -1;
+	}
+
+	Shard				mShards[NUM_SHARDS];
+
+	std::atomic<U64>	mHits;
+	std::atomic<U64>	mMisses;
+};
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <LogicPublicTypes.h>
+
+#include <ostream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "nRFTypes.h"
+
+// one line of the export
+struct nRFExportRow
+{
+	U64			mStartingSample;
+	bool		mHasData;
+	nRFCommand	mCommand;
+};
+
+// Writes the text/csv export. The rows are read and decoded in chunks on the calling
+// thread, formatted by a pool of worker threads, and written out in order, one write
+// per chunk.
+class nRFCsvExporter
+{
+public:
+	enum
+	{
+		CHUNK_ROWS	= 4096,
+		MAX_WORKERS	= 8,
+	};
+
+	// Appends up to CHUNK_ROWS rows and sets frames_done to the number of frames read so far.
+	// Returns the number of rows added, 0 when there are no more.
+	typedef std::function<size_t (std::vector<nRFExportRow>& rows, U64& frames_done)>	ReadRowsFn;
+
+	// Called after each chunk is written, returns true to cancel the export.
+	typedef std::function<bool (U64 frames_done)>	ProgressFn;
+
+	// With csn_column there's a column with the number of the radio's CSN, for buses with more than one.
+	nRFCsvExporter(DisplayBase display_base, U64 trigger_sample, U32 sample_rate, bool csn_column);
+
+	// writes the header and the rows, returns the number of rows written
+	U64 Export(std::ostream& out, const ReadRowsFn& read_rows, const ProgressFn& progress);
+
+	bool WasCancelled() const		{ return mCancelled; }
+
+	const char* GetHeader() const
+	{
+		return mCsnColumn ? "Time [s];CSN;Status;Command;Data\n" : "Time [s];Status;Command;Data\n";
+	}
+
+protected:
+	struct Chunk
+	{
+		std::vector<nRFExportRow>	mRows;
+		std::string					mText;
+		U64							mFramesDone;
+		bool						mFormatted;
+	};
+
+	void WorkerThread();
+	void FormatChunk(Chunk& chunk, nRFTextList& texts);
+
+	DisplayBase		mDisplayBase;
+	U64				mTriggerSample;
+	U32				mSampleRate;
+	bool			mCsnColumn;
+	bool			mCancelled;
+
+	// the chunks waiting for a worker
+	std::mutex					mLock;
+	std::condition_variable		mWorkReady;
+	std::condition_variable		mChunkFormatted;
+	std::deque<Chunk*>			mQueue;
+	bool						mStopping;
+};
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <LogicPublicTypes.h>
+
+#include <vector>
+#include <mutex>
+
+#include "nRFTypes.h"
+
+// A set of frame indices, roaring style: split by the upper bits into containers of 64K,
+// each a sorted array while it's sparse and a bitmap once it's dense.
+// The indices have to be added in order.
+class nRFEventBitmap
+{
+public:
+	enum
+	{
+		CONTAINER_BITS	= 16,
+		MAX_ARRAY		= 4096,		// a bitmap is smaller from here on
+		BITMAP_WORDS	= (1 << CONTAINER_BITS) / 64,
+	};
+
+	nRFEventBitmap()
+		: mCount(0)
+	{}
+
+	void Add(U64 index);
+
+	// the first index >= from, or INVALID_INDEX
+	U64 FindNext(U64 from) const;
+
+	U64 GetCount() const			{ return mCount; }
+	U64 GetMemoryBytes() const;
+
+	static const U64 INVALID_INDEX = 0xFFFFFFFFFFFFFFFFull;
+
+protected:
+	struct Container
+	{
+		U64					mKey;		// index >> CONTAINER_BITS
+		std::vector<U16>	mArray;
+		std::vector<U64>	mBits;		// used instead of mArray when not empty
+
+		// the first low bits >= from in this container, or -1
+		S32 FindNext(U32 from) const;
+	};
+
+	std::vector<Container>	mContainers;
+	U64						mCount;
+};
+
+// what can be looked for
+enum nRFEventSet_e
+{
+	// STATUS, from the command byte of every transaction
+	SET_RX_DR,
+	SET_TX_DS,
+	SET_MAX_RT,
+	SET_TX_FULL,
+
+	// FIFO_STATUS, when it's read
+	SET_FIFO_TX_REUSE,
+	SET_FIFO_TX_FULL,
+	SET_FIFO_TX_EMPTY,
+	SET_FIFO_RX_FULL,
+	SET_FIFO_RX_EMPTY,
+
+	// one per nRFCommand_e
+	SET_COMMAND,
+
+	NUM_EVENT_SETS = SET_COMMAND + undefined_cmd + 1
+};
+
+// Bitmaps of the command frames by STATUS flags, FIFO_STATUS flags and command,
+// filled as the frames are made. Add and the queries can be called from different threads.
+class nRFEventIndex
+{
+public:
+	void Add(U64 cmd_frame_index, U8 command_byte, U8 status, U8 first_data, U32 data_length);
+
+	// the first command frame >= from_frame that's in all of the sets, or nRFEventBitmap::INVALID_INDEX
+	U64 FindNext(const U8* sets, size_t num_sets, U64 from_frame) const;
+
+	U64 GetCount(U8 set) const;
+	U64 GetMemoryBytes() const;
+
+protected:
+	nRFEventBitmap			mSets[NUM_EVENT_SETS];
+
+	mutable std::mutex		mLock;
+};
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <LogicPublicTypes.h>
+
+#include <string>
+#include <vector>
+#include <functional>
+
+class nRFEventIndex;
+
+// A filter for the export, like
+//
+//     (W_TX_PAYLOAD or R_RX_PAYLOAD) and pipe=1 and time>=0.5
+//
+// The terms are command names, reg=<register>, the STATUS flags RX_DR, TX_DS, MAX_RT and TX_FULL,
+// pipe=<RX_P_NO>, csn=<1 for CSN, 2 for CSN 2...>, data has <hex bytes>, and time>=/time<= in seconds
+// from the trigger, joined with and/or/not and parentheses. It's compiled once, then Prepare looks the payload patterns up,
+// and the export goes from one FindNextCandidate to the next, checking each with Matches.
+class nRFExportFilter
+{
+public:
+	typedef std::function<void (const U8* pattern, U32 length, std::vector<U64>& data_frames)>	FindPayloadFn;
+
+	static const U64 INVALID_FRAME = 0xFFFFFFFFFFFFFFFFull;
+
+	nRFExportFilter();
+
+	// an empty text matches everything
+	bool Compile(const char* text, std::string& error);
+
+	void Prepare(const nRFEventIndex& events, const FindPayloadFn& find_payload, U64 trigger_sample, U32 sample_rate);
+
+	// the samples the time terms limit the export to
+	void GetSampleRange(U64& from_sample, U64& to_sample) const;
+
+	// The first command frame >= from_frame that can match, or INVALID_FRAME.
+	// When the filter can't narrow it down it's from_frame itself.
+	U64 FindNextCandidate(U64 from_frame) const;
+
+	bool Matches(U64 cmd_frame_index, U8 command_byte, U8 status, U8 radio, U64 start_sample) const;
+
+protected:
+	enum NodeType
+	{
+		NODE_AND,
+		NODE_OR,
+		NODE_NOT,
+		NODE_COMMAND,
+		NODE_REGISTER,
+		NODE_FLAG,
+		NODE_PIPE,
+		NODE_CSN,
+		NODE_DATA,
+		NODE_TIME_FROM,
+		NODE_TIME_TO,
+	};
+
+	struct Node
+	{
+		U8					mType;
+		U8					mValue;			// command, register, flag bits, pipe or radio
+		S32					mLeft;
+		S32					mRight;
+		double				mSeconds;
+		U64					mSample;
+		std::vector<U8>		mPattern;
+		std::vector<U64>	mFrames;		// the command frames whose payload has mPattern
+	};
+
+	// the parser
+	bool ParseOr(S32& node);
+	bool ParseAnd(S32& node);
+	bool ParseUnary(S32& node);
+	bool ParseTerm(S32& node);
+
+	bool NextToken();
+	bool IsWord(const char* word) const;
+	bool Fail(const std::string& error);
+	S32 AddNode(U8 type, S32 left = -1, S32 right = -1);
+
+	bool HasSource(S32 node) const;
+	U64 NextCandidate(S32 node, U64 from_frame) const;
+	bool Evaluate(S32 node, U64 cmd_frame_index, U8 command_byte, U8 status, U8 radio, U64 start_sample) const;
+	void GetRange(S32 node, U64& from_sample, U64& to_sample) const;
+
+	std::vector<Node>		mNodes;
+	S32						mRoot;			// -1 for no filter
+
+	const nRFEventIndex*	mEvents;
+
+	// while compiling
+	const char*				mText;
+	std::string				mToken;
+	std::string				mError;
+};
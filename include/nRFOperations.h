@@ -0,0 +1,58 @@
+#pragma once
+
+#include <LogicPublicTypes.h>
+
+#include <vector>
+#include <mutex>
+
+#include "nRFText.h"
+#include "nRFTypes.h"
+
+enum nRFOperation_e
+{
+	OP_SETUP,		// register access, flushes and the like
+	OP_TX,			// loading payloads and waiting for TX_DS or MAX_RT
+	OP_RX,			// reading payloads out and clearing RX_DR
+};
+
+// What a group of transactions did, worked out as they came in.
+struct nRFOperation
+{
+	U8		mType;
+	U8		mRadio;
+	U8		mStatus;			// the last STATUS we saw
+	U8		mEvents;			// the STATUS interrupt bits seen during the operation
+	U8		mPipe;				// of the last payload read
+	U32		mNumTransactions;
+	U32		mNumPolls;			// STATUS, FIFO_STATUS and OBSERVE_TX reads
+	U32		mNumPayloads;
+	U32		mPayloadBytes;
+
+	void GetText(nRFShortText& text) const;
+};
+
+// Groups the transactions into radio operations as the decoder makes them.
+// A transaction that doesn't fit the current operation starts a new one, and clearing
+// the interrupt an operation waits for ends it. Each radio on the bus has its own operations going,
+// their transactions can come in interleaved. Add and GetOperation can be called from different threads.
+class nRFOperationGrouper
+{
+public:
+	nRFOperationGrouper();
+
+	// returns the id of the operation the transaction went into
+	U64 Add(U8 radio, U8 command_byte, U8 status, U8 first_data, U32 data_length);
+
+	bool GetOperation(U64 operation_id, nRFOperation& op) const;
+	U64 GetNumOperations() const;
+
+protected:
+	bool Continues(const nRFOperation& op, U8 command_byte, U8 status) const;
+
+	static const U64 NONE_OPEN = 0xFFFFFFFFFFFFFFFFull;
+
+	std::vector<nRFOperation>	mOperations;
+	U64							mOpen[MAX_RADIOS];		// the operation of each radio that can take more transactions
+
+	mutable std::mutex			mLock;
+};
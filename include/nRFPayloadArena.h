@@ -0,0 +1,69 @@
+#pragma once
+
+#include <LogicPublicTypes.h>
+
+#include <vector>
+
+// Append-only storage for the payloads which don't fit into a Frame.
+// Payloads go into fixed size chunks and never straddle two of them,
+// so nothing is ever moved once it's written. When the chunks in RAM
+// go over the budget the oldest full chunks are written to a temp file
+// and memory-mapped back in. A decoder that's done with the oldest payloads
+// can release their chunks, see ReleaseBefore().
+class nRFPayloadArena
+{
+public:
+	enum { CHUNK_SIZE = 1 << 20 };
+
+	nRFPayloadArena();
+	~nRFPayloadArena();
+
+	// 0 means keep everything in RAM
+	void SetRamBudget(U64 bytes)			{ mRamBudget = bytes; }
+
+	// returns the offset of the stored payload
+	U64 Append(const U8* data, U32 length);
+
+	// where the next payload goes, or a bit before it
+	U64 GetEnd() const						{ return mChunks.empty() ? 0 : U64(mChunks.size() - 1) * CHUNK_SIZE + mUsed; }
+
+	// frees the chunks that are all before offset, but never the one being written
+	void ReleaseBefore(U64 offset);
+
+	// the payload at offset, valid until it's released or the arena is gone
+	const U8* Get(U64 offset) const
+	{
+		return mChunks[size_t(offset / CHUNK_SIZE)] + offset % CHUNK_SIZE;
+	}
+
+	U64 GetResidentBytes() const			{ return mNumResident * U64(CHUNK_SIZE); }
+	U64 GetSpilledBytes() const				{ return mNumSpilled * U64(CHUNK_SIZE); }
+
+protected:
+	void NewChunk();
+	void SpillChunks();
+	bool SpillChunk(size_t ndx, size_t slot);
+	void ReleaseChunk(size_t ndx);
+
+	U64					mRamBudget;
+
+	std::vector<U8*>	mChunks;		// RAM or the mapped view of a spilled chunk, NULL once released
+	std::vector<bool>	mSpilled;
+	U32					mUsed;			// bytes used in the last chunk
+
+	size_t				mNumReleased;	// the chunks before this one are gone
+	size_t				mNextToSpill;
+	size_t				mNumResident;
+	size_t				mNumSpilled;
+
+	// the spill file, in chunk sized slots that are reused once their chunks are released
+	std::vector<size_t>	mFileSlots;		// of each spilled chunk
+	std::vector<size_t>	mFreeSlots;
+	size_t				mNumFileSlots;
+#ifdef _WINDOWS
+	void*				mFile;
+#else
+	int					mFile;
+#endif
+	bool				mSpillFailed;
+};
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <LogicPublicTypes.h>
+
+#include <vector>
+#include <mutex>
+
+// An inverted index over the payloads: for every pair of bytes, the frames whose payload
+// has it. The frame indices are kept as varint deltas, so a list costs about a byte per
+// frame. Once the lists would go over the memory budget the index stops growing, and the
+// frames after that have to be searched the slow way.
+class nRFPayloadIndex
+{
+public:
+	enum
+	{
+		NUM_PAIRS			= 0x10000,
+		DEFAULT_MAX_BYTES	= 64 << 20,
+	};
+
+	nRFPayloadIndex(U64 max_bytes);
+
+	// the frames have to come in order
+	void Add(U64 frame_index, const U8* data, U32 length);
+
+	// The frames below indexed_end that have every byte pair of the pattern, in order.
+	// indexed_end is GetIndexedEnd() as it was for the lookup, the frames from there on
+	// have to be searched without the index. The payloads still have to be checked for the
+	// pattern itself. Returns false for patterns shorter than two bytes, those can't be looked up.
+	bool FindCandidates(const U8* pattern, U32 length, std::vector<U64>& frames, U64& indexed_end) const;
+
+	// every payload before this frame is in the index
+	U64 GetIndexedEnd() const;
+
+	U64 GetNumPayloads() const;
+	U64 GetMemoryBytes() const;
+
+protected:
+	struct Postings
+	{
+		std::vector<U8>		mDeltas;
+		U64					mLast;		// frame index of the last entry
+		U32					mCount;
+	};
+
+	bool Append(Postings& postings, U64 frame_index);
+	void Decode(const Postings& postings, std::vector<U64>& frames) const;
+
+	std::vector<Postings>	mPostings;
+
+	U64				mMaxBytes;
+	U64				mBytes;
+	U64				mNumPayloads;
+	U64				mIndexedEnd;
+	bool			mFull;
+
+	mutable std::mutex		mLock;
+};
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <LogicPublicTypes.h>
+
+#include <mutex>
+
+#include "nRFPayloadArena.h"
+
+// Keeps the long payloads, and tries not to keep the same payload twice.
+// A payload we've seen recently is interned and gets the ID of the first copy.
+// A payload which only differs in a few bytes from the previous payload on the same
+// stream (command byte + RX pipe) is stored as a delta against that one.
+// Everything else is stored as is. The payload ID is the record's offset in the arena.
+// Store and Get can be called from different threads.
+// A streaming decoder that writes the payloads out and forgets them calls SetMark() and
+// ReleaseBeforeMark(), and the store keeps only what the payloads since the mark still need.
+class nRFPayloadStore
+{
+public:
+	enum { MAX_PAYLOAD = 32 };
+
+	nRFPayloadStore();
+
+	void SetRamBudget(U64 bytes)			{ mArena.SetRamBudget(bytes); }
+
+	// returns the payload ID
+	U64 Store(const U8* data, U32 length, U32 stream);
+
+	// copies the payload into data, which has to hold MAX_PAYLOAD bytes, and returns the length
+	U32 Get(U64 id, U8* data) const;
+
+	// Only the payloads stored from now on will be asked for after the next ReleaseBeforeMark().
+	void SetMark();
+
+	// Frees what's only needed by the payloads stored before the mark. From then on
+	// new payloads are never interned or stored as deltas against the freed ones.
+	void ReleaseBeforeMark();
+
+	// the stream a payload belongs to
+	static U32 GetStream(U8 command_byte, U8 status)
+	{
+		return command_byte | (((status >> 1) & 7) << 8);
+	}
+
+	U64 GetNumPayloads() const				{ return mNumPayloads; }
+	U64 GetNumInterned() const				{ return mNumInterned; }
+	U64 GetNumDeltas() const				{ return mNumDeltas; }
+	U64 GetRawBytes() const					{ return mRawBytes; }
+	U64 GetStoredBytes() const				{ return mStoredBytes; }
+
+	double GetCompressionRatio() const
+	{
+		return mStoredBytes == 0 ? 1.0 : double(mRawBytes) / mStoredBytes;
+	}
+
+	const nRFPayloadArena& GetArena() const	{ return mArena; }
+
+protected:
+	enum
+	{
+		NUM_STREAMS		= 256 * 8,
+		INTERN_SLOTS	= 1 << 16,
+
+		// the longest chain of deltas we'll follow on Get
+		MAX_DELTA_DEPTH	= 8,
+	};
+
+	struct InternSlot
+	{
+		U64		mHash;
+		U64		mId;			// ID + 1, 0 is empty
+		U64		mOldest;		// the oldest record it's rebuilt from
+	};
+
+	struct LastPayload
+	{
+		U64		mId;
+		U64		mOldest;
+		U8		mLength;		// 0 if there is none
+		U8		mDepth;
+		U8		mData[MAX_PAYLOAD];
+	};
+
+	U32 Rebuild(U64 id, U8* data) const;
+
+	const InternSlot* Intern(const U8* data, U32 length, U64 hash);
+	U64 StoreDelta(const U8* data, U32 length, const LastPayload& base);
+	U64 StoreFull(const U8* data, U32 length);
+
+	nRFPayloadArena		mArena;
+	mutable std::mutex	mLock;
+
+	InternSlot			mIntern[INTERN_SLOTS];
+	LastPayload			mLast[NUM_STREAMS];
+
+	// the records before mFloor may be gone
+	U64					mFloor;
+	U64					mOldestSinceMark;
+
+	U64					mNumPayloads;
+	U64					mNumInterned;
+	U64					mNumDeltas;
+	U64					mRawBytes;
+	U64					mStoredBytes;
+};
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <LogicPublicTypes.h>
+
+#include <vector>
+#include <mutex>
+
+#include "nRFTables.h"
+
+// The radio's registers, as far as we've seen them written or read.
+struct nRFRegisterFile
+{
+	enum { MAX_WIDTH = 5 };		// the address registers
+
+	U8		mValues[NUM_REGISTERS][MAX_WIDTH];
+	U32		mKnown;				// a bit per register
+
+	nRFRegisterFile()
+	{
+		Clear();
+	}
+
+	void Clear();
+
+	bool IsKnown(U8 reg) const		{ return (mKnown & (1u << reg)) != 0; }
+	U8 Get(U8 reg) const			{ return mValues[reg][0]; }
+
+	// sets the first length bytes of a register, returns true if anything changed
+	bool Set(U8 reg, const U8* data, U32 length);
+
+	// from SETUP_AW, 5 bytes if we don't know
+	U32 GetAddressWidth() const;
+
+	// The address of RX_ADDR_Px or TX_ADDR, LSB first. P2 to P5 only have
+	// their LSB and share the rest with P1. Returns false if we don't know it.
+	bool GetAddress(U8 reg, U8* addr, U32& width) const;
+
+	// the register a transaction sets, false if it doesn't set any
+	static bool GetTarget(U8 command_byte, U32 data_length, U8& reg);
+};
+
+// Keeps the register file up to date while decoding, and can tell what it was at any frame.
+// Every change goes into a log, and every CHECKPOINT_INTERVAL changes the whole register file
+// is saved, so the state at a frame is the nearest checkpoint before it plus at most
+// CHECKPOINT_INTERVAL changes. Update and GetState can be called from different threads.
+class nRFRegisterShadow
+{
+public:
+	enum { CHECKPOINT_INTERVAL = 64 };
+
+	nRFRegisterShadow();
+
+	// call for every transaction, in order; data is what was written or read
+	void Update(U64 frame_index, U8 command_byte, const U8* data, U32 length);
+
+	// the registers after the transaction at frame_index
+	void GetState(U64 frame_index, nRFRegisterFile& regs) const;
+
+	U64 GetNumChanges() const;
+	U64 GetNumCheckpoints() const;
+
+protected:
+	struct Change
+	{
+		U64		mFrameIndex;
+		U8		mRegister;
+		U8		mLength;
+		U8		mData[nRFRegisterFile::MAX_WIDTH];
+	};
+
+	struct Checkpoint
+	{
+		U64					mFrameIndex;	// of the last change in it
+		size_t				mNextChange;
+		nRFRegisterFile		mRegisters;
+	};
+
+	nRFRegisterFile				mCurrent;
+	std::vector<Change>			mChanges;
+	std::vector<Checkpoint>		mCheckpoints;
+
+	mutable std::mutex			mLock;
+};
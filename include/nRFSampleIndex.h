@@ -0,0 +1,82 @@
+#pragma once
+
+#include <LogicPublicTypes.h>
+
+#include <vector>
+#include <mutex>
+
+// The start and end samples of the transactions and their command frames, for seeking by time
+// without going through GetFrame. The transactions are kept in blocks of BLOCK_SIZE as varint
+// deltas, about 3 bytes each, and the start samples of the blocks make a small sorted top
+// level that's binary searched.
+class nRFSampleIndex
+{
+public:
+	enum { BLOCK_SIZE = 16 };
+
+	struct Entry
+	{
+		U64		mFrameIndex;		// of the command frame
+		U64		mStartSample;
+		U64		mEndSample;
+	};
+
+	// Walks the transactions in order, from the first one that starts at or after a sample.
+	// Doesn't allocate, and can be used while transactions are being added.
+	class Cursor
+	{
+	public:
+		Cursor(const nRFSampleIndex& index, U64 from_sample);
+
+		bool Next(Entry& entry);
+
+		// the transaction Next returns next
+		U64 GetPosition() const		{ return mPosition; }
+
+	protected:
+		const nRFSampleIndex&	mIndex;
+		U64						mPosition;
+		size_t					mOffset;		// into mIndex.mDeltas
+		Entry					mPrevious;
+	};
+
+	nRFSampleIndex();
+
+	// the transactions have to come in order
+	void Add(U64 frame_index, U64 start_sample, U64 end_sample);
+
+	// the transaction the sample is in, false if it's between transactions
+	bool FindCovering(U64 sample, Entry& entry) const;
+
+	// the number of transactions that start before the sample
+	U64 LowerBound(U64 sample) const;
+
+	// the number of transactions that start in [from_sample, to_sample]
+	U64 CountInRange(U64 from_sample, U64 to_sample) const;
+
+	U64 GetCount() const;
+	U64 GetMemoryBytes() const;
+
+protected:
+	struct Block
+	{
+		U64		mFrameIndex;
+		size_t	mOffset;
+	};
+
+	U64 LowerBoundLocked(U64 sample) const;
+
+	// decodes the entry at offset, moving offset past it
+	void Decode(size_t& offset, const Entry& previous, Entry& entry) const;
+
+	// the start of the block the position is in, ready for Decode
+	void Seek(U64 position, size_t& offset, Entry& previous) const;
+
+	std::vector<U64>		mBlockStarts;		// start sample of each block's first transaction
+	std::vector<Block>		mBlocks;
+	std::vector<U8>			mDeltas;
+	Entry					mLast;
+	U64						mCount;
+
+	mutable std::mutex		mLock;
+};
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <LogicPublicTypes.h>
+
+#include <vector>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "nRFTypes.h"
+#include "nRFSpiDecoder.h"
+
+// One channel of a capture that's all in memory: its state at sample 0 and all of its transitions.
+struct nRFChannelEdges
+{
+	BitState			mInitialState;
+	std::vector<U64>	mEdges;
+
+	nRFChannelEdges()
+	:	mInitialState(BIT_LOW)
+	{}
+};
+
+// The channels of the bus, for decoding a capture offline. The ones that aren't
+// connected in the settings are never looked at.
+struct nRFBusEdges
+{
+	nRFChannelEdges		mMosi;
+	nRFChannelEdges		mMiso;
+	nRFChannelEdges		mSck;
+	nRFChannelEdges		mCsns[MAX_RADIOS];
+};
+
+// Decodes a capture that's all in memory in two passes.
+// The first one only looks at CSN to find the windows, in the order the streaming decoder
+// would decode them. The second one decodes the bytes of the windows in segments on a pool
+// of worker threads, and hands them back in order on the calling thread, so the frames made
+// from them are the same as the streaming decoder's.
+class nRFSegmentDecoder
+{
+public:
+	enum
+	{
+		SEGMENT_WINDOWS	= 256,
+		MAX_WORKERS		= 64,
+	};
+
+	// a CSN window found by the first pass
+	struct Window
+	{
+		U64		mStart;		// the falling edge of CSN
+		U64		mEnd;		// the rising edge
+		U8		mRadio;
+	};
+
+	// called for every window in order, on the thread that called Decode()
+	typedef std::function<void (const Window& window, const SpiTransactionBuffer& spi_bytes)>	WindowDoneFn;
+
+	nRFSegmentDecoder(nRFSpiMode_e mode, bool mark_bits);
+
+	// the first pass, over the CSNs of num_radios radios sharing the bus
+	void FindWindows(const nRFChannelEdges* csns, U32 num_radios);
+
+	// The second pass. miso is NULL if it isn't connected.
+	// With num_threads 0 there's one thread per core; with 1 everything is done on the calling thread.
+	void Decode(const nRFChannelEdges& sck, const nRFChannelEdges& mosi, const nRFChannelEdges* miso,
+				U32 num_threads, const WindowDoneFn& window_done);
+
+	size_t GetNumWindows() const		{ return mWindows.size(); }
+	U32 GetNumWorkers() const			{ return mNumWorkers; }
+
+	// Samples a channel from its edges, starting anywhere in the capture.
+	class EdgeSampler
+	{
+	public:
+		EdgeSampler(const nRFChannelEdges& channel, U64 from_sample);
+
+		BitState At(U64 sample)
+		{
+			while (mNext != mEnd  &&  *mNext <= sample)
+			{
+				mState = Toggle(mState);
+				++mNext;
+			}
+
+			return mState;
+		}
+
+	protected:
+		const U64*	mNext;
+		const U64*	mEnd;
+		BitState	mState;
+	};
+
+protected:
+	// the windows [mFirst, mFirst + mNumWindows) and their bytes
+	struct Segment
+	{
+		size_t		mFirst;
+		size_t		mNumWindows;
+		bool		mDecoded;
+
+		SpiTransactionBuffer	mBytes[SEGMENT_WINDOWS];
+	};
+
+	typedef void (*DecodeWindowFn)(const SpiSckEdges& sck, EdgeSampler& mosi, EdgeSampler& miso, SpiTransactionBuffer& spi_bytes);
+
+	template <nRFSpiMode_e MODE>
+	static DecodeWindowFn SelectDecoder(bool mark_bits);
+
+	void WorkerThread();
+	void DecodeSegment(Segment& segment, SpiSckEdges& sck_edges);
+
+	DecodeWindowFn			mDecodeWindow;
+
+	std::vector<Window>		mWindows;
+
+	const nRFChannelEdges*	mSck;
+	const nRFChannelEdges*	mMosi;
+	const nRFChannelEdges*	mMiso;
+	U32						mNumWorkers;
+
+	// the segments waiting for a worker
+	std::mutex					mLock;
+	std::condition_variable		mWorkReady;
+	std::condition_variable		mSegmentDecoded;
+	std::deque<Segment*>		mQueue;
+	bool						mStopping;
+};
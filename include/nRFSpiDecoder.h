@@ -0,0 +1,188 @@
+#pragma once
+
+#include <LogicPublicTypes.h>
+#include <AnalyzerChannelData.h>
+
+#include "nRFTypes.h"
+
+// The SCK edges of one CSN window, collected in one go
+// so the data channels don't have to be stepped in lockstep with the clock.
+struct SpiSckEdges
+{
+	// enough for 34 bytes, which is one more than the longest valid command
+	enum { MAX_EDGES = 34 * 16 + 2 };
+
+	U64			mStart;			// where the window starts
+	BitState	mInitialState;	// SCK state at mStart
+	U32			mNumEdges;
+	bool		mOverflow;		// the window had more edges than fit into mEdges
+
+	U64			mEdges[MAX_EDGES];
+};
+
+// Samples a channel at increasing sample numbers.
+// Walks the channel's own transitions instead of advancing it to every sample.
+class ChannelSampler
+{
+public:
+	void Begin(AnalyzerChannelData* channel)
+	{
+		mChannel = channel;
+		mState = channel->GetBitState();
+		NextEdge();
+	}
+
+	BitState At(U64 sample)
+	{
+		while (mNextEdge <= sample)
+		{
+			mChannel->AdvanceToNextEdge();
+			mState = Toggle(mState);
+			NextEdge();
+		}
+
+		return mState;
+	}
+
+protected:
+	void NextEdge()
+	{
+		// everything up to the end of the CSN window is already in the current data
+		mNextEdge = mChannel->DoMoreTransitionsExistInCurrentData() ? mChannel->GetSampleOfNextEdge() : 0xFFFFFFFFFFFFFFFFull;
+	}
+
+	AnalyzerChannelData*	mChannel;
+	BitState				mState;
+	U64						mNextEdge;
+};
+
+// A channel that isn't connected, it reads as all zeros.
+struct UnconnectedSampler
+{
+	BitState At(U64)		{ return BIT_LOW; }
+};
+
+// Decodes the bytes of one CSN window from its SCK edges.
+// Samples MOSI and MISO like nRF24L01_Analyzer::GetByte does in the same mode,
+// so both produce identical bytes. The samplers need a BitState At(U64 sample) method
+// which is called with non-decreasing sample numbers.
+// Without MARK_BITS only the first bit's sample is kept, which is all the frames need.
+template <bool MARK_BITS, typename MosiSampler, typename MisoSampler>
+void DecodeSpiBytesAuto(const SpiSckEdges& sck, MosiSampler& mosi, MisoSampler& miso, SpiTransactionBuffer& spi_bytes);
+
+template <nRFSpiMode_e MODE, bool MARK_BITS, typename MosiSampler, typename MisoSampler>
+void DecodeSpiBytesFixed(const SpiSckEdges& sck, MosiSampler& mosi, MisoSampler& miso, SpiTransactionBuffer& spi_bytes);
+
+template <nRFSpiMode_e MODE, bool MARK_BITS, typename MosiSampler, typename MisoSampler>
+void DecodeSpiBytes(const SpiSckEdges& sck, MosiSampler& mosi, MisoSampler& miso, SpiTransactionBuffer& spi_bytes)
+{
+	if (MODE == SPI_MODE_AUTO)
+		DecodeSpiBytesAuto<MARK_BITS>(sck, mosi, miso, spi_bytes);
+	else
+		DecodeSpiBytesFixed<MODE, MARK_BITS>(sck, mosi, miso, spi_bytes);
+}
+
+// the phase heuristics of SPI_MODE_AUTO
+template <bool MARK_BITS, typename MosiSampler, typename MisoSampler>
+void DecodeSpiBytesAuto(const SpiSckEdges& sck, MosiSampler& mosi, MisoSampler& miso, SpiTransactionBuffer& spi_bytes)
+{
+	U32 next_edge = 0;
+	U64 position = sck.mStart;
+	BitState sck_state = sck.mInitialState;
+	bool is_first_byte_of_command = true;
+
+#define TAKE_SCK_EDGE()							\
+	if (next_edge == sck.mNumEdges)				\
+		return;									\
+	position = sck.mEdges[next_edge++];			\
+	sck_state = Toggle(sck_state)
+
+	for (;;)
+	{
+		SpiByte& b = spi_bytes.Next();
+		b.Clear();
+
+		bool sample_first_bit_on_falling_edge = false;
+		if (sck_state == BIT_LOW)
+		{
+			TAKE_SCK_EDGE();
+		} else if (is_first_byte_of_command) {
+			sample_first_bit_on_falling_edge = true;
+		}
+
+		for (U8 num_bits = 0;;)
+		{
+			if (sample_first_bit_on_falling_edge)
+			{
+				TAKE_SCK_EDGE();
+			}
+
+			if (sample_first_bit_on_falling_edge)
+				b.mFlags |= FIRST_BIT_ON_FALLING_EDGE;
+
+			if (MARK_BITS  ||  num_bits == 0)
+				b.SetBitSample(num_bits, position);
+
+			b.mValMiso = (b.mValMiso << 1) | (miso.At(position) == BIT_HIGH ? 1 : 0);
+			b.mValMosi = (b.mValMosi << 1) | (mosi.At(position) == BIT_HIGH ? 1 : 0);
+
+			num_bits++;
+
+			if (!sample_first_bit_on_falling_edge)
+			{
+				TAKE_SCK_EDGE();
+			}
+
+			if (num_bits == 8)
+				break;
+
+			TAKE_SCK_EDGE();
+
+			sample_first_bit_on_falling_edge = false;
+		}
+
+		b.mEndingSample = position;
+		spi_bytes.AppendNext();
+
+		is_first_byte_of_command = false;
+	}
+
+#undef TAKE_SCK_EDGE
+}
+
+// With a fixed mode every other edge is a sampling edge, so the bytes are just 16 edges apart.
+template <nRFSpiMode_e MODE, bool MARK_BITS, typename MosiSampler, typename MisoSampler>
+void DecodeSpiBytesFixed(const SpiSckEdges& sck, MosiSampler& mosi, MisoSampler& miso, SpiTransactionBuffer& spi_bytes)
+{
+	const BitState sample_state = SpiSamplesOnRisingEdge(MODE) ? BIT_HIGH : BIT_LOW;
+
+	// with CPHA=0 the byte ends on the edge after the last sample
+	const U32 trailing_edges = SpiSamplesOnLeadingEdge(MODE) ? 1 : 0;
+
+	// the first edge that goes into the sampling state
+	U32 next_edge = sck.mInitialState == sample_state ? 1 : 0;
+
+	while (next_edge + 14 + trailing_edges < sck.mNumEdges)
+	{
+		SpiByte& b = spi_bytes.Next();
+		b.Clear();
+
+		if (!SpiSamplesOnRisingEdge(MODE))
+			b.mFlags = SAMPLED_ON_FALLING_EDGE;
+
+		for (int bit = 0; bit < 8; ++bit)
+		{
+			U64 position = sck.mEdges[next_edge];
+			next_edge += 2;
+
+			if (MARK_BITS  ||  bit == 0)
+				b.SetBitSample(bit, position);
+
+			b.mValMiso = (b.mValMiso << 1) | (miso.At(position) == BIT_HIGH ? 1 : 0);
+			b.mValMosi = (b.mValMosi << 1) | (mosi.At(position) == BIT_HIGH ? 1 : 0);
+		}
+
+		b.mEndingSample = sck.mEdges[next_edge - 2 + trailing_edges];
+		spi_bytes.AppendNext();
+	}
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <LogicPublicTypes.h>
+
+#include <ostream>
+#include <vector>
+#include <mutex>
+
+#include "nRFTypes.h"
+#include "nRFTables.h"
+
+enum nRFEvent_e
+{
+	EVENT_TX_DS,
+	EVENT_MAX_RT,
+	EVENT_RX_DR,
+
+	NUM_EVENTS
+};
+
+// Counters over the whole capture and per time window, updated as the transactions are decoded.
+// Every update is O(1), so they're ready as soon as the decoder is done.
+class nRFStatistics
+{
+public:
+	// the windows are window_samples long, starting at sample 0
+	nRFStatistics(U64 window_samples);
+
+	void Update(U64 starting_sample, U64 ending_sample, U8 radio, U8 command_byte, U8 status, U8 first_data, U32 data_length);
+
+	// a CSN window too long for any command, which the decoder skipped
+	void AddOversizeBurst(U64 starting_sample, U64 ending_sample);
+
+	// the statistics as a few ';' separated tables
+	void Write(std::ostream& out, U64 trigger_sample, U32 sample_rate) const;
+
+	U64 GetNumTransactions() const;
+	U64 GetCommandCount(U8 cmd) const;
+	U64 GetEventCount(U8 event) const;
+	U64 GetNumWindows() const;
+	U64 GetNumOversizeBursts() const;
+	U64 GetOversizeSamples() const;
+
+protected:
+	struct Window
+	{
+		U32		mTransactions;
+		U32		mTxBytes;
+		U32		mRxBytes;
+		U32		mEvents[NUM_EVENTS];
+	};
+
+	U64			mWindowSamples;
+	U64			mFirstSample;
+	U64			mLastSample;
+	U8			mLastStatus[MAX_RADIOS];
+
+	U64			mTransactions;
+	U64			mCommands[undefined_cmd + 1];
+	U64			mRegisterReads[NUM_REGISTERS];
+	U64			mRegisterWrites[NUM_REGISTERS];
+	U64			mTxPayloads;
+	U64			mTxBytes;
+	U64			mRxPayloads;
+	U64			mRxBytes;
+	U64			mEvents[NUM_EVENTS];		// STATUS bits going from 0 to 1
+	U64			mPacketsLost[16];			// OBSERVE_TX PLOS_CNT
+	U64			mRetransmits[16];			// OBSERVE_TX ARC_CNT
+	U64			mRxPipes[8];				// STATUS RX_P_NO when a payload is read
+	U64			mOversizeBursts;
+	U64			mOversizeSamples;
+
+	std::vector<Window>		mWindows;
+
+	mutable std::mutex		mLock;
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <LogicPublicTypes.h>
+
+#include "nRFTypes.h"
+
+// Lookup tables for decoding commands and showing register values.
+// All of them are generated at compile time in nRFTables.cpp.
+
+enum nRFCommandFlags
+{
+	CMD_IS_REGISTER		= 1,		// R_REGISTER, W_REGISTER
+	CMD_IS_READ			= 2,		// the data is on MISO
+	CMD_HAS_DATA		= 4,
+	CMD_HAS_PAYLOAD		= 8,		// TX/RX/ACK payloads
+};
+
+struct nRFCommandInfo
+{
+	U8		mCommand;		// nRFCommand_e
+	U8		mRegister;		// nRFRegister_e, undefined_reg if not a register command
+	U8		mFlags;			// nRFCommandFlags
+};
+
+struct nRFCommandTable
+{
+	nRFCommandInfo		mInfo[256];
+};
+
+enum
+{
+	NUM_REGISTERS			= 32,
+
+	// the registers which have a text for their value, plus a row for those which don't
+	NUM_TEXT_REGISTERS		= 20,
+
+	REGISTER_TEXT_SIZE		= 72,
+};
+
+struct nRFRegisterTextTable
+{
+	U8		mRow[NUM_REGISTERS];
+	char	mTexts[NUM_TEXT_REGISTERS][256][REGISTER_TEXT_SIZE];
+};
+
+extern const nRFCommandTable		COMMAND_TABLE;
+extern const nRFRegisterTextTable	REGISTER_TEXTS;
+
+// indexed by nRFCommand_e, including undefined_cmd
+extern const char* const			COMMAND_NAMES[];
+
+// indexed by the register address
+extern const char* const			REGISTER_NAMES[NUM_REGISTERS];
+
+inline const nRFCommandInfo& GetCommandInfo(U8 cmd_byte)
+{
+	return COMMAND_TABLE.mInfo[cmd_byte];
+}
+
+// the text for a register value, like "EN_CRC, PWR_UP" for CONFIG
+inline const char* GetRegisterText(U8 reg, U8 value)
+{
+	return REGISTER_TEXTS.mTexts[REGISTER_TEXTS.mRow[reg & reg_mask]][value];
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <LogicPublicTypes.h>
+#include <AnalyzerHelpers.h>
+
+#include <cstring>
+
+// A string in a fixed size buffer, for building the bubble and export texts
+// without going to the heap. Whatever doesn't fit is cut off.
+template <size_t CAPACITY>
+class nRFFixedString
+{
+public:
+	nRFFixedString()
+	{
+		clear();
+	}
+
+	void clear()
+	{
+		mLength = 0;
+		mText[0] = '\0';
+	}
+
+	bool empty() const				{ return mLength == 0; }
+	size_t size() const				{ return mLength; }
+	const char* c_str() const		{ return mText; }
+
+	nRFFixedString& Append(const char* str, size_t max_len = size_t(-1))
+	{
+		while (*str != '\0'  &&  max_len-- > 0  &&  mLength < CAPACITY - 1)
+			mText[mLength++] = *str++;
+
+		mText[mLength] = '\0';
+		return *this;
+	}
+
+	nRFFixedString& AppendNumber(U64 number, DisplayBase display_base, U32 num_bits = 8)
+	{
+		AnalyzerHelpers::GetNumberString(number, display_base, num_bits, mText + mLength, U32(CAPACITY - mLength));
+		mLength += ::strlen(mText + mLength);
+		return *this;
+	}
+
+	nRFFixedString& AppendDecimal(U64 number)
+	{
+		return AppendNumber(number, Decimal, 64);
+	}
+
+	// the bytes as one number in hex and binary, space separated otherwise
+	nRFFixedString& AppendBytes(const U8* data, size_t length, DisplayBase display_base)
+	{
+		char buff[32];
+		for (size_t cnt = 0; cnt < length; ++cnt)
+		{
+			AnalyzerHelpers::GetNumberString(data[cnt], display_base, 8, buff, sizeof(buff));
+			if (cnt == 0)
+			{
+				Append(buff);
+			} else if (display_base == Hexadecimal  ||  display_base == Binary) {
+				Append(buff + 2);
+			} else {		// Decimal, AsciiHex, ASCII
+				Append(" ").Append(buff);
+			}
+		}
+
+		return *this;
+	}
+
+	// appends with a ", " in front unless the string is empty
+	nRFFixedString& AddPart(const char* part)
+	{
+		if (mLength > 0)
+			Append(", ");
+
+		return Append(part);
+	}
+
+protected:
+	size_t		mLength;
+	char		mText[CAPACITY];
+};
+
+// numbers, register bits and the like
+typedef nRFFixedString<128>		nRFShortText;
+
+// The texts of one bubble in the order they were pushed, the full form first.
+// The others aren't sorted by length, see longest().
+class nRFTextList
+{
+public:
+	enum
+	{
+		MAX_TEXTS	= 6,
+
+		// 32 bytes shown as ASCII/hex plus the length
+		TEXT_SIZE	= 400,
+	};
+
+	typedef nRFFixedString<TEXT_SIZE>	Text;
+
+	nRFTextList()
+	:	mNumTexts(0)
+	{}
+
+	void clear()						{ mNumTexts = 0; }
+	bool empty() const					{ return mNumTexts == 0; }
+	size_t size() const					{ return mNumTexts; }
+
+	const Text& operator[] (size_t ndx) const	{ return mTexts[ndx]; }
+	const Text& front() const			{ return mTexts[0]; }
+	const Text& back() const			{ return mTexts[mNumTexts - 1]; }
+
+	// starts a new, empty text
+	Text& push_back()
+	{
+		Text& text = mTexts[mNumTexts < MAX_TEXTS ? mNumTexts++ : MAX_TEXTS - 1];
+		text.clear();
+		return text;
+	}
+
+	const Text& longest() const
+	{
+		size_t ndx = 0;
+		for (size_t c = 1; c < mNumTexts; ++c)
+		{
+			if (mTexts[c].size() > mTexts[ndx].size())
+				ndx = c;
+		}
+
+		return mTexts[ndx];
+	}
+
+protected:
+	size_t		mNumTexts;
+	Text		mTexts[MAX_TEXTS];
+};
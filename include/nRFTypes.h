@@ -7,35 +7,147 @@
 #include <vector>
 #include <cstring>
 
+#include "nRFPayloadStore.h"
+#include "nRFText.h"
+
 enum nRFFrameFlags
 {
 	IS_COMMAND			= (1 << 0),
 	IS_EXTENDED			= (1 << 1),
 	IS_DATA_ON_MISO		= (1 << 2),
 	HAS_DATA_FRAME		= (1 << 3),
+	IS_OVERSIZE_BURST	= (1 << 4),		// a CSN window too long for a command, mData1 has the number of samples skipped
 };
 
+// The radios sharing the SPI bus, each with its own CSN. The command and oversize burst
+// frames have the index of theirs in mType, the data frames have the length there.
+enum { MAX_RADIOS = 4 };
+
+enum SpiByteFlags
+{
+	FIRST_BIT_ON_FALLING_EDGE	= (1 << 0),
+	SAMPLED_ON_FALLING_EDGE		= (1 << 1),		// all the bits
+};
+
+// how the SPI bits are clocked
+enum nRFSpiMode_e
+{
+	SPI_MODE_AUTO,		// the rising edges, but the first bit on a falling one when SCK starts out high
+	SPI_MODE_0,			// CPOL=0 CPHA=0, what the nRF24L01 wants
+	SPI_MODE_1,			// CPOL=0 CPHA=1
+	SPI_MODE_2,			// CPOL=1 CPHA=0
+	SPI_MODE_3,			// CPOL=1 CPHA=1
+};
+
+// CPOL is the SCK idle state, CPHA=0 samples on the leading edge and CPHA=1 on the trailing one
+constexpr bool SpiIdlesHigh(nRFSpiMode_e mode)
+{
+	return mode == SPI_MODE_2  ||  mode == SPI_MODE_3;
+}
+
+constexpr bool SpiSamplesOnLeadingEdge(nRFSpiMode_e mode)
+{
+	return mode != SPI_MODE_1  &&  mode != SPI_MODE_3;
+}
+
+constexpr bool SpiSamplesOnRisingEdge(nRFSpiMode_e mode)
+{
+	return SpiIdlesHigh(mode) != SpiSamplesOnLeadingEdge(mode);
+}
+
+// One decoded SPI byte. Kept small, the decoder writes one of these per byte.
+// The markers are derived from the bit samples and the values when needed.
 struct SpiByte
 {
+	U64		mStartingSample;	// where the first bit was sampled
+	U64		mEndingSample;
+	U32		mBitDeltas[7];		// where bits 1..7 were sampled, relative to mStartingSample
 	U8		mValMiso;
 	U8		mValMosi;
-	U64		mStartingSample;
-	U64		mEndingSample;
-
-	// the markers for this command
-	U64								mMarkers[8];
-	AnalyzerResults::MarkerType		mMarkerSCK[8];
-	AnalyzerResults::MarkerType		mMarkerMOSI[8];
-	AnalyzerResults::MarkerType		mMarkerMISO[8];
+	U8		mFlags;
 
 	void Clear()
 	{
-		//mValMiso = mValMosi = 0;
-		//mStartingSample = mEndingSample = 0;
-		memset(this, 0, sizeof(*this));
+		mValMiso = mValMosi = mFlags = 0;
+	}
+
+	void SetBitSample(int bit, U64 sample)
+	{
+		if (bit == 0)
+		{
+			mStartingSample = sample;
+		} else {
+			// saturate on very slow clocks; only the marker positions would be off
+			U64 delta = sample - mStartingSample;
+			mBitDeltas[bit - 1] = delta > 0xFFFFFFFF ? 0xFFFFFFFF : U32(delta);
+		}
+	}
+
+	U64 GetBitSample(int bit) const
+	{
+		return bit == 0 ? mStartingSample : mStartingSample + mBitDeltas[bit - 1];
+	}
+
+	AnalyzerResults::MarkerType GetMarkerSCK(int bit) const
+	{
+		return (bit == 0  &&  (mFlags & FIRST_BIT_ON_FALLING_EDGE))  ||  (mFlags & SAMPLED_ON_FALLING_EDGE)
+					? AnalyzerResults::DownArrow : AnalyzerResults::UpArrow;
+	}
+
+	AnalyzerResults::MarkerType GetMarkerMOSI(int bit) const
+	{
+		return (mValMosi >> (7 - bit)) & 1 ? AnalyzerResults::One : AnalyzerResults::Zero;
+	}
+
+	AnalyzerResults::MarkerType GetMarkerMISO(int bit) const
+	{
+		return (mValMiso >> (7 - bit)) & 1 ? AnalyzerResults::One : AnalyzerResults::Zero;
 	}
 };
 
+// The bytes of one CSN window. Fixed capacity so the decoder never allocates.
+class SpiTransactionBuffer
+{
+public:
+	// one more than the longest valid command so overlong ones can be told apart
+	enum { MAX_BYTES = 34 };
+
+	SpiTransactionBuffer()
+	:	mSize(0),
+		mOversize(false)
+	{}
+
+	void clear()					{ mSize = 0; mOversize = false; }
+	bool empty() const				{ return mSize == 0; }
+	size_t size() const				{ return mSize; }
+
+	const SpiByte& operator[](size_t ndx) const		{ return mBytes[ndx]; }
+	const SpiByte& front() const	{ return mBytes[0]; }
+	const SpiByte& back() const		{ return mBytes[mSize - 1]; }
+
+	const SpiByte* begin() const	{ return mBytes; }
+	const SpiByte* end() const		{ return mBytes + mSize; }
+
+	// the decoder writes the next byte in place, then calls AppendNext() once it's complete
+	SpiByte& Next()					{ return mSize < MAX_BYTES ? mBytes[mSize] : mOverflow; }
+	void AppendNext()
+	{
+		if (mSize < MAX_BYTES)
+			++mSize;
+	}
+
+	// Longer than any valid command. The decoders stop sampling as soon as they see that,
+	// so the bytes are only the start of the window, if there are any at all.
+	bool IsOversize() const			{ return mOversize  ||  mSize == MAX_BYTES; }
+	void SetOversize()				{ mOversize = true; }
+
+protected:
+	size_t		mSize;
+	bool		mOversize;
+	SpiByte		mBytes[MAX_BYTES];
+	SpiByte		mOverflow;		// bytes past MAX_BYTES are decoded into this and dropped
+};
+
 enum nRFCommand_e
 {
 	R_REGISTER,
@@ -89,6 +201,27 @@ enum nRFRegister_e
 	undefined_reg = 0xff,
 };
 
+// the interrupt bits of STATUS, and TX_FULL
+enum nRFStatusFlags_e
+{
+	STATUS_RX_DR	= 0x40,
+	STATUS_TX_DS	= 0x20,
+	STATUS_MAX_RT	= 0x10,
+	STATUS_TX_FULL	= 0x01,
+
+	STATUS_IRQ_MASK	= 0x70,
+};
+
+// the bits of FIFO_STATUS
+enum nRFFifoStatusFlags_e
+{
+	FIFO_TX_REUSE	= 0x40,
+	FIFO_TX_FULL	= 0x20,
+	FIFO_TX_EMPTY	= 0x10,
+	FIFO_RX_FULL	= 0x02,
+	FIFO_RX_EMPTY	= 0x01,
+};
+
 struct nRFCommandDesc
 {
 	std::vector<std::string>		texts;
@@ -102,6 +235,7 @@ struct nRFCommand
 	U8				mData[32];
 	U8				mDataLength;
 	U8				mStatus;
+	U8				mRadio;
 
 	nRFCommand_e	mCommand;
 	nRFRegister_e	mRegister;
@@ -113,14 +247,14 @@ struct nRFCommand
 
 	void Clear()
 	{
-		mCommandByte = mDataLength = mStatus = 0;
+		mCommandByte = mDataLength = mStatus = mRadio = 0;
 		::memset(mData, 0, sizeof(mData));
 
 		mCommand = undefined_cmd;
 		mRegister = undefined_reg;
 	}
 
-	void Decode(const Frame* frmCmd, const Frame* frmData, const std::vector<U8>& extendedData);
+	void Decode(const Frame* frmCmd, const Frame* frmData, const nRFPayloadStore& extendedData);
 
 	bool IsRegister() const
 	{
@@ -150,14 +284,14 @@ struct nRFCommand
 		return !(mCommand == FLUSH_TX  ||  mCommand == FLUSH_RX  ||  mCommand == REUSE_TX_PL  ||  mCommand == NOP);
 	}
 
-	void GetCommandText(const bool is_mosi, std::vector<std::string>& texts, DisplayBase display_base);
-	void GetDataText(const bool is_mosi, std::vector<std::string>& texts, DisplayBase display_base);
-	std::string GetRegisterString();
+	// the bubble texts, the full form first
+	void GetCommandText(const bool is_mosi, nRFTextList& texts, DisplayBase display_base) const;
+	void GetDataText(const bool is_mosi, nRFTextList& texts, DisplayBase display_base) const;
+	void GetRegisterString(nRFShortText& text) const;
 
 	// helpers
 	static const char* GetCommandName(const nRFCommand_e cmd);
 	static const char* GetRegisterName(U64 cmd_byte);
 	static nRFCommand_e GetCommandFromByte(U64 cmd_byte);
-	static std::string GetStatusBits(U8 stat);
-	static std::string GetHighBits(U8 bits, nRFRegister_e reg);
+	static void GetStatusBits(U8 stat, nRFShortText& text);
 };
@@ -8,7 +8,10 @@
 
 
 nRF24L01_Analyzer::nRF24L01_Analyzer()
-:	mSimulationInitilized(false)
+:	mNumRadios(1),
+	mSimulationInitilized(false),
+	mStreaming(false),
+	mGetBytes(NULL)
 {
 	SetAnalyzerSettings(&mSettings);
 }
@@ -18,25 +21,51 @@ nRF24L01_Analyzer::~nRF24L01_Analyzer()
 	KillThread();
 }
 
-void nRF24L01_Analyzer::SyncToChannel(AnalyzerChannelData* channel)
-{
-	SyncToSample(channel->GetSampleNumber());
-}
-
+template <U32 CH>
 void nRF24L01_Analyzer::SyncToSample(U64 to_sample)
 {
-	mCsn->AdvanceToAbsPosition(to_sample);
-	mMiso->AdvanceToAbsPosition(to_sample);
+	// the channels that aren't connected are never touched
+	if (CH & CH_CSN)
+		mCsn->AdvanceToAbsPosition(to_sample);
+	if (CH & CH_MISO)
+		mMiso->AdvanceToAbsPosition(to_sample);
 	mMosi->AdvanceToAbsPosition(to_sample);
 	mSck->AdvanceToAbsPosition(to_sample);
 }
 
+template <U32 CH>
+bool nRF24L01_Analyzer::IsSckEdgeInWindow(U64 csn_edge)
+{
+	// Without CSN the transaction is over once SCK has been idle for the gap. That has to wait
+	// for the data of the whole gap, while the capture is running the current data could end in it.
+	if ((CH & CH_CSN) == 0)
+		return mSck->WouldAdvancingToAbsPositionCauseTransition(mSck->GetSampleNumber() + mSckIdleGap);
+
+	return mSck->DoMoreTransitionsExistInCurrentData()  &&  mSck->GetSampleOfNextEdge() <= csn_edge;
+}
+
+template <U32 CH>
+void nRF24L01_Analyzer::EndWindow(U64 csn_edge)
+{
+	if ((CH & CH_CSN) == 0)
+	{
+		// skip whatever is left of it
+		while (IsSckEdgeInWindow<CH>(csn_edge))
+			mSck->AdvanceToNextEdge();
+
+		csn_edge = mSck->GetSampleNumber();
+	}
+
+	SyncToSample<CH>(csn_edge);
+}
+
+template <U32 CH>
 bool nRF24L01_Analyzer::AdvanceSck(U64 csn_edge)
 {
 	// CSN went high before the byte was over?
-	if (!mSck->DoMoreTransitionsExistInCurrentData()  ||  mSck->GetSampleOfNextEdge() > csn_edge)
+	if (!IsSckEdgeInWindow<CH>(csn_edge))
 	{
-		SyncToSample(csn_edge);
+		EndWindow<CH>(csn_edge);
 		return false;
 	}
 
@@ -45,18 +74,66 @@ bool nRF24L01_Analyzer::AdvanceSck(U64 csn_edge)
 	return true;
 }
 
+template <U32 CH>
+U64 nRF24L01_Analyzer::GetCsnEdge()
+{
+	// where the window ends, without CSN we only know that once we're there
+	return (CH & CH_CSN) ? mCsn->GetSampleOfNextEdge() : 0;
+}
+
+template <nRFSpiMode_e MODE, U32 CH>
 bool nRF24L01_Analyzer::GetByte(SpiByte& b, const bool is_first_byte_of_command)
+{
+	if (MODE == SPI_MODE_AUTO)
+		return GetByteAuto<CH>(b, is_first_byte_of_command);
+
+	const BitState sample_state = SpiSamplesOnRisingEdge(MODE) ? BIT_HIGH : BIT_LOW;
+
+	b.Clear();
+	if (!SpiSamplesOnRisingEdge(MODE))
+		b.mFlags = SAMPLED_ON_FALLING_EDGE;
+
+	U64 csn_edge = GetCsnEdge<CH>();
+
+	for (U8 num_bits = 0; num_bits < 8; ++num_bits)
+	{
+		// to the next sampling edge
+		if (!AdvanceSck<CH>(csn_edge))
+			return false;
+		if (mSck->GetBitState() != sample_state  &&  !AdvanceSck<CH>(csn_edge))
+			return false;
+
+		SyncToSample<CH>(mSck->GetSampleNumber());
+
+		if (mMarkBits  ||  num_bits == 0)
+			b.SetBitSample(num_bits, mSck->GetSampleNumber());
+
+		b.mValMiso = (b.mValMiso << 1) | ((CH & CH_MISO)  &&  mMiso->GetBitState() == BIT_HIGH ? 1 : 0);
+		b.mValMosi = (b.mValMosi << 1) | (mMosi->GetBitState() == BIT_HIGH ? 1 : 0);
+	}
+
+	// with CPHA=0 the byte ends on the edge after the last sample
+	if (SpiSamplesOnLeadingEdge(MODE)  &&  !AdvanceSck<CH>(csn_edge))
+		return false;
+
+	b.mEndingSample = mSck->GetSampleNumber();
+
+	return true;
+}
+
+template <U32 CH>
+bool nRF24L01_Analyzer::GetByteAuto(SpiByte& b, const bool is_first_byte_of_command)
 {
 	b.Clear();
 
 	U8 num_bits = 0;
-	U64 csn_edge = mCsn->GetSampleOfNextEdge();
+	U64 csn_edge = GetCsnEdge<CH>();
 
 	// check if SCK is high
 	bool sample_first_bit_on_falling_edge = false;
 	if (mSck->GetBitState() == BIT_LOW)
 	{
-		if (!AdvanceSck(csn_edge))
+		if (!AdvanceSck<CH>(csn_edge))
 			return false;
 	} else if (is_first_byte_of_command) {
 		sample_first_bit_on_falling_edge = true;
@@ -64,36 +141,34 @@ bool nRF24L01_Analyzer::GetByte(SpiByte& b, const bool is_first_byte_of_command)
 
 	for (;;)
 	{
-		// advance to the falling edge for misbehaved SPI (maybe this behavor should be an option in the settings?)
-		if (sample_first_bit_on_falling_edge  &&  !AdvanceSck(csn_edge))
+		// advance to the falling edge for misbehaved SPI, the fixed SPI modes don't guess
+		if (sample_first_bit_on_falling_edge  &&  !AdvanceSck<CH>(csn_edge))
 			return false;
 
 		// resync the other channels
-		SyncToChannel(mSck);
-
-		if (num_bits == 0)
-			b.mStartingSample = mSck->GetSampleNumber();
+		SyncToSample<CH>(mSck->GetSampleNumber());
 
 		// remember the up or down arrow depending on the rising/falling signal edge
-		b.mMarkers[num_bits] = mSck->GetSampleNumber();
-		b.mMarkerSCK[num_bits] = sample_first_bit_on_falling_edge ? AnalyzerResults::DownArrow : AnalyzerResults::UpArrow;
-		b.mMarkerMISO[num_bits] = mMiso->GetBitState() == BIT_HIGH ? AnalyzerResults::One : AnalyzerResults::Zero;
-		b.mMarkerMOSI[num_bits] = mMosi->GetBitState() == BIT_HIGH ? AnalyzerResults::One : AnalyzerResults::Zero;
+		if (sample_first_bit_on_falling_edge)
+			b.mFlags |= FIRST_BIT_ON_FALLING_EDGE;
+
+		if (mMarkBits  ||  num_bits == 0)
+			b.SetBitSample(num_bits, mSck->GetSampleNumber());
 
-		b.mValMiso = (b.mValMiso << 1) | (mMiso->GetBitState() == BIT_HIGH ? 1 : 0);
+		b.mValMiso = (b.mValMiso << 1) | ((CH & CH_MISO)  &&  mMiso->GetBitState() == BIT_HIGH ? 1 : 0);
 		b.mValMosi = (b.mValMosi << 1) | (mMosi->GetBitState() == BIT_HIGH ? 1 : 0);
 
 		num_bits++;
 
 		// advance to SCK falling edge
-		if (!sample_first_bit_on_falling_edge  &&  !AdvanceSck(csn_edge))
+		if (!sample_first_bit_on_falling_edge  &&  !AdvanceSck<CH>(csn_edge))
 			return false;
 
 		if (num_bits == 8)
 			break;
 
 		// advance to SCK rising edge
-		if (!AdvanceSck(csn_edge))
+		if (!AdvanceSck<CH>(csn_edge))
 			return false;
 
 		sample_first_bit_on_falling_edge = false;
@@ -104,80 +179,331 @@ bool nRF24L01_Analyzer::GetByte(SpiByte& b, const bool is_first_byte_of_command)
 	return true;
 }
 
-void nRF24L01_Analyzer::WorkerThread()
+template <U32 CH>
+void nRF24L01_Analyzer::CollectSckEdges(U64 csn_edge)
 {
-	// create the results object
-	mResults.reset(new nRF24L01_AnalyzerResults(this, &mSettings));
-	SetAnalyzerResults(mResults.get());
+	mSckEdges.mStart = mSck->GetSampleNumber();
+	mSckEdges.mInitialState = mSck->GetBitState();
+	mSckEdges.mNumEdges = 0;
+	mSckEdges.mOverflow = false;
+
+	// Without CSN the window ends at the first gap after an edge, SCK is left at that edge.
+	// An oversize burst is walked to its end here too, the edges just aren't kept.
+	if ((CH & CH_CSN) == 0)
+	{
+		U64 edge = mSckEdges.mStart;
+		while (mSck->WouldAdvancingToAbsPositionCauseTransition(edge + mSckIdleGap))
+		{
+			edge = mSck->GetSampleOfNextEdge();
+			mSck->AdvanceToAbsPosition(edge);
 
-	// init the channels
-	mResults->AddChannelBubblesWillAppearOn(mSettings.mMosiChannel);
-	mResults->AddChannelBubblesWillAppearOn(mSettings.mMisoChannel);
+			if (mSckEdges.mNumEdges < SpiSckEdges::MAX_EDGES)
+				mSckEdges.mEdges[mSckEdges.mNumEdges++] = edge;
+			else
+				mSckEdges.mOverflow = true;
+		}
 
-	mMiso = GetAnalyzerChannelData(mSettings.mMisoChannel);
-	mMosi = GetAnalyzerChannelData(mSettings.mMosiChannel);
-	mSck = GetAnalyzerChannelData(mSettings.mSckChannel);
-	mCsn = GetAnalyzerChannelData(mSettings.mCsnChannel);
+		return;
+	}
 
-	std::vector<SpiByte> spi_bytes;
-	U64 cmdStart, cmdEnd;
-	for (;;)
+	while (IsSckEdgeInWindow<CH>(csn_edge))
+	{
+		// too long for a valid command anyway
+		if (mSckEdges.mNumEdges == SpiSckEdges::MAX_EDGES)
+		{
+			mSckEdges.mOverflow = true;
+			break;
+		}
+
+		mSckEdges.mEdges[mSckEdges.mNumEdges++] = mSck->GetSampleOfNextEdge();
+		mSck->AdvanceToNextEdge();
+	}
+}
+
+template <nRFSpiMode_e MODE, U32 CH>
+void nRF24L01_Analyzer::GetBytesPerBit(SpiTransactionBuffer& spi_bytes, U64 window_start)
+{
+	SyncToSample<CH>(window_start);
+
+	bool is_first = true;
+	while (GetByte<MODE, CH>(spi_bytes.Next(), is_first))
+	{
+		spi_bytes.AppendNext();
+		is_first = false;
+
+		// not for us, or CSN is broken; go straight to its end
+		if (spi_bytes.IsOversize())
+		{
+			EndWindow<CH>(GetCsnEdge<CH>());
+			return;
+		}
+	}
+}
+
+template <nRFSpiMode_e MODE, bool MARK_BITS, U32 CH>
+void nRF24L01_Analyzer::GetBytesBatch(SpiTransactionBuffer& spi_bytes, U64 window_start)
+{
+	SyncToSample<CH>(window_start);
+
+	U64 csn_edge = GetCsnEdge<CH>();
+
+	// get all the SCK edges of the window first, then sample MOSI and MISO on them
+	CollectSckEdges<CH>(csn_edge);
+
+	// without CSN that found the end of the window
+	if ((CH & CH_CSN) == 0)
+		csn_edge = mSck->GetSampleNumber();
+
+	// too many for a command, don't bother sampling the bits
+	if (mSckEdges.mOverflow)
+	{
+		spi_bytes.SetOversize();
+		SyncToSample<CH>(csn_edge);
+		return;
+	}
+
+	mMosiSampler.Begin(mMosi);
+
+	if (CH & CH_MISO)
+	{
+		mMisoSampler.Begin(mMiso);
+		DecodeSpiBytes<MODE, MARK_BITS>(mSckEdges, mMosiSampler, mMisoSampler, spi_bytes);
+	} else {
+		UnconnectedSampler no_miso;
+		DecodeSpiBytes<MODE, MARK_BITS>(mSckEdges, mMosiSampler, no_miso, spi_bytes);
+	}
+
+	SyncToSample<CH>(csn_edge);
+}
+
+template <nRFSpiMode_e MODE, U32 CH>
+nRF24L01_Analyzer::GetBytesFn nRF24L01_Analyzer::SelectDecoder() const
+{
+	if (mSettings.mDecoder == DECODER_PER_BIT)
+		return &nRF24L01_Analyzer::GetBytesPerBit<MODE, CH>;
+
+	if (mMarkBits)
+		return &nRF24L01_Analyzer::GetBytesBatch<MODE, true, CH>;
+
+	return &nRF24L01_Analyzer::GetBytesBatch<MODE, false, CH>;
+}
+
+template <nRFSpiMode_e MODE>
+nRF24L01_Analyzer::GetBytesFn nRF24L01_Analyzer::SelectGetBytes() const
+{
+	if (mCsn != NULL  &&  mMiso != NULL)
+		return SelectDecoder<MODE, CH_CSN | CH_MISO>();
+
+	if (mCsn != NULL)
+		return SelectDecoder<MODE, CH_CSN>();
+
+	if (mMiso != NULL)
+		return SelectDecoder<MODE, CH_MISO>();
+
+	return SelectDecoder<MODE, 0>();
+}
+
+U8 nRF24L01_Analyzer::NextCsnWindow()
+{
+	if (mNumRadios == 1)
 	{
 		// find the falling edge of CSN
 		mCsn->AdvanceToNextEdge();
 		if (mCsn->GetBitState() == BIT_HIGH)
 			mCsn->AdvanceToNextEdge();
 
-		// advance all the others here too
-		SyncToChannel(mCsn);
+		return 0;
+	}
+
+	for (;;)
+	{
+		U64 bus_sample = mSck->GetSampleNumber();
+
+		// the earliest falling edge of all the CSNs
+		U8 next = MAX_RADIOS;
+		U64 next_edge = 0;
+		for (U8 radio = 0; radio < mNumRadios; ++radio)
+		{
+			AnalyzerChannelData* csn = mCsns[radio];
 
-		// remember in case we have to put a marker
-		cmdStart = mCsn->GetSampleNumber();
+			// skip the windows that started before we got here; one that overlaps
+			// another radio's transaction is a bus conflict and can't be decoded anyway
+			while (csn->DoMoreTransitionsExistInCurrentData())
+			{
+				U64 edge = csn->GetSampleOfNextEdge();
+				if (csn->GetBitState() == BIT_HIGH  &&  edge >= bus_sample)
+				{
+					if (next == MAX_RADIOS  ||  edge < next_edge)
+					{
+						next = radio;
+						next_edge = edge;
+					}
 
-		// get a command
-		SpiByte b;
-		bool is_first = true;
-		spi_bytes.clear();
-		while (GetByte(b, is_first))
+					break;
+				}
+
+				csn->AdvanceToNextEdge();
+			}
+		}
+
+		if (next != MAX_RADIOS)
 		{
-			// 33 bytes is the longest valid command according to the specs
-			if (spi_bytes.size() < 34)
-				spi_bytes.push_back(b);
+			mCsn = mCsns[next];
+			mCsn->AdvanceToNextEdge();
+
+			return next;
+		}
+
+		// None of them is selected in the data so far. Wait for the bus instead of any one
+		// CSN, a radio that's never selected would block us forever. Once the next SCK edge
+		// is in, the CSNs are in up to there as well.
+		mSck->GetSampleOfNextEdge();
+
+		bool csn_moved = false;
+		for (U8 radio = 0; radio < mNumRadios  &&  !csn_moved; ++radio)
+			csn_moved = mCsns[radio]->DoMoreTransitionsExistInCurrentData();
+
+		if (!csn_moved)
+			mSck->AdvanceToNextEdge();
+	}
+}
+
+bool nRF24L01_Analyzer::IsCaughtUp()
+{
+	if (mCsn == NULL)
+		return !mSck->DoMoreTransitionsExistInCurrentData();
+
+	for (U32 radio = 0; radio < mNumRadios; ++radio)
+	{
+		if (mCsns[radio]->DoMoreTransitionsExistInCurrentData())
+			return false;
+	}
+
+	return true;
+}
+
+void nRF24L01_Analyzer::CreateResults()
+{
+	mResults.reset(new nRF24L01_AnalyzerResults(this, &mSettings));
+	mResults->SetStreaming(mStreaming);
+	SetAnalyzerResults(mResults.get());
+
+	// MISO and CSN are optional
+	mResults->AddChannelBubblesWillAppearOn(mSettings.mMosiChannel);
+	if (mSettings.mMisoChannel != UNDEFINED_CHANNEL)
+		mResults->AddChannelBubblesWillAppearOn(mSettings.mMisoChannel);
+
+	// each radio gets its own bubbles on its CSN
+	if (mSettings.mCsnChannels[0] != UNDEFINED_CHANNEL  &&  mSettings.mNumRadios > 1)
+	{
+		for (U32 radio = 0; radio < mSettings.mNumRadios; ++radio)
+			mResults->AddChannelBubblesWillAppearOn(mSettings.mCsnChannels[radio]);
+	}
+}
+
+void nRF24L01_Analyzer::WorkerThread()
+{
+	CreateResults();
+
+	// init the channels, MISO and CSN are optional
+	mMiso = NULL;
+	if (mSettings.mMisoChannel != UNDEFINED_CHANNEL)
+		mMiso = GetAnalyzerChannelData(mSettings.mMisoChannel);
+
+	mMosi = GetAnalyzerChannelData(mSettings.mMosiChannel);
+	mSck = GetAnalyzerChannelData(mSettings.mSckChannel);
+
+	mNumRadios = mSettings.mCsnChannels[0] != UNDEFINED_CHANNEL ? mSettings.mNumRadios : 0;
+	for (U32 radio = 0; radio < mNumRadios; ++radio)
+		mCsns[radio] = GetAnalyzerChannelData(mSettings.mCsnChannels[radio]);
+
+	mCsn = mNumRadios > 0 ? mCsns[0] : NULL;
 
-			is_first = false;
+	// without CSN the transactions are told apart by the pauses of SCK
+	mSckIdleGap = U64(mSettings.mSckIdleGapNs) * GetSampleRate() / 1000000000;
+	if (mSckIdleGap == 0)
+		mSckIdleGap = 1;
+
+	mMarkBits = mSettings.mMarkers == MARKERS_SCK  ||  mSettings.mMarkers == MARKERS_FULL;
+
+	switch (mSettings.mSpiMode)
+	{
+	case SPI_MODE_0:	mGetBytes = SelectGetBytes<SPI_MODE_0>();		break;
+	case SPI_MODE_1:	mGetBytes = SelectGetBytes<SPI_MODE_1>();		break;
+	case SPI_MODE_2:	mGetBytes = SelectGetBytes<SPI_MODE_2>();		break;
+	case SPI_MODE_3:	mGetBytes = SelectGetBytes<SPI_MODE_3>();		break;
+	default:			mGetBytes = SelectGetBytes<SPI_MODE_AUTO>();	break;
+	}
+
+	SpiTransactionBuffer spi_bytes;
+	U64 cmdStart, cmdEnd;
+	for (;;)
+	{
+		U8 radio = 0;
+		if (mCsn != NULL)
+		{
+			// find the falling edge of the next CSN
+			radio = NextCsnWindow();
+
+			// remember in case we have to put a marker
+			cmdStart = mCsn->GetSampleNumber();
+		} else {
+			// SCK starts moving again after the idle gap
+			cmdStart = mSck->GetSampleOfNextEdge() - 1;
 		}
 
-		cmdEnd = mCsn->GetSampleNumber();
+		// get a command, all the channels are advanced to its start first
+		spi_bytes.clear();
+		(this->*mGetBytes)(spi_bytes, cmdStart);
+
+		cmdEnd = mCsn != NULL ? mCsn->GetSampleNumber() : mSck->GetSampleNumber();
 
 		// decode the command
 		// this creates separate command and data frames
-		bool created = mResults->CreateFramesFromSpiBytes(spi_bytes, cmdStart, cmdEnd);
+		bool created = mResults->CreateFramesFromSpiBytes(spi_bytes, cmdStart, cmdEnd, radio);
 
-		// add the markers if frames were created
+		// add the markers if frames were created, the oversize bursts get none
 		if (created)
-		{
-			int num_bits, markerType = 0;
-			std::vector<SpiByte>::const_iterator spi_i;
-			for (spi_i = spi_bytes.begin(); spi_i != spi_bytes.end(); ++spi_i)
-			{
-				for (num_bits = 0; num_bits < 8; ++num_bits)
-				{
-					mResults->AddMarker(spi_i->mMarkers[num_bits], spi_i->mMarkerSCK[num_bits], mSettings.mSckChannel);
+			mResults->AddMarkers(spi_bytes, cmdStart, cmdEnd, radio);
 
-					mResults->AddMarker(spi_i->mMarkers[num_bits], spi_i->mMarkerMOSI[num_bits], mSettings.mMosiChannel);
-					mResults->AddMarker(spi_i->mMarkers[num_bits], spi_i->mMarkerMISO[num_bits], mSettings.mMisoChannel);
-				}
-			}
-
-			mResults->AddMarker(cmdStart, AnalyzerResults::Start, mSettings.mCsnChannel);
-			mResults->AddMarker(cmdEnd, AnalyzerResults::Stop, mSettings.mCsnChannel);
-		}
+		// commit in batches unless the next command isn't in the capture yet
+		mResults->CommitIfNeeded(IsCaughtUp());
 
 		// update progress bar
 		ReportProgress(mSck->GetSampleNumber());
 	}
 }
 
+bool nRF24L01_Analyzer::DecodeOffline(const nRFBusEdges& bus, U32 num_threads)
+{
+	if (mSettings.mCsnChannels[0] == UNDEFINED_CHANNEL)
+		return false;
+
+	CreateResults();
+
+	bool mark_bits = mSettings.mMarkers == MARKERS_SCK  ||  mSettings.mMarkers == MARKERS_FULL;
+	nRFSegmentDecoder decoder(mSettings.mSpiMode, mark_bits);
+
+	decoder.FindWindows(bus.mCsns, mSettings.mNumRadios);
+
+	// the same as the worker thread does with each window, in the same order
+	const nRFChannelEdges* miso = mSettings.mMisoChannel != UNDEFINED_CHANNEL ? &bus.mMiso : NULL;
+	decoder.Decode(bus.mSck, bus.mMosi, miso, num_threads,
+					[this](const nRFSegmentDecoder::Window& window, const SpiTransactionBuffer& spi_bytes)
+					{
+						if (mResults->CreateFramesFromSpiBytes(spi_bytes, window.mStart, window.mEnd, window.mRadio))
+							mResults->AddMarkers(spi_bytes, window.mStart, window.mEnd, window.mRadio);
+
+						mResults->CommitIfNeeded(false);
+						ReportProgress(window.mEnd);
+					});
+
+	// there's nothing more to wait for
+	mResults->CommitIfNeeded(true);
+
+	return true;
+}
+
 bool nRF24L01_Analyzer::NeedsRerun()
 {
 	return false;
@@ -1,5 +1,7 @@
 #include <iostream>
 #include <fstream>
+#include <algorithm>
+#include <cstring>
 #include <assert.h>
 
 #include <AnalyzerHelpers.h>
@@ -8,124 +10,380 @@
 #include "nRF24L01_AnalyzerResults.h"
 #include "nRF24L01_Analyzer.h"
 #include "nRF24L01_AnalyzerSettings.h"
+#include "nRFTables.h"
+#include "nRFCsvExporter.h"
+#include "nRFBinaryWriter.h"
+#include "nRFExportFilter.h"
 
 nRF24L01_AnalyzerResults::nRF24L01_AnalyzerResults(nRF24L01_Analyzer* analyzer, nRF24L01_AnalyzerSettings* settings) :
 	mSettings(settings),
 	mAnalyzer(analyzer),
-	mCommandWordFrameIndex(0xFFFFFFFFFFFFFFFFLL)
-{}
+	mStatistics(analyzer->GetSampleRate() / 10),
+	mPayloadIndex(nRFPayloadIndex::DEFAULT_MAX_BYTES),
+	mMarkerCount(0),
+	mStreaming(false),
+	mPendingTransactions(0),
+	mPendingStartSample(0),
+	mPendingEndSample(0),
+	mCommitSpan(0),
+	mExportedRows(0),
+	mExportFromSample(0),
+	mExportToSample(0xFFFFFFFFFFFFFFFFull)
+{
+	// a quarter of a second of capture per batch at most
+	mCommitSpan = mAnalyzer->GetSampleRate() / 4;
+
+	mExtendedData.SetRamBudget(U64(mSettings->mPayloadRamMB) << 20);
+}
 
 nRF24L01_AnalyzerResults::~nRF24L01_AnalyzerResults()
 {}
 
+void nRF24L01_AnalyzerResults::GetCommand(U64 frame_index, const Frame& f, nRFCommand& cmd)
+{
+	U64 cmd_frame_index = (f.mFlags & IS_COMMAND) ? frame_index : frame_index - 1;
+
+	// decode the command unless we've done that recently
+	if (mCommandCache.Find(cmd_frame_index, cmd))
+		return;
+
+	Frame fOther;
+
+	if (f.mFlags & IS_COMMAND)
+	{
+		if (f.mFlags & HAS_DATA_FRAME)
+			fOther = GetFrame(frame_index + 1);
+
+		cmd.Decode(&f, &fOther, mExtendedData);
+	} else {
+		fOther = GetFrame(frame_index - 1);
+
+		cmd.Decode(&fOther, &f, mExtendedData);
+	}
+
+	mCommandCache.Insert(cmd_frame_index, cmd);
+}
+
+bool nRF24L01_AnalyzerResults::PayloadContains(U64 frame_index, const U8* pattern, U32 length)
+{
+	Frame f = GetFrame(frame_index);
+	if ((f.mFlags & (IS_COMMAND | IS_OVERSIZE_BURST))  ||  f.mType < length)
+		return false;
+
+	// only the payload commands
+	Frame fCmd = GetFrame(frame_index - 1);
+	if ((GetCommandInfo(U8(fCmd.mData1)).mFlags & CMD_HAS_PAYLOAD) == 0)
+		return false;
+
+	U8 data[32];
+	U32 data_length = f.mType;
+	if (f.mFlags & IS_EXTENDED)
+	{
+		data_length = mExtendedData.Get(f.mData1, data);
+	} else {
+		::memcpy(data, &f.mData1, sizeof(f.mData1));
+		::memcpy(data + sizeof(f.mData1), &f.mData2, sizeof(f.mData2));
+	}
+
+	return std::search(data, data + data_length, pattern, pattern + length) != data + data_length;
+}
+
+void nRF24L01_AnalyzerResults::FindPayload(const U8* pattern, U32 length, std::vector<U64>& frame_indices)
+{
+	frame_indices.clear();
+	if (length == 0)
+		return;
+
+	// the index narrows it down to a few frames, they still need checking
+	std::vector<U64> candidates;
+	U64 scan_from = 0;
+	mPayloadIndex.FindCandidates(pattern, length, candidates, scan_from);
+
+	for (size_t c = 0; c < candidates.size(); ++c)
+	{
+		if (PayloadContains(candidates[c], pattern, length))
+			frame_indices.push_back(candidates[c]);
+	}
+
+	// single bytes, and the frames the index had no room for
+	U64 num_frames = GetNumFrames();
+	for (U64 frame_index = std::max<U64>(scan_from, 1); frame_index < num_frames; ++frame_index)
+	{
+		if (PayloadContains(frame_index, pattern, length))
+			frame_indices.push_back(frame_index);
+	}
+}
+
+U64 nRF24L01_AnalyzerResults::FindNextEvent(const U8* sets, size_t num_sets, U64 from_sample)
+{
+	// the command frame of the first transaction from there on
+	nRFSampleIndex::Cursor cursor(mSampleIndex, from_sample);
+	nRFSampleIndex::Entry entry;
+	if (!cursor.Next(entry))
+		return INVALID_RESULT_INDEX;
+
+	U64 frame_index = mEventIndex.FindNext(sets, num_sets, entry.mFrameIndex);
+	return frame_index == nRFEventBitmap::INVALID_INDEX ? INVALID_RESULT_INDEX : frame_index;
+}
+
 void nRF24L01_AnalyzerResults::GenerateBubbleText(U64 frame_index, Channel& channel, DisplayBase display_base)
 {
 	ClearResultStrings();
 	Frame f = GetFrame(frame_index);
 
-	// create the command object if we're on a new command
-	if (frame_index != mCommandWordFrameIndex)
+	nRFTextList texts;
+
+	if (f.mFlags & IS_OVERSIZE_BURST)
 	{
-		U64 cmd_frame_index = 0;
-		Frame fOther;
-		Frame* pFCmd = 0;
-		Frame* pFData = 0;
+		if (mSettings->mNumRadios > 1  &&  channel != mSettings->mMosiChannel  &&  channel != mSettings->mMisoChannel
+				&&  channel != mSettings->mCsnChannels[f.mType])
+			return;
+
+		GetOversizeBurstTexts(f, texts);
+		for (size_t c = 0; c < texts.size(); ++c)
+			AddResultString(texts[c].c_str());
+
+		return;
+	}
 
-		if (f.mFlags & IS_COMMAND)
+	nRFCommand cmd;
+	GetCommand(frame_index, f, cmd);
+
+	// with more radios on the bus each CSN only gets the bubbles of its own transactions
+	bool is_mosi = channel == mSettings->mMosiChannel;
+	if (mSettings->mNumRadios > 1  &&  !is_mosi  &&  channel != mSettings->mMisoChannel)
+	{
+		if (channel != mSettings->mCsnChannels[cmd.mRadio])
+			return;
+
+		is_mosi = (f.mFlags & IS_DATA_ON_MISO) == 0;
+	}
+
+	if (f.mFlags & IS_COMMAND)
+		cmd.GetCommandText(is_mosi, texts, display_base);
+	else
+		cmd.GetDataText(is_mosi, texts, display_base);
+
+	for (size_t c = 0; c < texts.size(); ++c)
+		AddResultString(texts[c].c_str());
+}
+
+void nRF24L01_AnalyzerResults::SetExportRange(U64 from_sample, U64 to_sample)
+{
+	mExportFromSample = from_sample;
+	mExportToSample = to_sample;
+}
+
+void nRF24L01_AnalyzerResults::GenerateExportFile(const char* file, DisplayBase display_base, U32 export_type_user_id)
+{
+	if (export_type_user_id == EXPORT_BINARY)
+	{
+		GenerateBinaryExportFile(file);
+		return;
+	}
+
+	if (export_type_user_id == EXPORT_STATISTICS)
+	{
+		GenerateStatisticsExportFile(file);
+		return;
+	}
+
+	if (export_type_user_id == EXPORT_FILTERED)
+	{
+		GenerateFilteredExportFile(file, display_base);
+		return;
+	}
+
+	U64 fcnt = 0;
+	Frame cmd_frame, data_frame;
+
+	// only the transactions in the export range
+	nRFSampleIndex::Cursor cursor(mSampleIndex, mExportFromSample);
+	nRFSampleIndex::Entry entry;
+
+	// the frames are read and decoded here, the exporter's workers only make the text
+	nRFCsvExporter::ReadRowsFn read_rows = [&](std::vector<nRFExportRow>& rows, U64& frames_done)
+	{
+		while (rows.size() < nRFCsvExporter::CHUNK_ROWS  &&  cursor.Next(entry)  &&  entry.mStartSample <= mExportToSample)
 		{
-			fOther = GetFrame(frame_index + 1);
+			// get the command frame
+			fcnt = entry.mFrameIndex;
+			cmd_frame = GetFrame(fcnt);
 
-			pFCmd = &f;
-			pFData = &fOther;
+			rows.push_back(nRFExportRow());
+			nRFExportRow& row = rows.back();
 
-			cmd_frame_index = frame_index;
-		} else {
-			fOther = GetFrame(frame_index - 1);
+			// do we have a data frame as well?
+			row.mHasData = (cmd_frame.mFlags & HAS_DATA_FRAME) != 0;
+			if (row.mHasData)
+				data_frame = GetFrame(fcnt + 1);
 
-			pFCmd = &fOther;
-			pFData = &f;
+			// decode the frames
+			row.mCommand.Decode(&cmd_frame, &data_frame, mExtendedData);
+			row.mStartingSample = cmd_frame.mStartingSampleInclusive;
 
-			cmd_frame_index = frame_index - 1;
+			// skip the data frame
+			fcnt += row.mHasData ? 2 : 1;
 		}
 
-		if (cmd_frame_index != mCommandWordFrameIndex)
+		frames_done = fcnt;
+		return rows.size();
+	};
+
+	WriteTextExport(file, display_base, read_rows);
+}
+
+void nRF24L01_AnalyzerResults::GenerateFilteredExportFile(const char* file, DisplayBase display_base)
+{
+	// the settings only take filters that compile
+	nRFExportFilter filter;
+	std::string error;
+	filter.Compile(mSettings->mExportFilter.c_str(), error);
+
+	nRFExportFilter::FindPayloadFn find_payload = [this](const U8* pattern, U32 length, std::vector<U64>& data_frames)
+	{
+		FindPayload(pattern, length, data_frames);
+	};
+
+	filter.Prepare(mEventIndex, find_payload, mAnalyzer->GetTriggerSample(), mAnalyzer->GetSampleRate());
+
+	// the time terms narrow the export range down
+	U64 from_sample, to_sample;
+	filter.GetSampleRange(from_sample, to_sample);
+	from_sample = std::max(from_sample, mExportFromSample);
+	to_sample = std::min(to_sample, mExportToSample);
+
+	U64 num_frames = GetNumFrames();
+	U64 next_frame = nRFExportFilter::INVALID_FRAME;
+	Frame cmd_frame, data_frame;
+
+	nRFSampleIndex::Entry entry;
+	if (from_sample <= to_sample  &&  nRFSampleIndex::Cursor(mSampleIndex, from_sample).Next(entry))
+		next_frame = entry.mFrameIndex;
+
+	// Only the candidates get their command frame read, and only the matches get decoded.
+	// Without anything to narrow it down every transaction in the range is a candidate.
+	nRFCsvExporter::ReadRowsFn read_rows = [&](std::vector<nRFExportRow>& rows, U64& frames_done)
+	{
+		while (rows.size() < nRFCsvExporter::CHUNK_ROWS  &&  next_frame < num_frames)
 		{
-			mCommand.Decode(pFCmd, pFData, mExtendedData);
-			mCommandWordFrameIndex = cmd_frame_index;
-		}
-	}
+			U64 fcnt = filter.FindNextCandidate(next_frame);
+			if (fcnt >= num_frames)
+			{
+				next_frame = nRFExportFilter::INVALID_FRAME;
+				break;
+			}
 
-	std::vector<std::string> texts;
+			cmd_frame = GetFrame(fcnt);
+			if (U64(cmd_frame.mStartingSampleInclusive) > to_sample)
+			{
+				next_frame = nRFExportFilter::INVALID_FRAME;
+				break;
+			}
 
-	if (f.mFlags & IS_COMMAND)
-		mCommand.GetCommandText(channel == mSettings->mMosiChannel, texts, display_base);
-	else
-		mCommand.GetDataText(channel == mSettings->mMosiChannel, texts, display_base);
+			// only the commands
+			if (cmd_frame.mFlags & IS_OVERSIZE_BURST)
+			{
+				next_frame = fcnt + 1;
+				continue;
+			}
 
-	for (std::vector<std::string>::iterator it(texts.begin()); it != texts.end(); ++it)
-		AddResultString(it->c_str());
+			bool has_data = (cmd_frame.mFlags & HAS_DATA_FRAME) != 0;
+			next_frame = fcnt + (has_data ? 2 : 1);
+
+			if (!filter.Matches(fcnt, U8(cmd_frame.mData1), U8(cmd_frame.mData2), cmd_frame.mType, cmd_frame.mStartingSampleInclusive))
+				continue;
+
+			rows.push_back(nRFExportRow());
+			nRFExportRow& row = rows.back();
+
+			row.mHasData = has_data;
+			if (has_data)
+				data_frame = GetFrame(fcnt + 1);
+
+			row.mCommand.Decode(&cmd_frame, &data_frame, mExtendedData);
+			row.mStartingSample = cmd_frame.mStartingSampleInclusive;
+		}
+
+		frames_done = std::min(next_frame, num_frames);
+		return rows.size();
+	};
+
+	WriteTextExport(file, display_base, read_rows);
 }
 
-void nRF24L01_AnalyzerResults::GenerateExportFile(const char* file, DisplayBase display_base, U32 export_type_user_id)
+void nRF24L01_AnalyzerResults::WriteTextExport(const char* file, DisplayBase display_base, const nRFCsvExporter::ReadRowsFn& read_rows)
 {
 	std::ofstream file_stream( file, std::ios::out );
 
-	U64 trigger_sample = mAnalyzer->GetTriggerSample();
-	U32 sample_rate = mAnalyzer->GetSampleRate();
+	U64 num_frames = GetNumFrames();
+
+	nRFCsvExporter::ProgressFn progress = [&](U64 frames_done)
+	{
+		return UpdateExportProgressAndCheckForCancel(frames_done, num_frames);
+	};
 
-	file_stream << "Time [s];Status;Command;Data" << std::endl;
+	nRFCsvExporter exporter(display_base, mAnalyzer->GetTriggerSample(), mAnalyzer->GetSampleRate(), mSettings->mNumRadios > 1);
+	mExportedRows = exporter.Export(file_stream, read_rows, progress);
+
+	// end
+	if (!exporter.WasCancelled())
+		UpdateExportProgressAndCheckForCancel(num_frames, num_frames);
+}
+
+void nRF24L01_AnalyzerResults::GenerateBinaryExportFile(const char* file)
+{
+	std::ofstream file_stream( file, std::ios::out | std::ios::binary );
 
 	U64 num_frames = GetNumFrames();
+
+	// the columns are laid out by the number of rows
+	U64 num_rows = mSampleIndex.CountInRange(mExportFromSample, mExportToSample);
+
+	nRFBinaryWriter writer(file_stream, num_rows, mAnalyzer->GetSampleRate(), mAnalyzer->GetTriggerSample());
+
+	nRFSampleIndex::Cursor cursor(mSampleIndex, mExportFromSample);
+	nRFSampleIndex::Entry entry;
+
 	Frame cmd_frame, data_frame;
 	nRFCommand cmd;
-	std::vector<std::string> texts;
-	std::string commandText, statusText, dataText;
-	bool has_data;
-	for (U64 fcnt = 0; fcnt < num_frames; fcnt++)
+	while (writer.GetNumRows() < num_rows  &&  cursor.Next(entry))
 	{
-		// get the command frame
+		U64 fcnt = entry.mFrameIndex;
 		cmd_frame = GetFrame(fcnt);
 
-		// do we have a data frame as well?
-		has_data = (cmd_frame.mFlags & HAS_DATA_FRAME) != 0;
+		bool has_data = (cmd_frame.mFlags & HAS_DATA_FRAME) != 0;
 		if (has_data)
 			data_frame = GetFrame(fcnt + 1);
 
-		// decode the frames
 		cmd.Decode(&cmd_frame, &data_frame, mExtendedData);
+		if (!has_data)
+			cmd.mDataLength = 0;
 
-		char time_str[128];
-		AnalyzerHelpers::GetTimeString(cmd_frame.mStartingSampleInclusive, trigger_sample, sample_rate, time_str, sizeof(time_str));
+		writer.AddRow(cmd_frame.mStartingSampleInclusive, cmd);
 
-		cmd.GetCommandText(false, texts, display_base);
-		statusText = texts.front(); 
-
-		cmd.GetCommandText(true, texts, display_base);
-		commandText = texts.front();
+		fcnt += has_data ? 2 : 1;
 
-		dataText.clear();
-		if (has_data)
-		{
-			cmd.GetDataText(true, texts, display_base);
-			if (texts.empty())
-				cmd.GetDataText(false, texts, display_base);
+		if (writer.GetNumRows() % nRFBinaryWriter::CHUNK_ROWS == 0
+				&&  UpdateExportProgressAndCheckForCancel(fcnt, num_frames))
+			break;
+	}
 
-			if (!texts.empty())
-				dataText = texts.front();
-		}
+	writer.Finish();
+	mExportedRows = writer.GetNumRows();
 
-		file_stream << time_str << ";" << statusText << ";" << commandText << ";" << dataText << std::endl;
+	UpdateExportProgressAndCheckForCancel(num_frames, num_frames);
+}
 
-		if (UpdateExportProgressAndCheckForCancel(fcnt, num_frames))
-			return;
+void nRF24L01_AnalyzerResults::GenerateStatisticsExportFile(const char* file)
+{
+	std::ofstream file_stream( file, std::ios::out );
 
-		// skip the data frame
-		if (has_data)
-			fcnt++;
-	}
+	// nothing to go through, it's all been counted while decoding
+	mStatistics.Write(file_stream, mAnalyzer->GetTriggerSample(), mAnalyzer->GetSampleRate());
+	mExportedRows = 0;
 
-	// end
-	UpdateExportProgressAndCheckForCancel(num_frames, num_frames);
+	UpdateExportProgressAndCheckForCancel(GetNumFrames(), GetNumFrames());
 }
 
 void nRF24L01_AnalyzerResults::GenerateFrameTabularText(U64 frame_index, DisplayBase display_base)
@@ -133,26 +391,156 @@ void nRF24L01_AnalyzerResults::GenerateFrameTabularText(U64 frame_index, Display
 	Frame frame = GetFrame(frame_index);
 	ClearResultStrings();
 
-	char number_str[128];
-	AnalyzerHelpers::GetNumberString( frame.mData1, display_base, 8, number_str, 128 );
-	AddResultString( number_str );
+	// with more radios on the bus each row says whose transaction it is
+	nRFShortText csn;
+
+	nRFTextList texts;
+	if (frame.mFlags & IS_OVERSIZE_BURST)
+	{
+		if (mSettings->mNumRadios > 1)
+			csn.Append(mSettings->GetCsnName(frame.mType)).Append(": ");
+
+		GetOversizeBurstTexts(frame, texts);
+		AddResultString(csn.c_str(), texts.front().c_str());
+		return;
+	}
+
+	nRFCommand cmd;
+	GetCommand(frame_index, frame, cmd);
+
+	if (mSettings->mNumRadios > 1)
+		csn.Append(mSettings->GetCsnName(cmd.mRadio)).Append(": ");
+
+	if (frame.mFlags & IS_COMMAND)
+	{
+		nRFTextList status_texts;
+		cmd.GetCommandText(true, texts, display_base);
+		cmd.GetCommandText(false, status_texts, display_base);
+
+		AddResultString(csn.c_str(), texts.front().c_str(), "  ", status_texts.front().c_str());
+	} else {
+		cmd.GetDataText((frame.mFlags & IS_DATA_ON_MISO) == 0, texts, display_base);
+
+		if (texts.empty())
+			return;
+
+		nRFShortText state;
+		GetEffectiveState(frame_index - 1, cmd, state, display_base);
+
+		if (state.empty())
+			AddResultString(csn.c_str(), texts.longest().c_str());
+		else
+			AddResultString(csn.c_str(), texts.longest().c_str(), "  ", state.c_str());
+	}
+}
+
+void nRF24L01_AnalyzerResults::GetEffectiveState(U64 cmd_frame_index, const nRFCommand& cmd, nRFShortText& text, DisplayBase display_base)
+{
+	// RX_P_NO is 7 when the RX FIFO is empty, and the ACK payload pipe could be garbage
+	U8 pipe = 0;
+	U8 addr_reg;
+	if (cmd.mCommand == W_TX_PAYLOAD  ||  cmd.mCommand == W_TX_PAYLOAD_NOACK)
+		addr_reg = TX_ADDR;
+	else if (cmd.mCommand == W_ACK_PAYLOAD)
+		addr_reg = RX_ADDR_P0 + (pipe = cmd.mCommandByte & 7);
+	else if (cmd.mCommand == R_RX_PAYLOAD)
+		addr_reg = RX_ADDR_P0 + (pipe = (cmd.mStatus >> 1) & 7);
+	else
+		return;
+
+	nRFRegisterFile regs;
+	mRegisterShadows[cmd.mRadio].GetState(cmd_frame_index, regs);
+
+	if (regs.IsKnown(RF_CH))
+		text.Append("RF_CH=").AppendDecimal(regs.Get(RF_CH) & 0x7F);
+
+	U8 addr[nRFRegisterFile::MAX_WIDTH];
+	U32 width;
+	if (pipe < 6  &&  regs.GetAddress(addr_reg, addr, width))
+	{
+		text.AddPart(REGISTER_NAMES[addr_reg]).Append("=");
+		text.AppendBytes(addr, width, display_base);
+	}
 }
 
 void nRF24L01_AnalyzerResults::GeneratePacketTabularText(U64 packet_id, DisplayBase display_base)
 {
 	ClearResultStrings();
-	AddResultString("not supported");
+
+	U64 first_frame, last_frame;
+	GetFramesContainedInPacket(packet_id, &first_frame, &last_frame);
+
+	Frame frame = GetFrame(first_frame);
+	nRFCommand cmd;
+	GetCommand(first_frame, frame, cmd);
+
+	nRFTextList cmd_texts, data_texts;
+	cmd.GetCommandText(true, cmd_texts, display_base);
+	if (frame.mFlags & HAS_DATA_FRAME)
+		cmd.GetDataText(!cmd.IsRead(), data_texts, display_base);
+
+	if (data_texts.empty())
+		AddResultString(cmd_texts.front().c_str());
+	else
+		AddResultString(cmd_texts.front().c_str(), "  ", data_texts.longest().c_str());
 }
 
 void nRF24L01_AnalyzerResults::GenerateTransactionTabularText(U64 transaction_id, DisplayBase display_base)
 {
 	ClearResultStrings();
-	AddResultString("not supported");
+
+	nRFOperation op;
+	if (!mOperations.GetOperation(transaction_id, op))
+		return;
+
+	nRFShortText text;
+	if (mSettings->mNumRadios > 1)
+		text.Append(mSettings->GetCsnName(op.mRadio)).Append(": ");
+	op.GetText(text);
+	AddResultString(text.c_str());
+}
+
+void nRF24L01_AnalyzerResults::GetOversizeBurstTexts(const Frame& f, nRFTextList& texts)
+{
+	U64 us = U64(double(f.mData1) * 1e6 / mAnalyzer->GetSampleRate());
+
+	texts.push_back().Append("Oversize burst, ").AppendDecimal(us).Append(" us skipped");
+	texts.push_back().Append("Oversize burst");
+	texts.push_back().Append("!");
 }
 
-bool nRF24L01_AnalyzerResults::CreateFramesFromSpiBytes(const std::vector<SpiByte>& spi_bytes, U64 csnLow, U64 csnHi)
+void nRF24L01_AnalyzerResults::AddOversizeBurst(U64 csnLow, U64 csnHi, U8 radio)
 {
-	if (spi_bytes.empty()  ||  spi_bytes.size() > 33)
+	Frame frm;
+	frm.mData1 = csnHi - csnLow;
+	frm.mData2 = 0;
+	frm.mStartingSampleInclusive = csnLow;
+	frm.mEndingSampleInclusive = csnHi;
+	frm.mType = radio;
+	frm.mFlags = IS_OVERSIZE_BURST | DISPLAY_AS_ERROR_FLAG;
+
+	AddFrame(frm);
+
+	// not a command, so it's in no packet and none of the indexes
+	CancelPacketAndStartNewPacket();
+
+	mStatistics.AddOversizeBurst(csnLow, csnHi);
+
+	if (mPendingTransactions++ == 0)
+		mPendingStartSample = csnLow;
+	mPendingEndSample = csnHi;
+}
+
+bool nRF24L01_AnalyzerResults::CreateFramesFromSpiBytes(const SpiTransactionBuffer& spi_bytes, U64 csnLow, U64 csnHi, U8 radio)
+{
+	// another device on the bus, or CSN is off
+	if (spi_bytes.IsOversize())
+	{
+		AddOversizeBurst(csnLow, csnHi, radio);
+		return false;
+	}
+
+	if (spi_bytes.empty())
 		return false;
 
 	// make the command frame
@@ -162,10 +550,10 @@ bool nRF24L01_AnalyzerResults::CreateFramesFromSpiBytes(const std::vector<SpiByt
 	frmCmd.mData2 = command_byte.mValMiso;		// STATUS register
 	frmCmd.mStartingSampleInclusive = csnLow;
 	frmCmd.mEndingSampleInclusive = command_byte.mEndingSample;
-	frmCmd.mType = 0;
+	frmCmd.mType = radio;
 	frmCmd.mFlags = IS_COMMAND;
 
-	std::vector<SpiByte>::const_iterator spi_i;
+	const SpiByte* spi_i;
 
 	// make the data frame
 	Frame frmData;
@@ -175,8 +563,9 @@ bool nRF24L01_AnalyzerResults::CreateFramesFromSpiBytes(const std::vector<SpiByt
 		frmData.mEndingSampleInclusive = spi_bytes.back().mEndingSample;
 		frmData.mFlags = 0;
 
-		nRFCommand_e cmd = nRFCommand::GetCommandFromByte(command_byte.mValMosi);
-		bool use_miso = (cmd == R_REGISTER  ||  cmd == R_RX_PAYLOAD  ||  cmd == R_RX_PL_WID);
+		const nRFCommandInfo& info = GetCommandInfo(command_byte.mValMosi);
+		nRFCommand_e cmd = nRFCommand_e(info.mCommand);
+		bool use_miso = (info.mFlags & CMD_IS_READ) != 0;
 
 		// do we have a data for a command which should have none?
 		if (cmd != FLUSH_TX  &&  cmd != FLUSH_RX  &&  cmd != REUSE_TX_PL  &&  cmd != NOP)
@@ -212,21 +601,16 @@ bool nRF24L01_AnalyzerResults::CreateFramesFromSpiBytes(const std::vector<SpiByt
 		} else {
 			// The data payload is longer that 16 bytes.
 			// In this case the data will be kept in mExtendedData,
-			// and mData1 will hold the index of where the data begins in the vector.
-			// We could also use mData2 to store the first 8 bytes of the payload
-			// and save a little memory, but that would be a little too much.
-			// Premature optimisation and all that....
-			
-			frmData.mData1 = mExtendedData.size();
-			frmData.mData2 = 0;
+			// and mData1 will hold the ID of the payload in the store.
 
+			U8 payload[32];
+			U8* pWrite = payload;
 			for (spi_i = spi_bytes.begin() + 1; spi_i != spi_bytes.end(); ++spi_i)
-			{
-				if (use_miso)
-					mExtendedData.push_back(spi_i->mValMiso);
-				else
-					mExtendedData.push_back(spi_i->mValMosi);
-			}
+				*pWrite++ = (use_miso ? spi_i->mValMiso : spi_i->mValMosi);
+
+			U32 stream = nRFPayloadStore::GetStream(command_byte.mValMosi, command_byte.mValMiso);
+			frmData.mData1 = mExtendedData.Store(payload, U32(spi_bytes.size() - 1), stream);
+			frmData.mData2 = 0;
 
 			frmData.mFlags |= IS_EXTENDED;
 		}
@@ -238,10 +622,15 @@ bool nRF24L01_AnalyzerResults::CreateFramesFromSpiBytes(const std::vector<SpiByt
 		frmCmd.mFlags |= HAS_DATA_FRAME;
 	}
 
+	U8 first_data = 0;
+	if (spi_bytes.size() > 1)
+		first_data = (frmData.mFlags & IS_DATA_ON_MISO) ? spi_bytes[1].mValMiso : spi_bytes[1].mValMosi;
+
+	U64 cmd_frame_index;
 	if (spi_bytes.size() == 1)
 	{
 		frmCmd.mEndingSampleInclusive = csnHi;
-		AddFrame(frmCmd);
+		cmd_frame_index = AddFrame(frmCmd);
 	} else {
 		// extend the frame start/ends. makes the output a little nicer
 		U64 cmd_end		= frmCmd.mEndingSampleInclusive;
@@ -252,11 +641,105 @@ bool nRF24L01_AnalyzerResults::CreateFramesFromSpiBytes(const std::vector<SpiByt
 		frmData.mStartingSampleInclusive = middle;
 		frmData.mEndingSampleInclusive = csnHi;
 
-		AddFrame(frmCmd);
-		AddFrame(frmData);
+		cmd_frame_index = AddFrame(frmCmd);
+		U64 data_frame_index = AddFrame(frmData);
+
+		if (!mStreaming  &&  (GetCommandInfo(command_byte.mValMosi).mFlags & CMD_HAS_PAYLOAD))
+		{
+			U8 payload[32];
+			U32 length = 0;
+			for (spi_i = spi_bytes.begin() + 1; spi_i != spi_bytes.end(); ++spi_i)
+				payload[length++] = (frmData.mFlags & IS_DATA_ON_MISO) ? spi_i->mValMiso : spi_i->mValMosi;
+
+			mPayloadIndex.Add(data_frame_index, payload, length);
+		}
+
+		// registers are at most 5 bytes so they're always in mData1
+		if (!mStreaming  &&  (frmData.mFlags & IS_EXTENDED) == 0)
+			mRegisterShadows[radio].Update(cmd_frame_index, command_byte.mValMosi, (const U8*) &frmData.mData1, frmData.mType);
 	}
 
-	CommitResults();
+	U64 packet_id = CommitPacketAndStartNewPacket();
+	if (!mStreaming)
+	{
+		U64 operation_id = mOperations.Add(radio, command_byte.mValMosi, command_byte.mValMiso, first_data, U32(spi_bytes.size() - 1));
+		AddPacketToTransaction(operation_id, packet_id);
+
+		mSampleIndex.Add(cmd_frame_index, csnLow, csnHi);
+		mEventIndex.Add(cmd_frame_index, command_byte.mValMosi, command_byte.mValMiso, first_data, U32(spi_bytes.size() - 1));
+	}
+
+	mStatistics.Update(csnLow, csnHi, radio, command_byte.mValMosi, command_byte.mValMiso, first_data, U32(spi_bytes.size() - 1));
+
+	if (mPendingTransactions++ == 0)
+		mPendingStartSample = csnLow;
+	mPendingEndSample = csnHi;
 
 	return true;
 }
+
+// this many transactions are committed together while decoding is behind the capture
+#define COMMIT_BATCH_SIZE		4096
+
+void nRF24L01_AnalyzerResults::CommitIfNeeded(bool caught_up)
+{
+	if (mPendingTransactions == 0)
+		return;
+
+	if (caught_up
+			||  mPendingTransactions >= COMMIT_BATCH_SIZE
+			||  mPendingEndSample - mPendingStartSample >= mCommitSpan)
+	{
+		CommitResults();
+		mPendingTransactions = 0;
+
+		// the frames from here on are the ones that'll still be around after the drain
+		if (mStreaming)
+			mExtendedData.SetMark();
+	}
+}
+
+void nRF24L01_AnalyzerResults::ReleaseDrainedPayloads()
+{
+	if (mStreaming)
+		mExtendedData.ReleaseBeforeMark();
+}
+
+void nRF24L01_AnalyzerResults::AddMarkers(const SpiTransactionBuffer& spi_bytes, U64 csnLow, U64 csnHi, U8 radio)
+{
+	nRFMarkers_e markers = mSettings->mMarkers;
+	bool has_miso = mSettings->mMisoChannel != UNDEFINED_CHANNEL;
+	bool has_csn = mSettings->mCsnChannels[radio] != UNDEFINED_CHANNEL;
+
+	if (markers == MARKERS_SCK  ||  markers == MARKERS_FULL)
+	{
+		int num_bits;
+		const SpiByte* spi_i;
+		for (spi_i = spi_bytes.begin(); spi_i != spi_bytes.end(); ++spi_i)
+		{
+			for (num_bits = 0; num_bits < 8; ++num_bits)
+			{
+				U64 sample = spi_i->GetBitSample(num_bits);
+
+				AddMarker(sample, spi_i->GetMarkerSCK(num_bits), mSettings->mSckChannel);
+
+				if (markers == MARKERS_FULL)
+				{
+					AddMarker(sample, spi_i->GetMarkerMOSI(num_bits), mSettings->mMosiChannel);
+					if (has_miso)
+						AddMarker(sample, spi_i->GetMarkerMISO(num_bits), mSettings->mMisoChannel);
+				}
+			}
+		}
+
+		mMarkerCount += spi_bytes.size() * (markers == MARKERS_FULL ? (has_miso ? 24 : 16) : 8);
+	}
+
+	if (has_csn  &&  (markers == MARKERS_CSN  ||  markers == MARKERS_FULL))
+	{
+		AddMarker(csnLow, AnalyzerResults::Start, mSettings->mCsnChannels[radio]);
+		AddMarker(csnHi, AnalyzerResults::Stop, mSettings->mCsnChannels[radio]);
+
+		mMarkerCount += 2;
+	}
+}
@@ -2,15 +2,29 @@
 
 #include "utils.h"
 #include "nRF24L01_AnalyzerSettings.h"
+#include "nRFExportFilter.h"
+
+static const char* const CSN_NAMES[MAX_RADIOS] = {"CSN", "CSN 2", "CSN 3", "CSN 4"};
+
+const char* nRF24L01_AnalyzerSettings::GetCsnName(U32 radio)
+{
+	return CSN_NAMES[radio];
+}
 
 nRF24L01_AnalyzerSettings::nRF24L01_AnalyzerSettings()
 :	mMosiChannel( UNDEFINED_CHANNEL ),
 	mMisoChannel( UNDEFINED_CHANNEL ),
 	mSckChannel( UNDEFINED_CHANNEL ),
-	mCsnChannel( UNDEFINED_CHANNEL )/*,
-	mMarkBits(true),
-	mMarkStartEnd(true)	*/
+	mNumRadios( 1 ),
+	mDecoder( DECODER_BATCH ),
+	mMarkers( MARKERS_FULL ),
+	mSpiMode( SPI_MODE_AUTO ),
+	mPayloadRamMB( 256 ),
+	mSckIdleGapNs( 2000 )
 {
+	for (U32 radio = 0; radio < MAX_RADIOS; ++radio)
+		mCsnChannels[radio] = UNDEFINED_CHANNEL;
+
 	// init the interfaces
 	mMosiChannelInterface.SetTitleAndTooltip( "MOSI", "uC Out, nRF24L01 In" );
 	mMosiChannelInterface.SetChannel( mMosiChannel );
@@ -18,36 +32,85 @@ nRF24L01_AnalyzerSettings::nRF24L01_AnalyzerSettings()
 
 	mMisoChannelInterface.SetTitleAndTooltip( "MISO", "uC In, nRF24L01 Out" );
 	mMisoChannelInterface.SetChannel( mMisoChannel );
-	//mMisoChannelInterface.SetSelectionOfNoneIsAllowed( true );
+	mMisoChannelInterface.SetSelectionOfNoneIsAllowed( true );
 
 	mSckChannelInterface.SetTitleAndTooltip( "SCK", "Slave clock (SCK)" );
 	mSckChannelInterface.SetChannel( mSckChannel );
 
-	mCsnChannelInterface.SetTitleAndTooltip( "CSN", "Chip select NOT" );
-	mCsnChannelInterface.SetChannel( mCsnChannel );
-	//mCsnChannelInterface.SetSelectionOfNoneIsAllowed( true );
+	mCsnChannelInterfaces[0].SetTitleAndTooltip( "CSN", "Chip select NOT. Without it the transactions are told apart by the SCK idle gap." );
+	mCsnChannelInterfaces[0].SetChannel( mCsnChannels[0] );
+	mCsnChannelInterfaces[0].SetSelectionOfNoneIsAllowed( true );
+
+	// more radios on the same SCK, MOSI and MISO
+	for (U32 radio = 1; radio < MAX_RADIOS; ++radio)
+	{
+		mCsnChannelInterfaces[radio].SetTitleAndTooltip( CSN_NAMES[radio], "The CSN of another nRF24L01 on the same bus" );
+		mCsnChannelInterfaces[radio].SetChannel( mCsnChannels[radio] );
+		mCsnChannelInterfaces[radio].SetSelectionOfNoneIsAllowed( true );
+	}
+
+	mDecoderInterface.SetTitleAndTooltip( "Decoder", "How the SPI bits are sampled" );
+	mDecoderInterface.AddNumber( DECODER_BATCH, "Edge-list batch", "Collect the SCK edges of a transaction, then sample MOSI/MISO on them" );
+	mDecoderInterface.AddNumber( DECODER_PER_BIT, "Per-bit resync", "Advance all the channels on every SCK edge (slow)" );
+	mDecoderInterface.SetNumber( mDecoder );
+
+	// every bit gets 3 markers with MARKERS_FULL, which adds up on long captures
+	mMarkersInterface.SetTitleAndTooltip( "Markers", "Which markers to put on the channels" );
+	mMarkersInterface.AddNumber( MARKERS_FULL, "Full", "CSN start/stop, SCK edges and 0/1 on MOSI and MISO" );
+	mMarkersInterface.AddNumber( MARKERS_SCK, "SCK only", "Arrows on the sampling SCK edges" );
+	mMarkersInterface.AddNumber( MARKERS_CSN, "CSN only", "Command start/end on CSN" );
+	mMarkersInterface.AddNumber( MARKERS_NONE, "None", "No markers, uses the least memory" );
+	mMarkersInterface.SetNumber( mMarkers );
+
+	mSpiModeInterface.SetTitleAndTooltip( "SPI mode", "Clock polarity and phase" );
+	mSpiModeInterface.AddNumber( SPI_MODE_AUTO, "Auto", "Sample on the rising SCK edges, the first bit on the falling edge if SCK is high when CSN goes low" );
+	mSpiModeInterface.AddNumber( SPI_MODE_0, "Mode 0 (CPOL=0, CPHA=0)", "SCK idles low, sample on the rising edges. What the nRF24L01 uses." );
+	mSpiModeInterface.AddNumber( SPI_MODE_1, "Mode 1 (CPOL=0, CPHA=1)", "SCK idles low, sample on the falling edges" );
+	mSpiModeInterface.AddNumber( SPI_MODE_2, "Mode 2 (CPOL=1, CPHA=0)", "SCK idles high, sample on the falling edges" );
+	mSpiModeInterface.AddNumber( SPI_MODE_3, "Mode 3 (CPOL=1, CPHA=1)", "SCK idles high, sample on the rising edges" );
+	mSpiModeInterface.SetNumber( mSpiMode );
+
+	mPayloadRamMBInterface.SetTitleAndTooltip( "Payload RAM (MB)", "Payloads longer than 16 bytes above this go to a temp file. 0 for no limit." );
+	mPayloadRamMBInterface.SetMin( 0 );
+	mPayloadRamMBInterface.SetMax( 65536 );
+	mPayloadRamMBInterface.SetInteger( mPayloadRamMB );
 
-	//mMarkBitsInterface.SetCheckBoxText("Mark 0/1 on MOSI and MISO");
-	//mMarkStartEndInterface.SetCheckBoxText("Mark command start/end on CSN");
+	mSckIdleGapNsInterface.SetTitleAndTooltip( "SCK idle gap (ns)", "Without CSN, a pause of SCK this long ends a transaction. Has to be longer than the pauses between the bytes." );
+	mSckIdleGapNsInterface.SetMin( 1 );
+	mSckIdleGapNsInterface.SetMax( 100000000 );
+	mSckIdleGapNsInterface.SetInteger( mSckIdleGapNs );
+
+	mExportFilterInterface.SetTitleAndTooltip( "Export filter", "For the filtered export, e.g. W_TX_PAYLOAD and MAX_RT, reg=RF_CH, pipe=1, data has 0xA5A5, time>=0.5" );
+	mExportFilterInterface.SetText( mExportFilter.c_str() );
 
 	// add the interfaces
 	AddInterface( &mMosiChannelInterface );
 	AddInterface( &mMisoChannelInterface );
 	AddInterface( &mSckChannelInterface );
-	AddInterface( &mCsnChannelInterface );
-	//AddInterface( &mMarkBitsInterface );
-	//AddInterface( &mMarkStartEndInterface );
+	for (U32 radio = 0; radio < MAX_RADIOS; ++radio)
+		AddInterface( &mCsnChannelInterfaces[radio] );
+	AddInterface( &mDecoderInterface );
+	AddInterface( &mMarkersInterface );
+	AddInterface( &mSpiModeInterface );
+	AddInterface( &mPayloadRamMBInterface );
+	AddInterface( &mSckIdleGapNsInterface );
+	AddInterface( &mExportFilterInterface );
 
-	AddExportOption( 0, "Export as text/csv file" );
-	AddExportExtension( 0, "text", "txt" );
-	AddExportExtension( 0, "csv", "csv" );
+	AddExportOption( EXPORT_TEXT, "Export as text/csv file" );
+	AddExportExtension( EXPORT_TEXT, "text", "txt" );
+	AddExportExtension( EXPORT_TEXT, "csv", "csv" );
 
-	ClearChannels();
+	AddExportOption( EXPORT_BINARY, "Export as binary columns" );
+	AddExportExtension( EXPORT_BINARY, "nRF24 binary columns", "nrfbin" );
+
+	AddExportOption( EXPORT_STATISTICS, "Export statistics" );
+	AddExportExtension( EXPORT_STATISTICS, "csv", "csv" );
 
-	AddChannel( mMosiChannel,	"MOSI",	false );
-	AddChannel( mMisoChannel,	"MISO",	false );
-	AddChannel( mSckChannel,	"SCK",	false );
-	AddChannel( mCsnChannel,	"CSN",	false );
+	AddExportOption( EXPORT_FILTERED, "Export as text/csv file, filtered" );
+	AddExportExtension( EXPORT_FILTERED, "text", "txt" );
+	AddExportExtension( EXPORT_FILTERED, "csv", "csv" );
+
+	AddChannels( false );
 }
 
 nRF24L01_AnalyzerSettings::~nRF24L01_AnalyzerSettings()
@@ -58,52 +121,101 @@ bool nRF24L01_AnalyzerSettings::SetSettingsFromInterfaces()
 {
 	const int NUM_CHANNELS = 4;
 
-	Channel	all_channels[NUM_CHANNELS] = {mMosiChannelInterface.GetChannel(),
-											mMisoChannelInterface.GetChannel(),
-											mSckChannelInterface.GetChannel(),
-											mCsnChannelInterface.GetChannel()};
+	Channel	all_channels[NUM_CHANNELS + MAX_RADIOS - 1] = {mMosiChannelInterface.GetChannel(),
+															mMisoChannelInterface.GetChannel(),
+															mSckChannelInterface.GetChannel(),
+															mCsnChannelInterfaces[0].GetChannel()};
 
-	for (int ch = 0; ch < NUM_CHANNELS; ++ch)
+	if (all_channels[0] == UNDEFINED_CHANNEL  ||  all_channels[2] == UNDEFINED_CHANNEL)
 	{
-		if (all_channels[ch] == UNDEFINED_CHANNEL)
-		{
-			SetErrorText( "Please select inputs for all channels." );
-			return false;
-		}
+		SetErrorText( "Please select inputs for MOSI and SCK." );
+		return false;
 	}
 
-	if ( AnalyzerHelpers::DoChannelsOverlap(all_channels, 4) )
+	// the other radios' CSNs are optional, the ones that are set go after the first
+	U32 num_radios = 1;
+	for (U32 radio = 1; radio < MAX_RADIOS; ++radio)
+	{
+		Channel csn = mCsnChannelInterfaces[radio].GetChannel();
+		if (csn != UNDEFINED_CHANNEL)
+			all_channels[NUM_CHANNELS - 1 + num_radios++] = csn;
+	}
+
+	if (num_radios > 1  &&  all_channels[3] == UNDEFINED_CHANNEL)
+	{
+		SetErrorText( "The other radios' CSNs need the first CSN too." );
+		return false;
+	}
+
+	// MISO and CSN can both be unset, that's no overlap
+	Channel used_channels[NUM_CHANNELS + MAX_RADIOS - 1];
+	U32 num_used = 0;
+	for (U32 ch = 0; ch < NUM_CHANNELS - 1 + num_radios; ++ch)
+	{
+		if (all_channels[ch] != UNDEFINED_CHANNEL)
+			used_channels[num_used++] = all_channels[ch];
+	}
+
+	if ( AnalyzerHelpers::DoChannelsOverlap(used_channels, num_used) )
 	{
 		SetErrorText( "Please select different channels for each input." );
 		return false;
 	}
 
+	nRFExportFilter filter;
+	std::string error;
+	if (!filter.Compile(mExportFilterInterface.GetText(), error))
+	{
+		mErrorText = "Export filter: " + error;
+		SetErrorText( mErrorText.c_str() );
+		return false;
+	}
+
 	mMosiChannel = all_channels[0];
 	mMisoChannel = all_channels[1];
 	mSckChannel = all_channels[2];
-	mCsnChannel = all_channels[3];
+	for (U32 radio = 0; radio < MAX_RADIOS; ++radio)
+		mCsnChannels[radio] = radio < num_radios ? all_channels[NUM_CHANNELS - 1 + radio] : UNDEFINED_CHANNEL;
+	mNumRadios = num_radios;
 
-	ClearChannels();
+	mDecoder = nRFDecoder_e( U32( mDecoderInterface.GetNumber() ) );
+	mMarkers = nRFMarkers_e( U32( mMarkersInterface.GetNumber() ) );
+	mSpiMode = nRFSpiMode_e( U32( mSpiModeInterface.GetNumber() ) );
+	mPayloadRamMB = U32( mPayloadRamMBInterface.GetInteger() );
+	mSckIdleGapNs = U32( mSckIdleGapNsInterface.GetInteger() );
+	mExportFilter = mExportFilterInterface.GetText();
 
-	AddChannel( mMosiChannel,	"MOSI",	true );
-	AddChannel( mMisoChannel,	"MISO",	true );
-	AddChannel( mSckChannel,	"SCK",	true );
-	AddChannel( mCsnChannel,	"CSN",	true );
-
-	//mMarkBits = mMarkBitsInterface.GetValue();
-	//mMarkStartEnd = mMarkStartEndInterface.GetValue();
+	AddChannels( true );
 
 	return true;
 }
 
+void nRF24L01_AnalyzerSettings::AddChannels(bool is_used)
+{
+	ClearChannels();
+
+	AddChannel( mMosiChannel,	"MOSI",	is_used );
+	AddChannel( mMisoChannel,	"MISO",	is_used  &&  mMisoChannel != UNDEFINED_CHANNEL );
+	AddChannel( mSckChannel,	"SCK",	is_used );
+	AddChannel( mCsnChannels[0],	"CSN",	is_used  &&  mCsnChannels[0] != UNDEFINED_CHANNEL );
+
+	for (U32 radio = 1; radio < mNumRadios; ++radio)
+		AddChannel( mCsnChannels[radio],	CSN_NAMES[radio],	is_used );
+}
+
 void nRF24L01_AnalyzerSettings::UpdateInterfacesFromSettings()
 {
 	mMosiChannelInterface.SetChannel(mMosiChannel);
 	mMisoChannelInterface.SetChannel(mMisoChannel);
 	mSckChannelInterface.SetChannel(mSckChannel);
-	mCsnChannelInterface.SetChannel(mCsnChannel);
-	//mMarkBitsInterface.SetValue(mMarkBits);
-	//mMarkStartEndInterface.SetValue(mMarkStartEnd);
+	for (U32 radio = 0; radio < MAX_RADIOS; ++radio)
+		mCsnChannelInterfaces[radio].SetChannel(mCsnChannels[radio]);
+	mDecoderInterface.SetNumber(mDecoder);
+	mMarkersInterface.SetNumber(mMarkers);
+	mSpiModeInterface.SetNumber(mSpiMode);
+	mPayloadRamMBInterface.SetInteger(mPayloadRamMB);
+	mSckIdleGapNsInterface.SetInteger(mSckIdleGapNs);
+	mExportFilterInterface.SetText(mExportFilter.c_str());
 }
 
 void nRF24L01_AnalyzerSettings::LoadSettings( const char* settings )
@@ -114,16 +226,40 @@ void nRF24L01_AnalyzerSettings::LoadSettings( const char* settings )
 	text_archive >> mMosiChannel;
 	text_archive >> mMisoChannel;
 	text_archive >> mSckChannel;
-	text_archive >> mCsnChannel;
-	//text_archive >> mMarkBits;
-	//text_archive >> mMarkStartEnd;
+	text_archive >> mCsnChannels[0];
 
-	ClearChannels();
+	// not there in settings saved by older versions
+	U32 decoder, markers;
+	if (text_archive >> decoder)
+		mDecoder = nRFDecoder_e(decoder);
+	if (text_archive >> markers)
+		mMarkers = nRFMarkers_e(markers);
+	U32 payload_ram_mb;
+	if (text_archive >> payload_ram_mb)
+		mPayloadRamMB = payload_ram_mb;
+	const char* filter;
+	if (text_archive >> &filter)
+		mExportFilter = filter;
+	U32 spi_mode;
+	if (text_archive >> spi_mode)
+		mSpiMode = nRFSpiMode_e(spi_mode);
+
+	U32 num_radios;
+	mNumRadios = 1;
+	if (text_archive >> num_radios)
+	{
+		for (; mNumRadios < num_radios  &&  mNumRadios < MAX_RADIOS; ++mNumRadios)
+			text_archive >> mCsnChannels[mNumRadios];
+	}
+
+	for (U32 radio = mNumRadios; radio < MAX_RADIOS; ++radio)
+		mCsnChannels[radio] = UNDEFINED_CHANNEL;
+
+	U32 sck_idle_gap;
+	if (text_archive >> sck_idle_gap)
+		mSckIdleGapNs = sck_idle_gap;
 
-	AddChannel( mMosiChannel,	"MOSI",	true );
-	AddChannel( mMisoChannel,	"MISO",	true );
-	AddChannel( mSckChannel,	"SCK",	true );
-	AddChannel( mCsnChannel,	"CSN",	true );
+	AddChannels( true );
 
 	UpdateInterfacesFromSettings();
 }
@@ -135,9 +271,16 @@ const char* nRF24L01_AnalyzerSettings::SaveSettings()
 	text_archive << mMosiChannel;
 	text_archive << mMisoChannel;
 	text_archive << mSckChannel;
-	text_archive << mCsnChannel;
-	//text_archive << mMarkBits;
-	//text_archive << mMarkStartEnd;
+	text_archive << mCsnChannels[0];
+	text_archive << U32(mDecoder);
+	text_archive << U32(mMarkers);
+	text_archive << mPayloadRamMB;
+	text_archive << mExportFilter.c_str();
+	text_archive << U32(mSpiMode);
+	text_archive << mNumRadios;
+	for (U32 radio = 1; radio < mNumRadios; ++radio)
+		text_archive << mCsnChannels[radio];
+	text_archive << mSckIdleGapNs;
 
 	return SetReturnString( text_archive.GetString() );
 }
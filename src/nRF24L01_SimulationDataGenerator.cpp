@@ -7,6 +7,9 @@
 #define SPACE_CYCLE			48
 
 nRF24L01_SimulationDataGenerator::nRF24L01_SimulationDataGenerator()
+:	mSequence(0),
+	mRadio(0),
+	mOversizeBursts(false)
 {
 }
 
@@ -31,12 +34,18 @@ void nRF24L01_SimulationDataGenerator::Initialize(U32 simulation_sample_rate, nR
 	else
 		mMosi = NULL;
 
-	mSck = mSpiSimulationChannels.Add(settings->mSckChannel, mSimulationSampleRateHz, BIT_LOW);
+	// SPI_MODE_AUTO gets mode 0
+	mSck = mSpiSimulationChannels.Add(settings->mSckChannel, mSimulationSampleRateHz, SpiIdlesHigh(settings->mSpiMode) ? BIT_HIGH : BIT_LOW);
 
-	if (settings->mCsnChannel != UNDEFINED_CHANNEL)
-		mCsn = mSpiSimulationChannels.Add(settings->mCsnChannel, mSimulationSampleRateHz, BIT_HIGH);
-	else
-		mCsn = NULL;
+	for (U32 radio = 0; radio < settings->mNumRadios; ++radio)
+	{
+		if (settings->mCsnChannels[radio] != UNDEFINED_CHANNEL)
+			mCsns[radio] = mSpiSimulationChannels.Add(settings->mCsnChannels[radio], mSimulationSampleRateHz, BIT_HIGH);
+		else
+			mCsns[radio] = NULL;
+	}
+
+	mCsn = mCsns[0];
 
 	mSpiSimulationChannels.AdvanceAll(mClockGenerator.AdvanceByHalfPeriod(10));			// insert 10 bit-periods of idle
 }
@@ -57,6 +66,10 @@ void nRF24L01_SimulationDataGenerator::CreateNRFTransaction()
 {
 	int c;
 
+	// with more radios on the bus they take turns, a cycle each
+	mCsn = mCsns[mRadio];
+	mRadio = (mRadio + 1) % mSettings->mNumRadios;
+
 	if (mCsn != NULL)
 		mCsn->Transition();
 
@@ -114,12 +127,22 @@ void nRF24L01_SimulationDataGenerator::CreateNRFTransaction()
 
 	NewCommand();
 
+	OutputWord(0x27, 0x40);		// W_REGISTER STATUS
+	OutputWord(0x40, 0x00);		// clear RX_DR
+
+	NewCommand();
+
 	// switch to TX mode
 	OutputWord(0x20, 0x0E);		// W_REGISTER CONFIG
 	OutputWord(0x0E, 0x00);		// EN_CRC | CRC0 | PWR_UP
 
 	NewCommand();
 
+	OutputWord(0x25, 0x0E);		// W_REGISTER RF_CH
+	OutputWord(2 + mSequence % 80, 0x00);	// hop to another channel every cycle
+
+	NewCommand();
+
 	OutputWord(0xE1, 0x0E);		// FLUSH_TX
 
 	NewCommand();
@@ -138,11 +161,48 @@ void nRF24L01_SimulationDataGenerator::CreateNRFTransaction()
 	for (c = 0; c < 6; c++)
 		OutputWord(10 + c, 0x00);
 
+	NewCommand();
+
+	// a full 32 byte payload, longer than what fits into a Frame
+	OutputWord(0xA0, 0x0E);		// W_TX_PAYLOAD
+	OutputWord(mSequence++, 0x00);
+	for (c = 1; c < 32; c++)
+		OutputWord(0x20 + c, 0x00);
+
+	// wait for the ACK
+	for (c = 0; c < 3; c++)
+	{
+		NewCommand();
+		OutputWord(0xFF, c < 2 ? 0x0E : 0x2E);		// NOP, until TX_DS
+	}
+
+	NewCommand();
+
+	OutputWord(0x08, 0x2E);		// R_REGISTER OBSERVE_TX
+	OutputWord(0x00, mSequence % 4);	// a few retransmits
+
+	NewCommand();
+
+	OutputWord(0x27, 0x2E);		// W_REGISTER STATUS
+	OutputWord(0x20, 0x00);		// clear TX_DS
+
+	// now and then CSN stays low while the MCU reads from an SD card on the same bus
+	if (mOversizeBursts  &&  mSequence % 16 == 0)
+	{
+		NewCommand();
+
+		OutputWord(0x51, 0xFF);		// CMD17 READ_SINGLE_BLOCK
+		for (c = 0; c < 64; c++)
+			OutputWord(0xFF, U8(c * 7));
+	}
 
 	if (mCsn != NULL)
 		mCsn->Transition();
 
 	mSpiSimulationChannels.AdvanceAll(mClockGenerator.AdvanceByHalfPeriod(SPACE_CYCLE));
+
+	if (mCsn == NULL)
+		mSpiSimulationChannels.AdvanceAll(mClockGenerator.AdvanceByTimeS(mSettings->mSckIdleGapNs * 2e-9));
 }
 
 void nRF24L01_SimulationDataGenerator::NewCommand()
@@ -154,6 +214,10 @@ void nRF24L01_SimulationDataGenerator::NewCommand()
 	// a short pause
 	mSpiSimulationChannels.AdvanceAll(mClockGenerator.AdvanceByHalfPeriod(SPACE_COMMAND));
 
+	// without CSN only a longer one tells the commands apart
+	if (mCsn == NULL)
+		mSpiSimulationChannels.AdvanceAll(mClockGenerator.AdvanceByTimeS(mSettings->mSckIdleGapNs * 2e-9));
+
 	// CSN goes low
 	if (mCsn != NULL)
 		mCsn->Transition();
@@ -164,9 +228,15 @@ void nRF24L01_SimulationDataGenerator::OutputWord(U64 mosi_data, U64 miso_data)
 	BitExtractor mosi_bits(mosi_data, AnalyzerEnums::MsbFirst, 8);
 	BitExtractor miso_bits(miso_data, AnalyzerEnums::MsbFirst, 8);
 
+	// with CPHA=1 the data changes on the leading edge and is sampled on the trailing one
+	bool cpha = !SpiSamplesOnLeadingEdge(mSettings->mSpiMode);
+
 	U32 count = 8;
 	for (U32 i = 0; i < count; i++)
 	{
+		if (cpha)
+			mSck->Transition();
+
 		if (mMosi != NULL)
 			mMosi->TransitionIfNeeded(mosi_bits.GetNextBit());
 
@@ -177,7 +247,8 @@ void nRF24L01_SimulationDataGenerator::OutputWord(U64 mosi_data, U64 miso_data)
 		mSck->Transition();  //data valid
 
 		mSpiSimulationChannels.AdvanceAll( mClockGenerator.AdvanceByHalfPeriod(.5));
-		mSck->Transition();  //data invalid
+		if (!cpha)
+			mSck->Transition();  //data invalid
 	}
 
 	if (mMosi != NULL)
@@ -0,0 +1,212 @@
+#ifdef _WINDOWS
+# include <windows.h>
+#else
+# include <fcntl.h>
+# include <unistd.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+#endif
+
+#include <cstring>
+
+#include "nRFBinaryReader.h"
+#include "nRFTables.h"
+
+// stands in for the header until a file is open
+static const nRFBinaryHeader EMPTY_HEADER = {};
+
+nRFBinaryReader::nRFBinaryReader()
+:	mData(NULL),
+	mSize(0),
+	mHeader(&EMPTY_HEADER)
+#ifdef _WINDOWS
+	, mFile(INVALID_HANDLE_VALUE),
+	mMapping(NULL)
+#endif
+{}
+
+nRFBinaryReader::~nRFBinaryReader()
+{
+	Close();
+}
+
+#ifdef _WINDOWS
+
+bool nRFBinaryReader::Open(const char* file_name)
+{
+	Close();
+
+	mFile = ::CreateFileA(file_name, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (mFile == INVALID_HANDLE_VALUE)
+	{
+		mError = "can't open the file";
+		return false;
+	}
+
+	LARGE_INTEGER size;
+	if (!::GetFileSizeEx(mFile, &size)  ||  size.QuadPart == 0)
+	{
+		mError = "the file is empty";
+		Close();
+		return false;
+	}
+
+	mMapping = ::CreateFileMappingA(mFile, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mMapping != NULL)
+		mData = (const U8*) ::MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0);
+
+	if (mData == NULL)
+	{
+		mError = "can't map the file";
+		Close();
+		return false;
+	}
+
+	mSize = U64(size.QuadPart);
+
+	return Validate();
+}
+
+void nRFBinaryReader::Close()
+{
+	if (mData != NULL)
+		::UnmapViewOfFile(mData);
+	if (mMapping != NULL)
+		::CloseHandle(mMapping);
+	if (mFile != INVALID_HANDLE_VALUE)
+		::CloseHandle(mFile);
+
+	mData = NULL;
+	mMapping = NULL;
+	mFile = INVALID_HANDLE_VALUE;
+	mSize = 0;
+	mHeader = &EMPTY_HEADER;
+}
+
+#else
+
+bool nRFBinaryReader::Open(const char* file_name)
+{
+	Close();
+
+	int fd = ::open(file_name, O_RDONLY);
+	if (fd == -1)
+	{
+		mError = "can't open the file";
+		return false;
+	}
+
+	struct stat st;
+	if (::fstat(fd, &st) != 0  ||  st.st_size == 0)
+	{
+		mError = "the file is empty";
+		::close(fd);
+		return false;
+	}
+
+	// the mapping stays valid after the descriptor is closed
+	void* data = ::mmap(NULL, size_t(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+	::close(fd);
+
+	if (data == MAP_FAILED)
+	{
+		mError = "can't map the file";
+		return false;
+	}
+
+	mData = (const U8*) data;
+	mSize = U64(st.st_size);
+
+	return Validate();
+}
+
+void nRFBinaryReader::Close()
+{
+	if (mData != NULL)
+		::munmap((void*) mData, size_t(mSize));
+
+	mData = NULL;
+	mSize = 0;
+	mHeader = &EMPTY_HEADER;
+}
+
+#endif
+
+bool nRFBinaryReader::Validate()
+{
+	const nRFBinaryHeader* header = (const nRFBinaryHeader*) mData;
+
+	if (mSize < sizeof(nRFBinaryHeader)  ||  ::memcmp(header->mMagic, NRF_BINARY_MAGIC, sizeof(header->mMagic)) != 0)
+		mError = "not an nRF24L01 binary export";
+	else if (header->mByteOrder == 0x0807060504030201ULL)
+		mError = "the binary export was written on a machine with the other byte order";
+	else if (header->mByteOrder != NRF_BINARY_BYTE_ORDER  ||  header->mVersion != NRF_BINARY_VERSION
+				||  header->mHeaderSize != sizeof(nRFBinaryHeader))
+		mError = "unsupported version of the binary export";
+	else if (header->mSampleRate == 0)
+		mError = "the sample rate is missing";
+	else if (header->mNumRows > mSize / sizeof(U64))
+		mError = "the file is truncated or damaged";		// and the sizes below would wrap
+	else
+		mError.clear();
+
+	// every section has to be in the file, the header is only read once it's known to be there
+	if (mError.empty())
+	{
+		struct Section
+		{
+			U64		mOffset;
+			U64		mSize;
+		} sections[] = {
+			{header->mSampleColumn,		header->mNumRows * sizeof(U64)},
+			{header->mCommandColumn,	header->mNumRows},
+			{header->mStatusColumn,		header->mNumRows},
+			{header->mRegisterColumn,	header->mNumRows},
+			{header->mLengthColumn,		header->mNumRows},
+			{header->mRadioColumn,		header->mNumRows},
+			{header->mPayloadColumn,	header->mNumRows * sizeof(U64)},
+			{header->mPayloadBlob,		header->mPayloadBytes},
+		};
+
+		for (size_t c = 0; mError.empty()  &&  c < sizeof(sections) / sizeof(sections[0]); ++c)
+		{
+			const Section& section = sections[c];
+			if (section.mSize > 0
+					&&  (section.mOffset % NRF_BINARY_ALIGN != 0  ||  section.mOffset > mSize  ||  section.mSize > mSize - section.mOffset))
+				mError = "the file is truncated or damaged";
+		}
+	}
+
+	if (!mError.empty())
+	{
+		std::string error;
+		error.swap(mError);
+		Close();
+		mError.swap(error);
+		return false;
+	}
+
+	mHeader = header;
+	return true;
+}
+
+void nRFBinaryReader::GetCommand(U64 row, nRFCommand& cmd) const
+{
+	cmd.mCommandByte = GetCommandBytes()[row];
+	cmd.mStatus = GetStatuses()[row];
+	cmd.mRadio = GetRadios()[row];
+
+	const nRFCommandInfo& info = GetCommandInfo(cmd.mCommandByte);
+	cmd.mCommand = nRFCommand_e(info.mCommand);
+	cmd.mRegister = nRFRegister_e(GetRegisters()[row]);
+
+	// don't read past the payloads if the file is damaged
+	U8 length = GetLengths()[row];
+	U64 offset = GetPayloadOffsets()[row];
+	if (length > sizeof(cmd.mData)  ||  offset > mHeader->mPayloadBytes  ||  length > mHeader->mPayloadBytes - offset)
+		length = 0;
+
+	cmd.mDataLength = length;
+	::memcpy(cmd.mData, GetPayload(row), length);
+	::memset(cmd.mData + length, 0, sizeof(cmd.mData) - length);
+}
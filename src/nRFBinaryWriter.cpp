@@ -0,0 +1,184 @@
+#include <cstring>
+#include <memory>
+
+#include "nRFBinaryWriter.h"
+
+nRFBinaryWriter::nRFBinaryWriter(std::ostream& out, U64 num_rows, U64 sample_rate, U64 trigger_sample)
+:	mOut(out),
+	mRowsWritten(0),
+	mSpooling(false),
+	mSpoolFailed(false)
+{
+	Init(sample_rate, trigger_sample);
+
+	nRFBinaryLayout(mHeader, num_rows);
+}
+
+nRFBinaryWriter::nRFBinaryWriter(std::ostream& out, U64 sample_rate, U64 trigger_sample)
+:	mOut(out),
+	mRowsWritten(0),
+	mSpooling(true),
+	mSpoolFailed(false)
+{
+	Init(sample_rate, trigger_sample);
+
+	// laid out by Finish()
+	for (int spool = 0; spool < NUM_SPOOLS; ++spool)
+	{
+		mSpools[spool] = ::tmpfile();
+		if (mSpools[spool] == NULL)
+			mSpoolFailed = true;
+	}
+}
+
+nRFBinaryWriter::~nRFBinaryWriter()
+{
+	if (mSpooling)
+	{
+		for (int spool = 0; spool < NUM_SPOOLS; ++spool)
+		{
+			if (mSpools[spool] != NULL)
+				::fclose(mSpools[spool]);
+		}
+	}
+}
+
+void nRFBinaryWriter::Init(U64 sample_rate, U64 trigger_sample)
+{
+	::memset(&mHeader, 0, sizeof(mHeader));
+	::memcpy(mHeader.mMagic, NRF_BINARY_MAGIC, sizeof(mHeader.mMagic));
+	mHeader.mByteOrder = NRF_BINARY_BYTE_ORDER;
+	mHeader.mVersion = NRF_BINARY_VERSION;
+	mHeader.mHeaderSize = sizeof(mHeader);
+	mHeader.mSampleRate = sample_rate;
+	mHeader.mTriggerSample = trigger_sample;
+}
+
+void nRFBinaryWriter::AddRow(U64 starting_sample, const nRFCommand& cmd)
+{
+	mSamples.push_back(starting_sample);
+	mCommands.push_back(cmd.mCommandByte);
+	mStatuses.push_back(cmd.mStatus);
+	mRegisters.push_back(U8(cmd.mRegister));
+	mLengths.push_back(cmd.mDataLength);
+	mRadios.push_back(cmd.mRadio);
+	mPayloadOffsets.push_back(mHeader.mPayloadBytes + mPayloads.size());
+	mPayloads.insert(mPayloads.end(), cmd.mData, cmd.mData + cmd.mDataLength);
+
+	if (mSamples.size() >= CHUNK_ROWS)
+		Flush();
+}
+
+void nRFBinaryWriter::WriteAt(U64 offset, const void* data, size_t size)
+{
+	if (size == 0)
+		return;
+
+	mOut.seekp(std::streamoff(offset));
+	mOut.write((const char*) data, std::streamsize(size));
+}
+
+bool nRFBinaryWriter::Spool(int spool, const void* data, size_t size)
+{
+	if (mSpoolFailed  ||  (size > 0  &&  ::fwrite(data, 1, size, mSpools[spool]) != size))
+		mSpoolFailed = true;
+
+	return !mSpoolFailed;
+}
+
+bool nRFBinaryWriter::CopySpool(int spool, U64 offset)
+{
+	const size_t BLOCK_SIZE = 1 << 20;
+	std::unique_ptr<char[]> block(new char[BLOCK_SIZE]);
+
+	FILE* file = mSpools[spool];
+	if (::fflush(file) != 0  ||  ::fseek(file, 0, SEEK_SET) != 0)
+		return false;
+
+	mOut.seekp(std::streamoff(offset));
+
+	size_t read;
+	while ((read = ::fread(block.get(), 1, BLOCK_SIZE, file)) > 0)
+		mOut.write(block.get(), std::streamsize(read));
+
+	return ::ferror(file) == 0  &&  !mOut.fail();
+}
+
+bool nRFBinaryWriter::Flush()
+{
+	if (mSpooling)
+	{
+		Spool(SPOOL_SAMPLES, mSamples.data(), mSamples.size() * sizeof(U64));
+		Spool(SPOOL_COMMANDS, mCommands.data(), mCommands.size());
+		Spool(SPOOL_STATUSES, mStatuses.data(), mStatuses.size());
+		Spool(SPOOL_REGISTERS, mRegisters.data(), mRegisters.size());
+		Spool(SPOOL_LENGTHS, mLengths.data(), mLengths.size());
+		Spool(SPOOL_RADIOS, mRadios.data(), mRadios.size());
+		Spool(SPOOL_PAYLOAD_OFFSETS, mPayloadOffsets.data(), mPayloadOffsets.size() * sizeof(U64));
+		Spool(SPOOL_PAYLOADS, mPayloads.data(), mPayloads.size());
+	} else {
+		// more rows than we said there would be
+		if (mRowsWritten + mSamples.size() > mHeader.mNumRows)
+			return false;
+
+		U64 row = mRowsWritten;
+
+		WriteAt(mHeader.mSampleColumn + row * sizeof(U64), mSamples.data(), mSamples.size() * sizeof(U64));
+		WriteAt(mHeader.mCommandColumn + row, mCommands.data(), mCommands.size());
+		WriteAt(mHeader.mStatusColumn + row, mStatuses.data(), mStatuses.size());
+		WriteAt(mHeader.mRegisterColumn + row, mRegisters.data(), mRegisters.size());
+		WriteAt(mHeader.mLengthColumn + row, mLengths.data(), mLengths.size());
+		WriteAt(mHeader.mRadioColumn + row, mRadios.data(), mRadios.size());
+		WriteAt(mHeader.mPayloadColumn + row * sizeof(U64), mPayloadOffsets.data(), mPayloadOffsets.size() * sizeof(U64));
+		WriteAt(mHeader.mPayloadBlob + mHeader.mPayloadBytes, mPayloads.data(), mPayloads.size());
+	}
+
+	mRowsWritten += mSamples.size();
+	mHeader.mPayloadBytes += mPayloads.size();
+
+	mSamples.clear();
+	mCommands.clear();
+	mStatuses.clear();
+	mRegisters.clear();
+	mLengths.clear();
+	mRadios.clear();
+	mPayloadOffsets.clear();
+	mPayloads.clear();
+
+	return !mOut.fail()  &&  !mSpoolFailed;
+}
+
+bool nRFBinaryWriter::Finish()
+{
+	if (!Flush())
+		return false;
+
+	// now we know where the columns go
+	if (mSpooling)
+	{
+		nRFBinaryLayout(mHeader, mRowsWritten);
+
+		if (!CopySpool(SPOOL_SAMPLES, mHeader.mSampleColumn)
+				||  !CopySpool(SPOOL_COMMANDS, mHeader.mCommandColumn)
+				||  !CopySpool(SPOOL_STATUSES, mHeader.mStatusColumn)
+				||  !CopySpool(SPOOL_REGISTERS, mHeader.mRegisterColumn)
+				||  !CopySpool(SPOOL_LENGTHS, mHeader.mLengthColumn)
+				||  !CopySpool(SPOOL_RADIOS, mHeader.mRadioColumn)
+				||  !CopySpool(SPOOL_PAYLOAD_OFFSETS, mHeader.mPayloadColumn)
+				||  !CopySpool(SPOOL_PAYLOADS, mHeader.mPayloadBlob))
+			return false;
+	}
+
+	// fewer rows than expected, probably cancelled; shrink the header so the file stays valid
+	if (mRowsWritten < mHeader.mNumRows)
+	{
+		nRFBinaryHeader written = mHeader;
+		written.mNumRows = mRowsWritten;
+		WriteAt(0, &written, sizeof(written));
+	} else {
+		WriteAt(0, &mHeader, sizeof(mHeader));
+	}
+
+	mOut.flush();
+	return !mOut.fail();
+}
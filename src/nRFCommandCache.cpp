@@ -0,0 +1,66 @@
+#include "nRFCommandCache.h"
+
+nRFCommandCache::nRFCommandCache()
+:	mHits(0),
+	mMisses(0)
+{
+	Clear();
+}
+
+bool nRFCommandCache::Find(U64 cmd_frame_index, nRFCommand& cmd)
+{
+	Shard& shard = GetShard(cmd_frame_index);
+	std::lock_guard<std::mutex> lock(shard.mLock);
+
+	Set& set = GetSet(shard, cmd_frame_index);
+	int way = FindWay(set, cmd_frame_index);
+	if (way == -1)
+	{
+		++mMisses;
+		return false;
+	}
+
+	set.mLastUsed[way] = ++shard.mTick;
+	cmd = set.mCommand[way];
+	++mHits;
+
+	return true;
+}
+
+void nRFCommandCache::Insert(U64 cmd_frame_index, const nRFCommand& cmd)
+{
+	Shard& shard = GetShard(cmd_frame_index);
+	std::lock_guard<std::mutex> lock(shard.mLock);
+
+	// replace the least recently used entry, unless someone beat us to it
+	Set& set = GetSet(shard, cmd_frame_index);
+	int way = FindWay(set, cmd_frame_index);
+	if (way == -1)
+	{
+		way = 0;
+		for (int c = 1; c < NUM_WAYS; ++c)
+		{
+			if (set.mLastUsed[c] < set.mLastUsed[way])
+				way = c;
+		}
+	}
+
+	set.mFrameIndex[way] = cmd_frame_index;
+	set.mLastUsed[way] = ++shard.mTick;
+	set.mCommand[way] = cmd;
+}
+
+void nRFCommandCache::Clear()
+{
+	for (Shard* shard = mShards; shard != mShards + NUM_SHARDS; ++shard)
+	{
+		std::lock_guard<std::mutex> lock(shard->mLock);
+
+		shard->mTick = 0;
+		for (Set* set = shard->mSets; set != shard->mSets + NUM_SETS; ++set)
+		{
+			for (int way = 0; way < NUM_WAYS; ++way)
+				set->mLastUsed[way] = 0;
+		}
+	}
+}
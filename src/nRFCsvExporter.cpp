@@ -0,0 +1,159 @@
+#include <AnalyzerHelpers.h>
+
+#include "nRFCsvExporter.h"
+
+nRFCsvExporter::nRFCsvExporter(DisplayBase display_base, U64 trigger_sample, U32 sample_rate, bool csn_column)
+:	mDisplayBase(display_base),
+	mTriggerSample(trigger_sample),
+	mSampleRate(sample_rate),
+	mCsnColumn(csn_column),
+	mCancelled(false),
+	mStopping(false)
+{}
+
+U64 nRFCsvExporter::Export(std::ostream& out, const ReadRowsFn& read_rows, const ProgressFn& progress)
+{
+	// the calling thread reads the frames and writes the file, the rest of the cores format
+	unsigned num_workers = std::thread::hardware_concurrency();
+	num_workers = num_workers > 1 ? num_workers - 1 : 1;
+	if (num_workers > MAX_WORKERS)
+		num_workers = MAX_WORKERS;
+
+	// enough chunks to keep every worker busy while we're writing
+	std::vector<Chunk> chunks(num_workers * 2);
+
+	mCancelled = false;
+	mStopping = false;
+
+	std::vector<std::thread> workers;
+	for (unsigned c = 0; c < num_workers; ++c)
+		workers.push_back(std::thread(&nRFCsvExporter::WorkerThread, this));
+
+	out << GetHeader();
+
+	U64 num_read = 0, num_written = 0, num_rows = 0;
+	bool more_rows = true;
+	for (;;)
+	{
+		// queue up as many chunks as we have room for
+		while (more_rows  &&  num_read - num_written < chunks.size())
+		{
+			Chunk& chunk = chunks[num_read % chunks.size()];
+			chunk.mRows.clear();
+			if (read_rows(chunk.mRows, chunk.mFramesDone) == 0)
+			{
+				more_rows = false;
+				break;
+			}
+
+			std::lock_guard<std::mutex> lock(mLock);
+			chunk.mFormatted = false;
+			mQueue.push_back(&chunk);
+			mWorkReady.notify_one();
+
+			++num_read;
+		}
+
+		if (num_written == num_read)
+			break;
+
+		// write the oldest chunk as soon as it's formatted
+		Chunk& chunk = chunks[num_written % chunks.size()];
+		{
+			std::unique_lock<std::mutex> lock(mLock);
+			while (!chunk.mFormatted)
+				mChunkFormatted.wait(lock);
+		}
+
+		out.write(chunk.mText.data(), chunk.mText.size());
+		num_rows += chunk.mRows.size();
+		++num_written;
+
+		if (progress(chunk.mFramesDone))
+		{
+			mCancelled = true;
+			break;
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mLock);
+		mStopping = true;
+		mQueue.clear();
+		mWorkReady.notify_all();
+	}
+
+	for (size_t c = 0; c < workers.size(); ++c)
+		workers[c].join();
+
+	return num_rows;
+}
+
+void nRFCsvExporter::WorkerThread()
+{
+	nRFTextList texts;
+
+	for (;;)
+	{
+		Chunk* chunk;
+		{
+			std::unique_lock<std::mutex> lock(mLock);
+			while (!mStopping  &&  mQueue.empty())
+				mWorkReady.wait(lock);
+
+			if (mStopping)
+				return;
+
+			chunk = mQueue.front();
+			mQueue.pop_front();
+		}
+
+		FormatChunk(*chunk, texts);
+
+		std::lock_guard<std::mutex> lock(mLock);
+		chunk->mFormatted = true;
+		mChunkFormatted.notify_all();
+	}
+}
+
+void nRFCsvExporter::FormatChunk(Chunk& chunk, nRFTextList& texts)
+{
+	chunk.mText.clear();
+
+	char time_str[128];
+	for (std::vector<nRFExportRow>::const_iterator row(chunk.mRows.begin()); row != chunk.mRows.end(); ++row)
+	{
+		const nRFCommand& cmd = row->mCommand;
+
+		AnalyzerHelpers::GetTimeString(row->mStartingSample, mTriggerSample, mSampleRate, time_str, sizeof(time_str));
+		chunk.mText += time_str;
+		chunk.mText += ';';
+
+		// CSN is 1, CSN 2 is 2...
+		if (mCsnColumn)
+		{
+			chunk.mText += char('1' + cmd.mRadio);
+			chunk.mText += ';';
+		}
+
+		cmd.GetCommandText(false, texts, mDisplayBase);
+		chunk.mText += texts.front().c_str();
+		chunk.mText += ';';
+
+		cmd.GetCommandText(true, texts, mDisplayBase);
+		chunk.mText += texts.front().c_str();
+		chunk.mText += ';';
+
+		if (row->mHasData)
+		{
+			cmd.GetDataText(true, texts, mDisplayBase);
+			if (texts.empty())
+				cmd.GetDataText(false, texts, mDisplayBase);
+
+			if (!texts.empty())
+				chunk.mText += texts.front().c_str();
+		}
+
+		chunk.mText += '\n';
+	}
+}
@@ -0,0 +1,185 @@
+#include <algorithm>
+
+#include "nRFEventIndex.h"
+#include "nRFTables.h"
+
+const U64 nRFEventBitmap::INVALID_INDEX;
+
+void nRFEventBitmap::Add(U64 index)
+{
+	U64 key = index >> CONTAINER_BITS;
+	U16 low = U16(index);
+
+	if (mContainers.empty()  ||  mContainers.back().mKey != key)
+	{
+		mContainers.push_back(Container());
+		mContainers.back().mKey = key;
+	}
+
+	Container& container = mContainers.back();
+	if (container.mBits.empty())
+	{
+		if (!container.mArray.empty()  &&  container.mArray.back() == low)
+			return;
+
+		container.mArray.push_back(low);
+
+		// too many for an array? switch to the bitmap
+		if (container.mArray.size() > MAX_ARRAY)
+		{
+			container.mBits.assign(BITMAP_WORDS, 0);
+			for (size_t c = 0; c < container.mArray.size(); ++c)
+				container.mBits[container.mArray[c] >> 6] |= 1ull << (container.mArray[c] & 63);
+
+			std::vector<U16>().swap(container.mArray);
+		}
+	} else {
+		U64& word = container.mBits[low >> 6];
+		U64 bit = 1ull << (low & 63);
+		if (word & bit)
+			return;
+
+		word |= bit;
+	}
+
+	++mCount;
+}
+
+S32 nRFEventBitmap::Container::FindNext(U32 from) const
+{
+	if (mBits.empty())
+	{
+		std::vector<U16>::const_iterator i = std::lower_bound(mArray.begin(), mArray.end(), from);
+		return i == mArray.end() ? -1 : *i;
+	}
+
+	size_t w = from >> 6;
+	U64 word = mBits[w] & (~0ull << (from & 63));
+	for (;;)
+	{
+		if (word != 0)
+		{
+			S32 bit = 0;
+			while ((word & 1) == 0)
+			{
+				word >>= 1;
+				++bit;
+			}
+
+			return S32(w * 64) + bit;
+		}
+
+		if (++w == BITMAP_WORDS)
+			return -1;
+
+		word = mBits[w];
+	}
+}
+
+U64 nRFEventBitmap::FindNext(U64 from) const
+{
+	U64 key = from >> CONTAINER_BITS;
+	U32 low = U32(from & 0xFFFF);
+
+	std::vector<Container>::const_iterator container = std::lower_bound(mContainers.begin(), mContainers.end(), key,
+		[](const Container& c, U64 k) { return c.mKey < k; });
+
+	for (; container != mContainers.end(); ++container)
+	{
+		// everything in a later container is past from
+		if (container->mKey != key)
+			low = 0;
+
+		S32 found = container->FindNext(low);
+		if (found >= 0)
+			return (container->mKey << CONTAINER_BITS) | U64(found);
+	}
+
+	return INVALID_INDEX;
+}
+
+U64 nRFEventBitmap::GetMemoryBytes() const
+{
+	U64 bytes = mContainers.capacity() * sizeof(Container);
+	for (size_t c = 0; c < mContainers.size(); ++c)
+		bytes += mContainers[c].mArray.capacity() * sizeof(U16) + mContainers[c].mBits.capacity() * sizeof(U64);
+
+	return bytes;
+}
+
+void nRFEventIndex::Add(U64 cmd_frame_index, U8 command_byte, U8 status, U8 first_data, U32 data_length)
+{
+	const nRFCommandInfo& info = GetCommandInfo(command_byte);
+
+	std::lock_guard<std::mutex> lock(mLock);
+
+	if (status & STATUS_RX_DR)
+		mSets[SET_RX_DR].Add(cmd_frame_index);
+	if (status & STATUS_TX_DS)
+		mSets[SET_TX_DS].Add(cmd_frame_index);
+	if (status & STATUS_MAX_RT)
+		mSets[SET_MAX_RT].Add(cmd_frame_index);
+	if (status & STATUS_TX_FULL)
+		mSets[SET_TX_FULL].Add(cmd_frame_index);
+
+	if (info.mCommand == R_REGISTER  &&  info.mRegister == FIFO_STATUS  &&  data_length > 0)
+	{
+		if (first_data & FIFO_TX_REUSE)
+			mSets[SET_FIFO_TX_REUSE].Add(cmd_frame_index);
+		if (first_data & FIFO_TX_FULL)
+			mSets[SET_FIFO_TX_FULL].Add(cmd_frame_index);
+		if (first_data & FIFO_TX_EMPTY)
+			mSets[SET_FIFO_TX_EMPTY].Add(cmd_frame_index);
+		if (first_data & FIFO_RX_FULL)
+			mSets[SET_FIFO_RX_FULL].Add(cmd_frame_index);
+		if (first_data & FIFO_RX_EMPTY)
+			mSets[SET_FIFO_RX_EMPTY].Add(cmd_frame_index);
+	}
+
+	mSets[SET_COMMAND + info.mCommand].Add(cmd_frame_index);
+}
+
+U64 nRFEventIndex::FindNext(const U8* sets, size_t num_sets, U64 from_frame) const
+{
+	if (num_sets == 0)
+		return nRFEventBitmap::INVALID_INDEX;
+
+	std::lock_guard<std::mutex> lock(mLock);
+
+	// leapfrog: move up to the next frame of each set in turn until they all agree
+	U64 candidate = from_frame;
+	size_t agreed = 0;
+	for (size_t s = 0; agreed < num_sets; s = (s + 1) % num_sets)
+	{
+		U64 next = mSets[sets[s]].FindNext(candidate);
+		if (next == nRFEventBitmap::INVALID_INDEX)
+			return next;
+
+		if (next == candidate)
+		{
+			++agreed;
+		} else {
+			candidate = next;
+			agreed = 1;
+		}
+	}
+
+	return candidate;
+}
+
+U64 nRFEventIndex::GetCount(U8 set) const
+{
+	std::lock_guard<std::mutex> lock(mLock);
+	return set < NUM_EVENT_SETS ? mSets[set].GetCount() : 0;
+}
+
+U64 nRFEventIndex::GetMemoryBytes() const
+{
+	std::lock_guard<std::mutex> lock(mLock);
+
+	U64 bytes = 0;
+	for (int s = 0; s < NUM_EVENT_SETS; ++s)
+		bytes += mSets[s].GetMemoryBytes();
+
+	return bytes;
+}
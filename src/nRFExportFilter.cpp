@@ -0,0 +1,492 @@
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#include "nRFExportFilter.h"
+#include "nRFEventIndex.h"
+#include "nRFTables.h"
+
+const U64 nRFExportFilter::INVALID_FRAME;
+
+static bool EqualsNoCase(const std::string& a, const char* b)
+{
+	if (a.size() != ::strlen(b))
+		return false;
+
+	for (size_t c = 0; c < a.size(); ++c)
+	{
+		if (::toupper((unsigned char) a[c]) != ::toupper((unsigned char) b[c]))
+			return false;
+	}
+
+	return true;
+}
+
+// the STATUS flags and their event sets
+static const struct
+{
+	const char*		mName;
+	U8				mBits;
+	U8				mSet;
+} FLAGS[] = {
+	{"RX_DR",		STATUS_RX_DR,	SET_RX_DR},
+	{"TX_DS",		STATUS_TX_DS,	SET_TX_DS},
+	{"MAX_RT",		STATUS_MAX_RT,	SET_MAX_RT},
+	{"TX_FULL",		STATUS_TX_FULL,	SET_TX_FULL},
+};
+
+nRFExportFilter::nRFExportFilter()
+:	mRoot(-1),
+	mEvents(NULL),
+	mText(NULL)
+{}
+
+bool nRFExportFilter::Compile(const char* text, std::string& error)
+{
+	mNodes.clear();
+	mRoot = -1;
+	mError.clear();
+
+	mText = text;
+	if (!NextToken())
+	{
+		error = mError;
+		return false;
+	}
+
+	if (!mToken.empty())
+	{
+		if (!ParseOr(mRoot)  ||  (!mToken.empty()  &&  !Fail("unexpected '" + mToken + "'")))
+		{
+			mNodes.clear();
+			mRoot = -1;
+			error = mError;
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool nRFExportFilter::Fail(const std::string& error)
+{
+	if (mError.empty())
+		mError = error;
+	return false;
+}
+
+bool nRFExportFilter::IsWord(const char* word) const
+{
+	return EqualsNoCase(mToken, word);
+}
+
+bool nRFExportFilter::NextToken()
+{
+	while (::isspace((unsigned char) *mText))
+		++mText;
+
+	mToken.clear();
+
+	const char* start = mText;
+	if (*mText == '\0')
+		return true;
+
+	if (::strncmp(mText, ">=", 2) == 0  ||  ::strncmp(mText, "<=", 2) == 0
+			||  ::strncmp(mText, "&&", 2) == 0  ||  ::strncmp(mText, "||", 2) == 0)
+	{
+		mText += 2;
+	} else if (::strchr("()=!", *mText) != NULL) {
+		++mText;
+	} else {
+		while (*mText != '\0'  &&  (::isalnum((unsigned char) *mText)  ||  ::strchr("_.-+", *mText) != NULL))
+			++mText;
+
+		if (mText == start)
+			return Fail(std::string("unexpected '") + *mText + "'");
+	}
+
+	mToken.assign(start, mText);
+	return true;
+}
+
+S32 nRFExportFilter::AddNode(U8 type, S32 left, S32 right)
+{
+	Node node;
+	node.mType = type;
+	node.mValue = 0;
+	node.mLeft = left;
+	node.mRight = right;
+	node.mSeconds = 0;
+	node.mSample = 0;
+	mNodes.push_back(node);
+
+	return S32(mNodes.size() - 1);
+}
+
+bool nRFExportFilter::ParseOr(S32& node)
+{
+	if (!ParseAnd(node))
+		return false;
+
+	while (IsWord("or")  ||  mToken == "||")
+	{
+		S32 right;
+		if (!NextToken()  ||  !ParseAnd(right))
+			return false;
+
+		node = AddNode(NODE_OR, node, right);
+	}
+
+	return true;
+}
+
+bool nRFExportFilter::ParseAnd(S32& node)
+{
+	if (!ParseUnary(node))
+		return false;
+
+	while (IsWord("and")  ||  mToken == "&&")
+	{
+		S32 right;
+		if (!NextToken()  ||  !ParseUnary(right))
+			return false;
+
+		node = AddNode(NODE_AND, node, right);
+	}
+
+	return true;
+}
+
+bool nRFExportFilter::ParseUnary(S32& node)
+{
+	if (IsWord("not")  ||  mToken == "!")
+	{
+		if (!NextToken()  ||  !ParseUnary(node))
+			return false;
+
+		node = AddNode(NODE_NOT, node);
+		return true;
+	}
+
+	if (mToken == "(")
+	{
+		if (!NextToken()  ||  !ParseOr(node))
+			return false;
+
+		if (mToken != ")")
+			return Fail("missing ')'");
+
+		return NextToken();
+	}
+
+	return ParseTerm(node);
+}
+
+bool nRFExportFilter::ParseTerm(S32& node)
+{
+	if (mToken.empty())
+		return Fail("unexpected end of the filter");
+
+	// reg=<name or number>
+	if (IsWord("reg"))
+	{
+		if (!NextToken()  ||  mToken != "="  ||  !NextToken())
+			return Fail("expected reg=<register>");
+
+		node = AddNode(NODE_REGISTER);
+		for (int r = 0; r < NUM_REGISTERS; ++r)
+		{
+			if (REGISTER_NAMES[r][0] != '<'  &&  IsWord(REGISTER_NAMES[r]))
+			{
+				mNodes[node].mValue = U8(r);
+				return NextToken();
+			}
+		}
+
+		char* end;
+		unsigned long reg = ::strtoul(mToken.c_str(), &end, 0);
+		if (*end != '\0'  ||  reg >= NUM_REGISTERS)
+			return Fail("unknown register '" + mToken + "'");
+
+		mNodes[node].mValue = U8(reg);
+		return NextToken();
+	}
+
+	// pipe=<0..7>
+	if (IsWord("pipe"))
+	{
+		if (!NextToken()  ||  mToken != "="  ||  !NextToken())
+			return Fail("expected pipe=<number>");
+
+		char* end;
+		unsigned long pipe = ::strtoul(mToken.c_str(), &end, 0);
+		if (*end != '\0'  ||  pipe > 7)
+			return Fail("bad pipe '" + mToken + "'");
+
+		node = AddNode(NODE_PIPE);
+		mNodes[node].mValue = U8(pipe);
+		return NextToken();
+	}
+
+	// csn=<1..MAX_RADIOS>, the radios by their CSN setting
+	if (IsWord("csn"))
+	{
+		if (!NextToken()  ||  mToken != "="  ||  !NextToken())
+			return Fail("expected csn=<number>");
+
+		char* end;
+		unsigned long csn = ::strtoul(mToken.c_str(), &end, 10);
+		if (*end != '\0'  ||  csn < 1  ||  csn > MAX_RADIOS)
+			return Fail("bad csn '" + mToken + "'");
+
+		node = AddNode(NODE_CSN);
+		mNodes[node].mValue = U8(csn - 1);
+		return NextToken();
+	}
+
+	// data has <hex bytes>
+	if (IsWord("data"))
+	{
+		if (!NextToken()  ||  !IsWord("has")  ||  !NextToken())
+			return Fail("expected data has <hex bytes>");
+
+		std::string hex = mToken;
+		if (hex.size() > 2  &&  hex[0] == '0'  &&  (hex[1] == 'x'  ||  hex[1] == 'X'))
+			hex = hex.substr(2);
+
+		if (hex.empty()  ||  hex.size() % 2 != 0  ||  hex.size() > 64
+				||  hex.find_first_not_of("0123456789abcdefABCDEF") != std::string::npos)
+			return Fail("bad hex bytes '" + mToken + "'");
+
+		node = AddNode(NODE_DATA);
+		for (size_t c = 0; c < hex.size(); c += 2)
+			mNodes[node].mPattern.push_back(U8(::strtoul(hex.substr(c, 2).c_str(), NULL, 16)));
+
+		return NextToken();
+	}
+
+	// time>=<seconds> or time<=<seconds>
+	if (IsWord("time"))
+	{
+		if (!NextToken()  ||  (mToken != ">="  &&  mToken != "<="))
+			return Fail("expected time>= or time<=");
+
+		U8 type = mToken == ">=" ? NODE_TIME_FROM : NODE_TIME_TO;
+		if (!NextToken())
+			return false;
+
+		char* end;
+		double seconds = ::strtod(mToken.c_str(), &end);
+		if (mToken.empty()  ||  *end != '\0')
+			return Fail("bad time '" + mToken + "'");
+
+		node = AddNode(type);
+		mNodes[node].mSeconds = seconds;
+		return NextToken();
+	}
+
+	for (size_t f = 0; f < sizeof(FLAGS) / sizeof(FLAGS[0]); ++f)
+	{
+		if (IsWord(FLAGS[f].mName))
+		{
+			node = AddNode(NODE_FLAG);
+			mNodes[node].mValue = U8(f);
+			return NextToken();
+		}
+	}
+
+	for (int cmd = 0; cmd < undefined_cmd; ++cmd)
+	{
+		if (IsWord(COMMAND_NAMES[cmd]))
+		{
+			node = AddNode(NODE_COMMAND);
+			mNodes[node].mValue = U8(cmd);
+			return NextToken();
+		}
+	}
+
+	return Fail("unknown term '" + mToken + "'");
+}
+
+void nRFExportFilter::Prepare(const nRFEventIndex& events, const FindPayloadFn& find_payload, U64 trigger_sample, U32 sample_rate)
+{
+	mEvents = &events;
+
+	for (size_t n = 0; n < mNodes.size(); ++n)
+	{
+		Node& node = mNodes[n];
+		if (node.mType == NODE_DATA)
+		{
+			find_payload(node.mPattern.data(), U32(node.mPattern.size()), node.mFrames);
+
+			// we go by the command frames
+			for (size_t c = 0; c < node.mFrames.size(); ++c)
+				--node.mFrames[c];
+		} else if (node.mType == NODE_TIME_FROM  ||  node.mType == NODE_TIME_TO) {
+			double sample = double(trigger_sample) + node.mSeconds * sample_rate;
+			if (node.mType == NODE_TIME_FROM)
+				sample = std::ceil(sample);
+			node.mSample = sample <= 0 ? 0 : U64(sample);
+		}
+	}
+}
+
+void nRFExportFilter::GetRange(S32 node, U64& from_sample, U64& to_sample) const
+{
+	// only what every match has to satisfy
+	const Node& n = mNodes[node];
+	if (n.mType == NODE_AND)
+	{
+		GetRange(n.mLeft, from_sample, to_sample);
+		GetRange(n.mRight, from_sample, to_sample);
+	} else if (n.mType == NODE_TIME_FROM) {
+		from_sample = std::max(from_sample, n.mSample);
+	} else if (n.mType == NODE_TIME_TO) {
+		to_sample = std::min(to_sample, n.mSample);
+	}
+}
+
+void nRFExportFilter::GetSampleRange(U64& from_sample, U64& to_sample) const
+{
+	from_sample = 0;
+	to_sample = 0xFFFFFFFFFFFFFFFFull;
+
+	if (mRoot >= 0)
+		GetRange(mRoot, from_sample, to_sample);
+}
+
+bool nRFExportFilter::HasSource(S32 node) const
+{
+	const Node& n = mNodes[node];
+	switch (n.mType)
+	{
+	case NODE_COMMAND:
+	case NODE_REGISTER:
+	case NODE_FLAG:
+	case NODE_DATA:
+		return true;
+
+	case NODE_AND:
+		return HasSource(n.mLeft)  ||  HasSource(n.mRight);
+
+	case NODE_OR:
+		return HasSource(n.mLeft)  &&  HasSource(n.mRight);
+	}
+
+	return false;
+}
+
+U64 nRFExportFilter::NextCandidate(S32 node, U64 from_frame) const
+{
+	const Node& n = mNodes[node];
+	switch (n.mType)
+	{
+	case NODE_COMMAND:
+	{
+		U8 set = U8(SET_COMMAND + n.mValue);
+		return mEvents->FindNext(&set, 1, from_frame);
+	}
+
+	case NODE_FLAG:
+		return mEvents->FindNext(&FLAGS[n.mValue].mSet, 1, from_frame);
+
+	case NODE_REGISTER:
+	{
+		U8 read = SET_COMMAND + R_REGISTER, write = SET_COMMAND + W_REGISTER;
+		return std::min(mEvents->FindNext(&read, 1, from_frame), mEvents->FindNext(&write, 1, from_frame));
+	}
+
+	case NODE_DATA:
+	{
+		std::vector<U64>::const_iterator i = std::lower_bound(n.mFrames.begin(), n.mFrames.end(), from_frame);
+		return i == n.mFrames.end() ? INVALID_FRAME : *i;
+	}
+
+	case NODE_OR:
+		return std::min(NextCandidate(n.mLeft, from_frame), NextCandidate(n.mRight, from_frame));
+
+	case NODE_AND:
+		if (!HasSource(n.mLeft))
+			return NextCandidate(n.mRight, from_frame);
+		if (!HasSource(n.mRight))
+			return NextCandidate(n.mLeft, from_frame);
+
+		// leapfrog until both sides agree
+		for (;;)
+		{
+			U64 left = NextCandidate(n.mLeft, from_frame);
+			if (left == INVALID_FRAME)
+				return left;
+
+			U64 right = NextCandidate(n.mRight, left);
+			if (right == left  ||  right == INVALID_FRAME)
+				return right;
+
+			from_frame = right;
+		}
+	}
+
+	return from_frame;
+}
+
+U64 nRFExportFilter::FindNextCandidate(U64 from_frame) const
+{
+	if (mRoot < 0  ||  mEvents == NULL  ||  !HasSource(mRoot))
+		return from_frame;
+
+	return NextCandidate(mRoot, from_frame);
+}
+
+bool nRFExportFilter::Evaluate(S32 node, U64 cmd_frame_index, U8 command_byte, U8 status, U8 radio, U64 start_sample) const
+{
+	const Node& n = mNodes[node];
+	switch (n.mType)
+	{
+	case NODE_AND:
+		return Evaluate(n.mLeft, cmd_frame_index, command_byte, status, radio, start_sample)
+				&&  Evaluate(n.mRight, cmd_frame_index, command_byte, status, radio, start_sample);
+
+	case NODE_OR:
+		return Evaluate(n.mLeft, cmd_frame_index, command_byte, status, radio, start_sample)
+				||  Evaluate(n.mRight, cmd_frame_index, command_byte, status, radio, start_sample);
+
+	case NODE_NOT:
+		return !Evaluate(n.mLeft, cmd_frame_index, command_byte, status, radio, start_sample);
+
+	case NODE_COMMAND:
+		return GetCommandInfo(command_byte).mCommand == n.mValue;
+
+	case NODE_REGISTER:
+	{
+		const nRFCommandInfo& info = GetCommandInfo(command_byte);
+		return (info.mFlags & CMD_IS_REGISTER)  &&  info.mRegister == n.mValue;
+	}
+
+	case NODE_FLAG:
+		return (status & FLAGS[n.mValue].mBits) != 0;
+
+	case NODE_PIPE:
+		return ((status >> 1) & 7) == n.mValue;
+
+	case NODE_CSN:
+		return radio == n.mValue;
+
+	case NODE_DATA:
+		return std::binary_search(n.mFrames.begin(), n.mFrames.end(), cmd_frame_index);
+
+	case NODE_TIME_FROM:
+		return start_sample >= n.mSample;
+
+	case NODE_TIME_TO:
+		return start_sample <= n.mSample;
+	}
+
+	return false;
+}
+
+bool nRFExportFilter::Matches(U64 cmd_frame_index, U8 command_byte, U8 status, U8 radio, U64 start_sample) const
+{
+	return mRoot < 0  ||  Evaluate(mRoot, cmd_frame_index, command_byte, status, radio, start_sample);
+}
@@ -0,0 +1,151 @@
+#include "nRFOperations.h"
+#include "nRFTables.h"
+
+static bool IsTxLoad(U8 cmd)
+{
+	return cmd == W_TX_PAYLOAD  ||  cmd == W_TX_PAYLOAD_NOACK  ||  cmd == REUSE_TX_PL;
+}
+
+static bool IsRxRead(U8 cmd)
+{
+	return cmd == R_RX_PL_WID  ||  cmd == R_RX_PAYLOAD;
+}
+
+// the reads an MCU spins on while waiting for the radio
+static bool IsPoll(const nRFCommandInfo& info)
+{
+	return info.mCommand == NOP
+			||  (info.mCommand == R_REGISTER  &&  (info.mRegister == STATUS  ||  info.mRegister == FIFO_STATUS  ||  info.mRegister == OBSERVE_TX));
+}
+
+static bool IsStatusWrite(const nRFCommandInfo& info)
+{
+	return info.mCommand == W_REGISTER  &&  info.mRegister == STATUS;
+}
+
+void nRFOperation::GetText(nRFShortText& text) const
+{
+	if (mType == OP_TX)
+		text.Append("TX");
+	else if (mType == OP_RX)
+		text.Append("RX");
+	else
+		text.Append("Setup");
+
+	if (mType == OP_SETUP  ||  mNumPayloads == 0)
+	{
+		text.Append(" ").AppendDecimal(mNumTransactions).Append(mNumTransactions == 1 ? " command" : " commands");
+	} else {
+		text.Append(" ").AppendDecimal(mNumPayloads).Append(mNumPayloads == 1 ? " payload (" : " payloads (");
+		text.AppendDecimal(mPayloadBytes).Append(" bytes)");
+
+		if (mType == OP_RX  &&  mPipe < 6)
+			text.Append(" on pipe ").AppendDecimal(mPipe);
+	}
+
+	if (mNumPolls > 0)
+		text.AddPart("").AppendDecimal(mNumPolls).Append(mNumPolls == 1 ? " poll" : " polls");
+
+	if (mEvents & STATUS_TX_DS)
+		text.AddPart("TX_DS");
+	if (mEvents & STATUS_MAX_RT)
+		text.AddPart("MAX_RT");
+	if (mEvents & STATUS_RX_DR)
+		text.AddPart("RX_DR");
+
+	if (mType == OP_TX  &&  (mEvents & (STATUS_TX_DS | STATUS_MAX_RT)) == 0)
+		text.AddPart("no result");
+}
+
+nRFOperationGrouper::nRFOperationGrouper()
+{
+	for (U32 radio = 0; radio < MAX_RADIOS; ++radio)
+		mOpen[radio] = NONE_OPEN;
+}
+
+bool nRFOperationGrouper::Continues(const nRFOperation& op, U8 command_byte, U8 status) const
+{
+	const nRFCommandInfo& info = GetCommandInfo(command_byte);
+
+	if (op.mType == OP_TX)
+		return IsTxLoad(info.mCommand)  ||  IsPoll(info)  ||  IsStatusWrite(info)  ||  info.mCommand == FLUSH_TX;
+
+	if (op.mType == OP_RX)
+		return IsRxRead(info.mCommand)  ||  IsPoll(info)  ||  IsStatusWrite(info)  ||  info.mCommand == FLUSH_RX;
+
+	// a setup goes on until payloads are loaded or a poll says there's one to read
+	return !IsTxLoad(info.mCommand)  &&  !IsRxRead(info.mCommand)
+			&&  !(IsPoll(info)  &&  (status & STATUS_RX_DR));
+}
+
+U64 nRFOperationGrouper::Add(U8 radio, U8 command_byte, U8 status, U8 first_data, U32 data_length)
+{
+	const nRFCommandInfo& info = GetCommandInfo(command_byte);
+
+	std::lock_guard<std::mutex> lock(mLock);
+
+	U64& open = mOpen[radio];
+	if (open == NONE_OPEN  ||  !Continues(mOperations[size_t(open)], command_byte, status))
+	{
+		nRFOperation op = nRFOperation();
+		if (IsTxLoad(info.mCommand))
+			op.mType = OP_TX;
+		else if (IsRxRead(info.mCommand)  ||  (IsPoll(info)  &&  (status & STATUS_RX_DR)))
+			op.mType = OP_RX;
+		else
+			op.mType = OP_SETUP;
+		op.mRadio = radio;
+		op.mPipe = 7;
+
+		open = mOperations.size();
+		mOperations.push_back(op);
+	}
+
+	U64 operation_id = open;
+	nRFOperation& op = mOperations[size_t(operation_id)];
+	++op.mNumTransactions;
+	op.mStatus = status;
+	op.mEvents |= status & STATUS_IRQ_MASK;
+
+	if (IsPoll(info))
+		++op.mNumPolls;
+
+	if ((IsTxLoad(info.mCommand)  &&  info.mCommand != REUSE_TX_PL)  ||  info.mCommand == R_RX_PAYLOAD)
+	{
+		++op.mNumPayloads;
+		op.mPayloadBytes += data_length;
+	}
+
+	if (info.mCommand == R_RX_PAYLOAD)
+		op.mPipe = (status >> 1) & 7;
+
+	// clearing what we've been waiting for ends the operation, so does dropping a payload that failed
+	if (IsStatusWrite(info)  &&  data_length > 0)
+	{
+		if (op.mType == OP_TX  &&  (first_data & (STATUS_TX_DS | STATUS_MAX_RT)))
+			open = NONE_OPEN;
+		else if (op.mType == OP_RX  &&  (first_data & STATUS_RX_DR))
+			open = NONE_OPEN;
+	} else if (op.mType == OP_TX  &&  info.mCommand == FLUSH_TX  &&  (op.mEvents & STATUS_MAX_RT)) {
+		open = NONE_OPEN;
+	}
+
+	return operation_id;
+}
+
+bool nRFOperationGrouper::GetOperation(U64 operation_id, nRFOperation& op) const
+{
+	std::lock_guard<std::mutex> lock(mLock);
+
+	if (operation_id >= mOperations.size())
+		return false;
+
+	op = mOperations[size_t(operation_id)];
+	return true;
+}
+
+U64 nRFOperationGrouper::GetNumOperations() const
+{
+	std::lock_guard<std::mutex> lock(mLock);
+	return mOperations.size();
+}
@@ -0,0 +1,220 @@
+#ifdef _WINDOWS
+# include <windows.h>
+#else
+# include <stdio.h>
+# include <unistd.h>
+# include <sys/mman.h>
+#endif
+
+#include <cstring>
+
+#include "nRFPayloadArena.h"
+#include "utils.h"
+
+nRFPayloadArena::nRFPayloadArena()
+:	mRamBudget(0),
+	mUsed(CHUNK_SIZE),
+	mNumReleased(0),
+	mNextToSpill(0),
+	mNumResident(0),
+	mNumSpilled(0),
+	mNumFileSlots(0),
+#ifdef _WINDOWS
+	mFile(INVALID_HANDLE_VALUE),
+#else
+	mFile(-1),
+#endif
+	mSpillFailed(false)
+{}
+
+nRFPayloadArena::~nRFPayloadArena()
+{
+	for (size_t ndx = mNumReleased; ndx < mChunks.size(); ++ndx)
+		ReleaseChunk(ndx);
+
+#ifdef _WINDOWS
+	if (mFile != INVALID_HANDLE_VALUE)
+		::CloseHandle(mFile);
+#else
+	if (mFile != -1)
+		::close(mFile);
+#endif
+}
+
+U64 nRFPayloadArena::Append(const U8* data, U32 length)
+{
+	if (mUsed + length > CHUNK_SIZE)
+		NewChunk();
+
+	U64 offset = U64(mChunks.size() - 1) * CHUNK_SIZE + mUsed;
+
+	::memcpy(mChunks.back() + mUsed, data, length);
+	mUsed += length;
+
+	return offset;
+}
+
+void nRFPayloadArena::NewChunk()
+{
+	mChunks.push_back(new U8[CHUNK_SIZE]);
+	mSpilled.push_back(false);
+	mFileSlots.push_back(0);
+	mUsed = 0;
+	++mNumResident;
+
+	SpillChunks();
+}
+
+void nRFPayloadArena::ReleaseBefore(U64 offset)
+{
+	size_t end = size_t(offset / CHUNK_SIZE);
+	if (end + 1 > mChunks.size())
+		end = mChunks.empty() ? 0 : mChunks.size() - 1;
+
+	for (; mNumReleased < end; ++mNumReleased)
+	{
+		if (mSpilled[mNumReleased])
+		{
+			mFreeSlots.push_back(mFileSlots[mNumReleased]);
+			--mNumSpilled;
+		} else {
+			--mNumResident;
+		}
+
+		ReleaseChunk(mNumReleased);
+		mChunks[mNumReleased] = NULL;
+	}
+
+	// nothing left to spill there
+	if (mNextToSpill < mNumReleased)
+		mNextToSpill = mNumReleased;
+}
+
+void nRFPayloadArena::SpillChunks()
+{
+	if (mRamBudget == 0  ||  mSpillFailed)
+		return;
+
+	// the last chunk is still being written, so it stays in RAM
+	while (GetResidentBytes() > mRamBudget  &&  mNextToSpill + 1 < mChunks.size())
+	{
+		size_t slot = mFreeSlots.empty() ? mNumFileSlots : mFreeSlots.back();
+		if (!SpillChunk(mNextToSpill, slot))
+		{
+			// no temp file? then we just keep using RAM
+			debug("nRFPayloadArena: spilling to disk failed");
+			mSpillFailed = true;
+			return;
+		}
+
+		if (slot == mNumFileSlots)
+			++mNumFileSlots;
+		else
+			mFreeSlots.pop_back();
+
+		mFileSlots[mNextToSpill] = slot;
+		++mNextToSpill;
+	}
+}
+
+#ifdef _WINDOWS
+
+bool nRFPayloadArena::SpillChunk(size_t ndx, size_t slot)
+{
+	if (mFile == INVALID_HANDLE_VALUE)
+	{
+		char path[MAX_PATH], file_name[MAX_PATH];
+		if (::GetTempPathA(MAX_PATH, path) == 0  ||  ::GetTempFileNameA(path, "nrf", 0, file_name) == 0)
+			return false;
+
+		mFile = ::CreateFileA(file_name, GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_ALWAYS,
+								FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, NULL);
+		if (mFile == INVALID_HANDLE_VALUE)
+			return false;
+	}
+
+	U64 offset = U64(slot) * CHUNK_SIZE;
+	U64 end = offset + CHUNK_SIZE;
+
+	OVERLAPPED ov;
+	::memset(&ov, 0, sizeof(ov));
+	ov.Offset = DWORD(offset);
+	ov.OffsetHigh = DWORD(offset >> 32);
+
+	DWORD written = 0;
+	if (!::WriteFile(mFile, mChunks[ndx], CHUNK_SIZE, &written, &ov)  ||  written != CHUNK_SIZE)
+		return false;
+
+	// the view keeps the mapping alive after the handle is closed
+	HANDLE mapping = ::CreateFileMappingA(mFile, NULL, PAGE_READONLY, DWORD(end >> 32), DWORD(end), NULL);
+	if (mapping == NULL)
+		return false;
+
+	void* view = ::MapViewOfFile(mapping, FILE_MAP_READ, DWORD(offset >> 32), DWORD(offset), CHUNK_SIZE);
+	::CloseHandle(mapping);
+	if (view == NULL)
+		return false;
+
+	delete [] mChunks[ndx];
+	mChunks[ndx] = (U8*) view;
+	mSpilled[ndx] = true;
+
+	--mNumResident;
+	++mNumSpilled;
+
+	return true;
+}
+
+void nRFPayloadArena::ReleaseChunk(size_t ndx)
+{
+	if (mSpilled[ndx])
+		::UnmapViewOfFile(mChunks[ndx]);
+	else
+		delete [] mChunks[ndx];
+}
+
+#else
+
+bool nRFPayloadArena::SpillChunk(size_t ndx, size_t slot)
+{
+	if (mFile == -1)
+	{
+		// the file is gone as soon as it's closed
+		FILE* file = ::tmpfile();
+		if (file == NULL)
+			return false;
+
+		mFile = ::dup(::fileno(file));
+		::fclose(file);
+
+		if (mFile == -1)
+			return false;
+	}
+
+	off_t offset = off_t(slot) * CHUNK_SIZE;
+	if (::pwrite(mFile, mChunks[ndx], CHUNK_SIZE, offset) != CHUNK_SIZE)
+		return false;
+
+	void* view = ::mmap(NULL, CHUNK_SIZE, PROT_READ, MAP_SHARED, mFile, offset);
+	if (view == MAP_FAILED)
+		return false;
+
+	delete [] mChunks[ndx];
+	mChunks[ndx] = (U8*) view;
+	mSpilled[ndx] = true;
+
+	--mNumResident;
+	++mNumSpilled;
+
+	return true;
+}
+
+void nRFPayloadArena::ReleaseChunk(size_t ndx)
+{
+	if (mSpilled[ndx])
+		::munmap(mChunks[ndx], CHUNK_SIZE);
+	else
+		delete [] mChunks[ndx];
+}
+
+#endif
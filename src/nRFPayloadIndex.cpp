@@ -0,0 +1,147 @@
+#include <algorithm>
+#include <iterator>
+
+#include "nRFPayloadIndex.h"
+
+nRFPayloadIndex::nRFPayloadIndex(U64 max_bytes)
+:	mPostings(NUM_PAIRS),
+	mMaxBytes(max_bytes),
+	mBytes(NUM_PAIRS * sizeof(Postings)),
+	mNumPayloads(0),
+	mIndexedEnd(0xFFFFFFFFFFFFFFFFull),
+	mFull(false)
+{
+	for (size_t c = 0; c < mPostings.size(); ++c)
+	{
+		mPostings[c].mLast = 0;
+		mPostings[c].mCount = 0;
+	}
+}
+
+bool nRFPayloadIndex::Append(Postings& postings, U64 frame_index)
+{
+	// a pair that's in a payload more than once
+	if (postings.mCount > 0  &&  postings.mLast == frame_index)
+		return true;
+
+	// grow the list ourselves, so the budget is a hard limit
+	std::vector<U8>& deltas = postings.mDeltas;
+	if (deltas.size() + 10 > deltas.capacity())
+	{
+		size_t new_capacity = std::max<size_t>(16, deltas.capacity() + deltas.capacity() / 2);
+		if (mBytes + (new_capacity - deltas.capacity()) > mMaxBytes)
+			return false;
+
+		mBytes += new_capacity - deltas.capacity();
+		deltas.reserve(new_capacity);
+	}
+
+	U64 delta = frame_index - postings.mLast;
+	while (delta >= 0x80)
+	{
+		deltas.push_back(U8(delta | 0x80));
+		delta >>= 7;
+	}
+	deltas.push_back(U8(delta));
+
+	postings.mLast = frame_index;
+	++postings.mCount;
+
+	return true;
+}
+
+void nRFPayloadIndex::Add(U64 frame_index, const U8* data, U32 length)
+{
+	std::lock_guard<std::mutex> lock(mLock);
+
+	if (mFull)
+		return;
+
+	for (U32 c = 1; c < length; ++c)
+	{
+		if (!Append(mPostings[(data[c - 1] << 8) | data[c]], frame_index))
+		{
+			// The pairs that did go in are harmless, they only make a candidate which gets checked.
+			// This frame and everything after it will be searched without the index.
+			mFull = true;
+			mIndexedEnd = frame_index;
+			return;
+		}
+	}
+
+	++mNumPayloads;
+}
+
+void nRFPayloadIndex::Decode(const Postings& postings, std::vector<U64>& frames) const
+{
+	frames.clear();
+	frames.reserve(postings.mCount);
+
+	U64 frame_index = 0;
+	const U8* read = postings.mDeltas.data();
+	for (U32 c = 0; c < postings.mCount; ++c)
+	{
+		U64 delta = 0;
+		int shift = 0;
+		do {
+			delta |= U64(*read & 0x7F) << shift;
+			shift += 7;
+		} while (*read++ & 0x80);
+
+		frame_index += delta;
+		if (frame_index < mIndexedEnd)
+			frames.push_back(frame_index);
+	}
+}
+
+bool nRFPayloadIndex::FindCandidates(const U8* pattern, U32 length, std::vector<U64>& frames, U64& indexed_end) const
+{
+	frames.clear();
+	if (length < 2)
+		return false;
+
+	// under the same lock as the lists, Decode() cuts them off there
+	std::lock_guard<std::mutex> lock(mLock);
+	indexed_end = mIndexedEnd;
+
+	// start with the shortest list, then keep the frames that are in all the others
+	std::vector<U32> pairs;
+	for (U32 c = 1; c < length; ++c)
+		pairs.push_back((pattern[c - 1] << 8) | pattern[c]);
+
+	std::sort(pairs.begin(), pairs.end());
+	pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+	std::sort(pairs.begin(), pairs.end(), [this](U32 a, U32 b) { return mPostings[a].mCount < mPostings[b].mCount; });
+
+	Decode(mPostings[pairs[0]], frames);
+
+	std::vector<U64> other, both;
+	for (size_t c = 1; c < pairs.size()  &&  !frames.empty(); ++c)
+	{
+		Decode(mPostings[pairs[c]], other);
+
+		both.clear();
+		std::set_intersection(frames.begin(), frames.end(), other.begin(), other.end(), std::back_inserter(both));
+		frames.swap(both);
+	}
+
+	return true;
+}
+
+U64 nRFPayloadIndex::GetIndexedEnd() const
+{
+	std::lock_guard<std::mutex> lock(mLock);
+	return mIndexedEnd;
+}
+
+U64 nRFPayloadIndex::GetNumPayloads() const
+{
+	std::lock_guard<std::mutex> lock(mLock);
+	return mNumPayloads;
+}
+
+U64 nRFPayloadIndex::GetMemoryBytes() const
+{
+	std::lock_guard<std::mutex> lock(mLock);
+	return mBytes;
+}
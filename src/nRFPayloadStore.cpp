@@ -0,0 +1,199 @@
+#include <cstring>
+
+#include "nRFPayloadStore.h"
+
+// the record header byte: the payload length and the delta flag
+#define RECORD_DELTA		0x80
+#define RECORD_LEN_MASK		0x3F
+
+// header, depth, base ID and the number of changed bytes
+#define DELTA_OVERHEAD		(1 + 1 + 8 + 1)
+
+static U64 HashPayload(const U8* data, U32 length)
+{
+	U64 hash = 0xcbf29ce484222325ULL ^ length;
+	for (U32 c = 0; c < length; ++c)
+		hash = (hash ^ data[c]) * 0x100000001b3ULL;
+
+	return hash;
+}
+
+nRFPayloadStore::nRFPayloadStore()
+:	mFloor(0),
+	mOldestSinceMark(0),
+	mNumPayloads(0),
+	mNumInterned(0),
+	mNumDeltas(0),
+	mRawBytes(0),
+	mStoredBytes(0)
+{
+	::memset(mIntern, 0, sizeof(mIntern));
+
+	for (U32 c = 0; c < NUM_STREAMS; ++c)
+		mLast[c].mLength = 0;
+}
+
+U64 nRFPayloadStore::Store(const U8* data, U32 length, U32 stream)
+{
+	if (length > MAX_PAYLOAD)
+		length = MAX_PAYLOAD;
+
+	std::lock_guard<std::mutex> lock(mLock);
+
+	++mNumPayloads;
+	mRawBytes += length;
+
+	LastPayload& last = mLast[stream % NUM_STREAMS];
+	U64 hash = HashPayload(data, length);
+	const InternSlot* interned = Intern(data, length, hash);
+	U64 id = 0, oldest;
+	U8 depth = 0;
+
+	if (interned != NULL)
+	{
+		// seen it already
+		id = interned->mId - 1;
+		oldest = interned->mOldest;
+		++mNumInterned;
+
+		const U8* record = mArena.Get(id);
+		depth = (record[0] & RECORD_DELTA) ? record[1] : 0;
+
+	} else {
+
+		if (last.mLength == length  &&  last.mDepth < MAX_DELTA_DEPTH  &&  last.mOldest >= mFloor)
+			id = StoreDelta(data, length, last);
+
+		if (id != 0)
+		{
+			--id;
+			depth = last.mDepth + 1;
+			oldest = last.mOldest;
+		} else {
+			id = StoreFull(data, length);
+			oldest = id;
+		}
+
+		InternSlot& slot = mIntern[hash % INTERN_SLOTS];
+		slot.mHash = hash;
+		slot.mId = id + 1;
+		slot.mOldest = oldest;
+	}
+
+	if (oldest < mOldestSinceMark)
+		mOldestSinceMark = oldest;
+
+	last.mId = id;
+	last.mOldest = oldest;
+	last.mLength = U8(length);
+	last.mDepth = depth;
+	::memcpy(last.mData, data, length);
+
+	return id;
+}
+
+const nRFPayloadStore::InternSlot* nRFPayloadStore::Intern(const U8* data, U32 length, U64 hash)
+{
+	const InternSlot& slot = mIntern[hash % INTERN_SLOTS];
+	if (slot.mId == 0  ||  slot.mHash != hash  ||  slot.mOldest < mFloor)
+		return NULL;
+
+	// make sure it's not a collision
+	U8 stored[MAX_PAYLOAD];
+	if (Rebuild(slot.mId - 1, stored) != length  ||  ::memcmp(stored, data, length) != 0)
+		return NULL;
+
+	return &slot;
+}
+
+U64 nRFPayloadStore::StoreDelta(const U8* data, U32 length, const LastPayload& base)
+{
+	U8 record[DELTA_OVERHEAD + 2 * MAX_PAYLOAD];
+	U8* pWrite = record + DELTA_OVERHEAD;
+
+	// only worth it if it comes out shorter than the payload itself
+	U32 max_changes = length + 1 > DELTA_OVERHEAD ? (length + 1 - DELTA_OVERHEAD) / 2 : 0;
+	U32 changes = 0;
+	for (U32 c = 0; c < length; ++c)
+	{
+		if (data[c] != base.mData[c])
+		{
+			if (++changes > max_changes)
+				return 0;
+
+			*pWrite++ = U8(c);
+			*pWrite++ = data[c];
+		}
+	}
+
+	record[0] = U8(RECORD_DELTA | length);
+	record[1] = base.mDepth + 1;
+	::memcpy(record + 2, &base.mId, sizeof(base.mId));
+	record[DELTA_OVERHEAD - 1] = U8(changes);
+
+	U32 size = U32(pWrite - record);
+	mStoredBytes += size;
+	++mNumDeltas;
+
+	return mArena.Append(record, size) + 1;
+}
+
+U64 nRFPayloadStore::StoreFull(const U8* data, U32 length)
+{
+	U8 record[1 + MAX_PAYLOAD];
+
+	record[0] = U8(length);
+	::memcpy(record + 1, data, length);
+
+	mStoredBytes += length + 1;
+
+	return mArena.Append(record, length + 1);
+}
+
+U32 nRFPayloadStore::Get(U64 id, U8* data) const
+{
+	std::lock_guard<std::mutex> lock(mLock);
+
+	return Rebuild(id, data);
+}
+
+void nRFPayloadStore::SetMark()
+{
+	std::lock_guard<std::mutex> lock(mLock);
+
+	mOldestSinceMark = mArena.GetEnd();
+}
+
+void nRFPayloadStore::ReleaseBeforeMark()
+{
+	std::lock_guard<std::mutex> lock(mLock);
+
+	if (mOldestSinceMark <= mFloor)
+		return;
+
+	mFloor = mOldestSinceMark;
+	mArena.ReleaseBefore(mFloor);
+}
+
+U32 nRFPayloadStore::Rebuild(U64 id, U8* data) const
+{
+	const U8* record = mArena.Get(id);
+	U32 length = record[0] & RECORD_LEN_MASK;
+
+	if ((record[0] & RECORD_DELTA) == 0)
+	{
+		::memcpy(data, record + 1, length);
+		return length;
+	}
+
+	// rebuild the base, then apply the changes
+	U64 base_id;
+	::memcpy(&base_id, record + 2, sizeof(base_id));
+	Rebuild(base_id, data);
+
+	const U8* pRead = record + DELTA_OVERHEAD;
+	for (U32 changes = record[DELTA_OVERHEAD - 1]; changes > 0; --changes, pRead += 2)
+		data[pRead[0]] = pRead[1];
+
+	return length;
+}
@@ -0,0 +1,144 @@
+#include <cstring>
+#include <algorithm>
+
+#include "nRFRegisterShadow.h"
+
+void nRFRegisterFile::Clear()
+{
+	::memset(mValues, 0, sizeof(mValues));
+	mKnown = 0;
+}
+
+bool nRFRegisterFile::Set(U8 reg, const U8* data, U32 length)
+{
+	if (length > MAX_WIDTH)
+		length = MAX_WIDTH;
+
+	if (IsKnown(reg)  &&  ::memcmp(mValues[reg], data, length) == 0)
+		return false;
+
+	::memcpy(mValues[reg], data, length);
+	mKnown |= 1u << reg;
+
+	return true;
+}
+
+U32 nRFRegisterFile::GetAddressWidth() const
+{
+	U8 aw = Get(SETUP_AW) & 3;
+	return IsKnown(SETUP_AW)  &&  aw != 0 ? aw + 2 : MAX_WIDTH;
+}
+
+bool nRFRegisterFile::GetAddress(U8 reg, U8* addr, U32& width) const
+{
+	width = GetAddressWidth();
+
+	if (reg == RX_ADDR_P0  ||  reg == RX_ADDR_P1  ||  reg == TX_ADDR)
+	{
+		if (!IsKnown(reg))
+			return false;
+
+		::memcpy(addr, mValues[reg], width);
+		return true;
+	}
+
+	if (reg >= RX_ADDR_P2  &&  reg <= RX_ADDR_P5)
+	{
+		if (!IsKnown(reg)  ||  !IsKnown(RX_ADDR_P1))
+			return false;
+
+		::memcpy(addr, mValues[RX_ADDR_P1], width);
+		addr[0] = mValues[reg][0];
+		return true;
+	}
+
+	return false;
+}
+
+bool nRFRegisterFile::GetTarget(U8 command_byte, U32 data_length, U8& reg)
+{
+	const nRFCommandInfo& info = GetCommandInfo(command_byte);
+	if ((info.mFlags & CMD_IS_REGISTER) == 0  ||  data_length == 0)
+		return false;
+
+	reg = info.mRegister;
+
+	// writing these doesn't set them: they're read only or cleared by writing a 1
+	if ((info.mFlags & CMD_IS_READ) == 0
+			&&  (reg == STATUS  ||  reg == OBSERVE_TX  ||  reg == CD  ||  reg == FIFO_STATUS))
+		return false;
+
+	return true;
+}
+
+nRFRegisterShadow::nRFRegisterShadow()
+{}
+
+void nRFRegisterShadow::Update(U64 frame_index, U8 command_byte, const U8* data, U32 length)
+{
+	U8 reg;
+	if (!nRFRegisterFile::GetTarget(command_byte, length, reg))
+		return;
+
+	if (length > nRFRegisterFile::MAX_WIDTH)
+		length = nRFRegisterFile::MAX_WIDTH;
+
+	std::lock_guard<std::mutex> lock(mLock);
+
+	if (!mCurrent.Set(reg, data, length))
+		return;
+
+	Change change;
+	change.mFrameIndex = frame_index;
+	change.mRegister = reg;
+	change.mLength = U8(length);
+	::memcpy(change.mData, data, length);
+	mChanges.push_back(change);
+
+	if (mChanges.size() % CHECKPOINT_INTERVAL == 0)
+	{
+		Checkpoint checkpoint;
+		checkpoint.mFrameIndex = frame_index;
+		checkpoint.mNextChange = mChanges.size();
+		checkpoint.mRegisters = mCurrent;
+		mCheckpoints.push_back(checkpoint);
+	}
+}
+
+void nRFRegisterShadow::GetState(U64 frame_index, nRFRegisterFile& regs) const
+{
+	std::lock_guard<std::mutex> lock(mLock);
+
+	// the last checkpoint at or before the frame
+	std::vector<Checkpoint>::const_iterator checkpoint = std::upper_bound(mCheckpoints.begin(), mCheckpoints.end(), frame_index,
+		[](U64 frame_index, const Checkpoint& checkpoint) { return frame_index < checkpoint.mFrameIndex; });
+
+	size_t next_change = 0;
+	if (checkpoint == mCheckpoints.begin())
+	{
+		regs.Clear();
+	} else {
+		--checkpoint;
+		regs = checkpoint->mRegisters;
+		next_change = checkpoint->mNextChange;
+	}
+
+	// and the changes after it
+	for (; next_change < mChanges.size()  &&  mChanges[next_change].mFrameIndex <= frame_index; ++next_change)
+	{
+		const Change& change = mChanges[next_change];
+		regs.Set(change.mRegister, change.mData, change.mLength);
+	}
+}
+
+U64 nRFRegisterShadow::GetNumChanges() const
+{
+	std::lock_guard<std::mutex> lock(mLock);
+	return mChanges.size();
+}
+
+U64 nRFRegisterShadow::GetNumCheckpoints() const
+{
+	std::lock_guard<std::mutex> lock(mLock);
+	return mCheckpoints.size();
+}
@@ -0,0 +1,192 @@
+#include <algorithm>
+
+#include "nRFSampleIndex.h"
+
+static void PutVarint(std::vector<U8>& out, U64 value)
+{
+	while (value >= 0x80)
+	{
+		out.push_back(U8(value | 0x80));
+		value >>= 7;
+	}
+	out.push_back(U8(value));
+}
+
+static U64 GetVarint(const U8* data, size_t& offset)
+{
+	U64 value = 0;
+	int shift = 0;
+	U8 byte;
+	do {
+		byte = data[offset++];
+		value |= U64(byte & 0x7F) << shift;
+		shift += 7;
+	} while (byte & 0x80);
+
+	return value;
+}
+
+nRFSampleIndex::nRFSampleIndex()
+:	mCount(0)
+{
+	mLast.mFrameIndex = mLast.mStartSample = mLast.mEndSample = 0;
+}
+
+void nRFSampleIndex::Add(U64 frame_index, U64 start_sample, U64 end_sample)
+{
+	std::lock_guard<std::mutex> lock(mLock);
+
+	// every block starts from its own first entry, so it can be decoded on its own
+	if (mCount % BLOCK_SIZE == 0)
+	{
+		Block block;
+		block.mFrameIndex = frame_index;
+		block.mOffset = mDeltas.size();
+		mBlocks.push_back(block);
+		mBlockStarts.push_back(start_sample);
+
+		mLast.mFrameIndex = frame_index;
+		mLast.mStartSample = start_sample;
+	}
+
+	PutVarint(mDeltas, start_sample - mLast.mStartSample);
+	PutVarint(mDeltas, end_sample - start_sample);
+	PutVarint(mDeltas, frame_index - mLast.mFrameIndex);
+
+	mLast.mFrameIndex = frame_index;
+	mLast.mStartSample = start_sample;
+	mLast.mEndSample = end_sample;
+	++mCount;
+}
+
+void nRFSampleIndex::Decode(size_t& offset, const Entry& previous, Entry& entry) const
+{
+	const U8* data = mDeltas.data();
+	entry.mStartSample = previous.mStartSample + GetVarint(data, offset);
+	entry.mEndSample = entry.mStartSample + GetVarint(data, offset);
+	entry.mFrameIndex = previous.mFrameIndex + GetVarint(data, offset);
+}
+
+void nRFSampleIndex::Seek(U64 position, size_t& offset, Entry& previous) const
+{
+	const Block& block = mBlocks[size_t(position / BLOCK_SIZE)];
+	offset = block.mOffset;
+	previous.mFrameIndex = block.mFrameIndex;
+	previous.mStartSample = mBlockStarts[size_t(position / BLOCK_SIZE)];
+	previous.mEndSample = previous.mStartSample;
+}
+
+U64 nRFSampleIndex::LowerBoundLocked(U64 sample) const
+{
+	// the last block that starts before the sample has the first transaction at or after it, or the next block does
+	std::vector<U64>::const_iterator i = std::lower_bound(mBlockStarts.begin(), mBlockStarts.end(), sample);
+	if (i == mBlockStarts.begin())
+		return 0;
+
+	U64 position = U64(i - mBlockStarts.begin() - 1) * BLOCK_SIZE;
+
+	size_t offset;
+	Entry previous, entry;
+	Seek(position, offset, previous);
+	for (; position < mCount; ++position)
+	{
+		Decode(offset, previous, entry);
+		if (entry.mStartSample >= sample)
+			break;
+
+		// only the next block is left
+		if ((position + 1) % BLOCK_SIZE == 0)
+			return position + 1;
+
+		previous = entry;
+	}
+
+	return position;
+}
+
+U64 nRFSampleIndex::LowerBound(U64 sample) const
+{
+	std::lock_guard<std::mutex> lock(mLock);
+	return LowerBoundLocked(sample);
+}
+
+U64 nRFSampleIndex::CountInRange(U64 from_sample, U64 to_sample) const
+{
+	std::lock_guard<std::mutex> lock(mLock);
+
+	if (from_sample > to_sample)
+		return 0;
+
+	U64 end = to_sample == 0xFFFFFFFFFFFFFFFFull ? mCount : LowerBoundLocked(to_sample + 1);
+	return end - LowerBoundLocked(from_sample);
+}
+
+bool nRFSampleIndex::FindCovering(U64 sample, Entry& entry) const
+{
+	std::lock_guard<std::mutex> lock(mLock);
+
+	// the last transaction that starts at or before the sample
+	U64 position = LowerBoundLocked(sample + 1);
+	if (position == 0)
+		return false;
+	--position;
+
+	size_t offset;
+	Entry previous;
+	Seek(position, offset, previous);
+	for (U64 p = position - position % BLOCK_SIZE; p <= position; ++p)
+	{
+		Decode(offset, previous, entry);
+		previous = entry;
+	}
+
+	return entry.mEndSample >= sample;
+}
+
+U64 nRFSampleIndex::GetCount() const
+{
+	std::lock_guard<std::mutex> lock(mLock);
+	return mCount;
+}
+
+U64 nRFSampleIndex::GetMemoryBytes() const
+{
+	std::lock_guard<std::mutex> lock(mLock);
+	return mDeltas.capacity() + mBlocks.capacity() * sizeof(Block) + mBlockStarts.capacity() * sizeof(U64);
+}
+
+nRFSampleIndex::Cursor::Cursor(const nRFSampleIndex& index, U64 from_sample)
+:	mIndex(index),
+	mPosition(0),
+	mOffset(0)
+{
+	std::lock_guard<std::mutex> lock(mIndex.mLock);
+
+	mPosition = mIndex.LowerBoundLocked(from_sample);
+
+	// Next seeks at the start of a block, otherwise decode up to the transaction before ours
+	mPrevious.mFrameIndex = mPrevious.mStartSample = mPrevious.mEndSample = 0;
+	if (mPosition % BLOCK_SIZE == 0)
+		return;
+
+	mIndex.Seek(mPosition, mOffset, mPrevious);
+	for (U64 p = mPosition - mPosition % BLOCK_SIZE; p < mPosition; ++p)
+		mIndex.Decode(mOffset, mPrevious, mPrevious);
+}
+
+bool nRFSampleIndex::Cursor::Next(Entry& entry)
+{
+	std::lock_guard<std::mutex> lock(mIndex.mLock);
+
+	if (mPosition >= mIndex.mCount)
+		return false;
+
+	if (mPosition % BLOCK_SIZE == 0)
+		mIndex.Seek(mPosition, mOffset, mPrevious);
+
+	mIndex.Decode(mOffset, mPrevious, entry);
+	mPrevious = entry;
+	++mPosition;
+
+	return true;
+}
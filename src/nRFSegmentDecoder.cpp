@@ -0,0 +1,259 @@
+#include <algorithm>
+#include <memory>
+
+#include "nRFSegmentDecoder.h"
+
+nRFSegmentDecoder::EdgeSampler::EdgeSampler(const nRFChannelEdges& channel, U64 from_sample)
+:	mNext(channel.mEdges.data()),
+	mEnd(channel.mEdges.data() + channel.mEdges.size()),
+	mState(channel.mInitialState)
+{
+	// the state after every edge up to from_sample
+	const U64* next = std::upper_bound(mNext, mEnd, from_sample);
+	if ((next - mNext) & 1)
+		mState = Toggle(mState);
+
+	mNext = next;
+}
+
+template <nRFSpiMode_e MODE>
+nRFSegmentDecoder::DecodeWindowFn nRFSegmentDecoder::SelectDecoder(bool mark_bits)
+{
+	if (mark_bits)
+		return DecodeSpiBytes<MODE, true, EdgeSampler, EdgeSampler>;
+
+	return DecodeSpiBytes<MODE, false, EdgeSampler, EdgeSampler>;
+}
+
+nRFSegmentDecoder::nRFSegmentDecoder(nRFSpiMode_e mode, bool mark_bits)
+:	mSck(NULL),
+	mMosi(NULL),
+	mMiso(NULL),
+	mNumWorkers(0),
+	mStopping(false)
+{
+	switch (mode)
+	{
+	case SPI_MODE_0:	mDecodeWindow = SelectDecoder<SPI_MODE_0>(mark_bits);		break;
+	case SPI_MODE_1:	mDecodeWindow = SelectDecoder<SPI_MODE_1>(mark_bits);		break;
+	case SPI_MODE_2:	mDecodeWindow = SelectDecoder<SPI_MODE_2>(mark_bits);		break;
+	case SPI_MODE_3:	mDecodeWindow = SelectDecoder<SPI_MODE_3>(mark_bits);		break;
+	default:			mDecodeWindow = SelectDecoder<SPI_MODE_AUTO>(mark_bits);	break;
+	}
+}
+
+void nRFSegmentDecoder::FindWindows(const nRFChannelEdges* csns, U32 num_radios)
+{
+	mWindows.clear();
+
+	// where we are on each CSN and its state there
+	size_t next_edge[MAX_RADIOS];
+	BitState state[MAX_RADIOS];
+	for (U32 radio = 0; radio < num_radios; ++radio)
+	{
+		next_edge[radio] = 0;
+		state[radio] = csns[radio].mInitialState;
+	}
+
+	U64 bus_sample = 0;
+	for (;;)
+	{
+		// The earliest falling edge of all the CSNs. Like NextCsnWindow() we skip
+		// the windows that start before the last one ended, they're bus conflicts.
+		U8 next = MAX_RADIOS;
+		U64 next_start = 0;
+		for (U8 radio = 0; radio < num_radios; ++radio)
+		{
+			const std::vector<U64>& edges = csns[radio].mEdges;
+			for (; next_edge[radio] < edges.size(); ++next_edge[radio])
+			{
+				U64 edge = edges[next_edge[radio]];
+				if (state[radio] == BIT_HIGH  &&  edge >= bus_sample)
+				{
+					if (next == MAX_RADIOS  ||  edge < next_start)
+					{
+						next = radio;
+						next_start = edge;
+					}
+
+					break;
+				}
+
+				state[radio] = Toggle(state[radio]);
+			}
+		}
+
+		// the streaming decoder stops at the first window that doesn't end in the capture
+		if (next == MAX_RADIOS  ||  next_edge[next] + 1 >= csns[next].mEdges.size())
+			break;
+
+		Window window;
+		window.mStart = next_start;
+		window.mEnd = csns[next].mEdges[next_edge[next] + 1];
+		window.mRadio = next;
+		mWindows.push_back(window);
+
+		// CSN is high again
+		next_edge[next] += 2;
+		bus_sample = window.mEnd;
+	}
+}
+
+void nRFSegmentDecoder::Decode(const nRFChannelEdges& sck, const nRFChannelEdges& mosi, const nRFChannelEdges* miso,
+								U32 num_threads, const WindowDoneFn& window_done)
+{
+	// no edges at all, reads low like the streaming decoder does without MISO
+	static const nRFChannelEdges UNCONNECTED;
+
+	mSck = &sck;
+	mMosi = &mosi;
+	mMiso = miso != NULL ? miso : &UNCONNECTED;
+
+	// the calling thread hands out the segments and takes the windows back, the others decode
+	if (num_threads == 0)
+		num_threads = std::thread::hardware_concurrency();
+	mNumWorkers = num_threads > 1 ? num_threads - 1 : 0;
+	if (mNumWorkers > MAX_WORKERS)
+		mNumWorkers = MAX_WORKERS;
+
+	const size_t num_segments = (mWindows.size() + SEGMENT_WINDOWS - 1) / SEGMENT_WINDOWS;
+
+	if (mNumWorkers == 0)
+	{
+		std::unique_ptr<Segment> segment(new Segment);
+		SpiSckEdges sck_edges;
+
+		for (size_t seg = 0; seg < num_segments; ++seg)
+		{
+			segment->mFirst = seg * SEGMENT_WINDOWS;
+			segment->mNumWindows = std::min<size_t>(SEGMENT_WINDOWS, mWindows.size() - segment->mFirst);
+			DecodeSegment(*segment, sck_edges);
+
+			for (size_t w = 0; w < segment->mNumWindows; ++w)
+				window_done(mWindows[segment->mFirst + w], segment->mBytes[w]);
+		}
+
+		return;
+	}
+
+	// enough segments to keep every worker busy while we're making the frames
+	std::vector<Segment> segments(mNumWorkers * 2);
+
+	mStopping = false;
+
+	std::vector<std::thread> workers;
+	for (U32 c = 0; c < mNumWorkers; ++c)
+		workers.push_back(std::thread(&nRFSegmentDecoder::WorkerThread, this));
+
+	size_t num_queued = 0, num_done = 0;
+	while (num_done < num_segments)
+	{
+		// queue up as many segments as we have room for
+		while (num_queued < num_segments  &&  num_queued - num_done < segments.size())
+		{
+			Segment& segment = segments[num_queued % segments.size()];
+			segment.mFirst = num_queued * SEGMENT_WINDOWS;
+			segment.mNumWindows = std::min<size_t>(SEGMENT_WINDOWS, mWindows.size() - segment.mFirst);
+
+			std::lock_guard<std::mutex> lock(mLock);
+			segment.mDecoded = false;
+			mQueue.push_back(&segment);
+			mWorkReady.notify_one();
+
+			++num_queued;
+		}
+
+		// the oldest segment as soon as it's decoded
+		Segment& segment = segments[num_done % segments.size()];
+		{
+			std::unique_lock<std::mutex> lock(mLock);
+			while (!segment.mDecoded)
+				mSegmentDecoded.wait(lock);
+		}
+
+		for (size_t w = 0; w < segment.mNumWindows; ++w)
+			window_done(mWindows[segment.mFirst + w], segment.mBytes[w]);
+
+		++num_done;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mLock);
+		mStopping = true;
+		mQueue.clear();
+		mWorkReady.notify_all();
+	}
+
+	for (size_t c = 0; c < workers.size(); ++c)
+		workers[c].join();
+}
+
+void nRFSegmentDecoder::WorkerThread()
+{
+	SpiSckEdges sck_edges;
+
+	for (;;)
+	{
+		Segment* segment;
+		{
+			std::unique_lock<std::mutex> lock(mLock);
+			while (!mStopping  &&  mQueue.empty())
+				mWorkReady.wait(lock);
+
+			if (mStopping)
+				return;
+
+			segment = mQueue.front();
+			mQueue.pop_front();
+		}
+
+		DecodeSegment(*segment, sck_edges);
+
+		std::lock_guard<std::mutex> lock(mLock);
+		segment->mDecoded = true;
+		mSegmentDecoded.notify_all();
+	}
+}
+
+void nRFSegmentDecoder::DecodeSegment(Segment& segment, SpiSckEdges& sck_edges)
+{
+	const Window* window = &mWindows[segment.mFirst];
+	const Window* windows_end = window + segment.mNumWindows;
+
+	// the data channels as they are where the segment starts, they only go forward from there
+	EdgeSampler mosi(*mMosi, window->mStart), miso(*mMiso, window->mStart);
+
+	const U64* sck_begin = mSck->mEdges.data();
+	const U64* sck_end = sck_begin + mSck->mEdges.size();
+	const U64* sck = std::upper_bound(sck_begin, sck_end, window->mStart);
+
+	for (SpiTransactionBuffer* spi_bytes = segment.mBytes; window != windows_end; ++window, ++spi_bytes)
+	{
+		// past whatever SCK did between the windows, or the rest of an oversize one
+		while (sck != sck_end  &&  *sck <= window->mStart)
+			++sck;
+
+		sck_edges.mStart = window->mStart;
+		sck_edges.mInitialState = (sck - sck_begin) & 1 ? Toggle(mSck->mInitialState) : mSck->mInitialState;
+		sck_edges.mNumEdges = 0;
+		sck_edges.mOverflow = false;
+
+		for (; sck != sck_end  &&  *sck <= window->mEnd; ++sck)
+		{
+			// too long for a valid command anyway
+			if (sck_edges.mNumEdges == SpiSckEdges::MAX_EDGES)
+			{
+				sck_edges.mOverflow = true;
+				break;
+			}
+
+			sck_edges.mEdges[sck_edges.mNumEdges++] = *sck;
+		}
+
+		spi_bytes->clear();
+		if (sck_edges.mOverflow)
+			spi_bytes->SetOversize();
+		else
+			mDecodeWindow(sck_edges, mosi, miso, *spi_bytes);
+	}
+}
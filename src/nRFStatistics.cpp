@@ -0,0 +1,201 @@
+#include <cstring>
+
+#include <AnalyzerHelpers.h>
+
+#include "nRFStatistics.h"
+
+static const char* const EVENT_NAMES[NUM_EVENTS] = {"TX_DS", "MAX_RT", "RX_DR"};
+static const U8 EVENT_BITS[NUM_EVENTS] = {STATUS_TX_DS, STATUS_MAX_RT, STATUS_RX_DR};
+
+nRFStatistics::nRFStatistics(U64 window_samples)
+:	mWindowSamples(window_samples > 0 ? window_samples : 1),
+	mFirstSample(0),
+	mLastSample(0),
+	mTransactions(0),
+	mTxPayloads(0),
+	mTxBytes(0),
+	mRxPayloads(0),
+	mRxBytes(0),
+	mOversizeBursts(0),
+	mOversizeSamples(0)
+{
+	::memset(mLastStatus, 0, sizeof(mLastStatus));
+	::memset(mCommands, 0, sizeof(mCommands));
+	::memset(mRegisterReads, 0, sizeof(mRegisterReads));
+	::memset(mRegisterWrites, 0, sizeof(mRegisterWrites));
+	::memset(mEvents, 0, sizeof(mEvents));
+	::memset(mPacketsLost, 0, sizeof(mPacketsLost));
+	::memset(mRetransmits, 0, sizeof(mRetransmits));
+	::memset(mRxPipes, 0, sizeof(mRxPipes));
+}
+
+void nRFStatistics::Update(U64 starting_sample, U64 ending_sample, U8 radio, U8 command_byte, U8 status, U8 first_data, U32 data_length)
+{
+	const nRFCommandInfo& info = GetCommandInfo(command_byte);
+
+	std::lock_guard<std::mutex> lock(mLock);
+
+	if (mTransactions++ == 0)
+		mFirstSample = starting_sample;
+	mLastSample = ending_sample;
+
+	size_t window_index = size_t(starting_sample / mWindowSamples);
+	if (window_index >= mWindows.size())
+		mWindows.resize(window_index + 1, Window());
+
+	Window& window = mWindows[window_index];
+	++window.mTransactions;
+
+	++mCommands[info.mCommand];
+
+	if (info.mFlags & CMD_IS_REGISTER)
+	{
+		if (info.mFlags & CMD_IS_READ)
+			++mRegisterReads[info.mRegister];
+		else
+			++mRegisterWrites[info.mRegister];
+
+		if (info.mCommand == R_REGISTER  &&  info.mRegister == OBSERVE_TX  &&  data_length > 0)
+		{
+			++mPacketsLost[first_data >> 4];
+			++mRetransmits[first_data & 0x0F];
+		}
+	}
+
+	if (info.mCommand == W_TX_PAYLOAD  ||  info.mCommand == W_TX_PAYLOAD_NOACK  ||  info.mCommand == W_ACK_PAYLOAD)
+	{
+		++mTxPayloads;
+		mTxBytes += data_length;
+		window.mTxBytes += data_length;
+	} else if (info.mCommand == R_RX_PAYLOAD) {
+		++mRxPayloads;
+		mRxBytes += data_length;
+		window.mRxBytes += data_length;
+		++mRxPipes[(status >> 1) & 7];
+	}
+
+	// count the interrupts when they come up, not every time they're polled
+	U8 raised = status & ~mLastStatus[radio];
+	for (int e = 0; e < NUM_EVENTS; ++e)
+	{
+		if (raised & EVENT_BITS[e])
+		{
+			++mEvents[e];
+			++window.mEvents[e];
+		}
+	}
+
+	mLastStatus[radio] = status;
+}
+
+void nRFStatistics::AddOversizeBurst(U64 starting_sample, U64 ending_sample)
+{
+	std::lock_guard<std::mutex> lock(mLock);
+
+	++mOversizeBursts;
+	mOversizeSamples += ending_sample - starting_sample;
+}
+
+void nRFStatistics::Write(std::ostream& out, U64 trigger_sample, U32 sample_rate) const
+{
+	std::lock_guard<std::mutex> lock(mLock);
+
+	double seconds = mTransactions > 0 ? double(mLastSample - mFirstSample) / sample_rate : 0;
+	double per_second = seconds > 0 ? 1 / seconds : 0;
+
+	out << "Transactions;" << mTransactions << std::endl;
+	out << "Duration [s];" << seconds << std::endl;
+	out << "Oversize bursts;" << mOversizeBursts << std::endl;
+	out << "Skipped [s];" << double(mOversizeSamples) / sample_rate << std::endl;
+
+	out << std::endl << "Command;Count" << std::endl;
+	for (int c = 0; c <= undefined_cmd; ++c)
+	{
+		if (mCommands[c] > 0)
+			out << COMMAND_NAMES[c] << ';' << mCommands[c] << std::endl;
+	}
+
+	out << std::endl << "Register;Reads;Writes" << std::endl;
+	for (int r = 0; r < NUM_REGISTERS; ++r)
+	{
+		if (mRegisterReads[r] > 0  ||  mRegisterWrites[r] > 0)
+			out << REGISTER_NAMES[r] << ';' << mRegisterReads[r] << ';' << mRegisterWrites[r] << std::endl;
+	}
+
+	out << std::endl << "Payloads;Count;Bytes;Bytes/s" << std::endl;
+	out << "TX;" << mTxPayloads << ';' << mTxBytes << ';' << mTxBytes * per_second << std::endl;
+	out << "RX;" << mRxPayloads << ';' << mRxBytes << ';' << mRxBytes * per_second << std::endl;
+
+	out << std::endl << "Event;Count;Per second" << std::endl;
+	for (int e = 0; e < NUM_EVENTS; ++e)
+		out << EVENT_NAMES[e] << ';' << mEvents[e] << ';' << mEvents[e] * per_second << std::endl;
+
+	U64 tx_results = mEvents[EVENT_TX_DS] + mEvents[EVENT_MAX_RT];
+	if (tx_results > 0)
+		out << "MAX_RT ratio;" << double(mEvents[EVENT_MAX_RT]) / tx_results << std::endl;
+
+	out << std::endl << "Count;PLOS_CNT;ARC_CNT" << std::endl;
+	for (int c = 0; c < 16; ++c)
+		out << c << ';' << mPacketsLost[c] << ';' << mRetransmits[c] << std::endl;
+
+	out << std::endl << "RX_P_NO;Payloads" << std::endl;
+	for (int p = 0; p < 8; ++p)
+	{
+		if (p < 6)
+			out << p;
+		else
+			out << (p == 6 ? "unused" : "RX FIFO empty");
+
+		out << ';' << mRxPipes[p] << std::endl;
+	}
+
+	out << std::endl << "Window [s];Transactions;TX bytes;RX bytes;TX_DS;MAX_RT;RX_DR" << std::endl;
+
+	char time_str[128];
+	for (size_t w = size_t(mFirstSample / mWindowSamples); w < mWindows.size(); ++w)
+	{
+		const Window& window = mWindows[w];
+
+		AnalyzerHelpers::GetTimeString(w * mWindowSamples, trigger_sample, sample_rate, time_str, sizeof(time_str));
+		out << time_str << ';' << window.mTransactions << ';' << window.mTxBytes << ';' << window.mRxBytes;
+		for (int e = 0; e < NUM_EVENTS; ++e)
+			out << ';' << window.mEvents[e];
+		out << std::endl;
+	}
+}
+
+U64 nRFStatistics::GetNumTransactions() const
+{
+	std::lock_guard<std::mutex> lock(mLock);
+	return mTransactions;
+}
+
+U64 nRFStatistics::GetCommandCount(U8 cmd) const
+{
+	std::lock_guard<std::mutex> lock(mLock);
+	return cmd <= undefined_cmd ? mCommands[cmd] : 0;
+}
+
+U64 nRFStatistics::GetEventCount(U8 event) const
+{
+	std::lock_guard<std::mutex> lock(mLock);
+	return event < NUM_EVENTS ? mEvents[event] : 0;
+}
+
+U64 nRFStatistics::GetNumWindows() const
+{
+	std::lock_guard<std::mutex> lock(mLock);
+	return mWindows.size();
+}
+
+U64 nRFStatistics::GetNumOversizeBursts() const
+{
+	std::lock_guard<std::mutex> lock(mLock);
+	return mOversizeBursts;
+}
+
+U64 nRFStatistics::GetOversizeSamples() const
+{
+	std::lock_guard<std::mutex> lock(mLock);
+	return mOversizeSamples;
+}
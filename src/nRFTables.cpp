@@ -0,0 +1,426 @@
+#include "nRFTables.h"
+
+// Everything here is constexpr, so the tables end up in the binary fully built
+// and nothing runs at load time.
+
+constexpr const char* const COMMAND_NAMES[] =
+{
+	"R_REGISTER",
+	"W_REGISTER",
+	"R_RX_PAYLOAD",
+	"W_TX_PAYLOAD",
+	"FLUSH_TX",
+	"FLUSH_RX",
+	"ACTIVATE",
+	"REUSE_TX_PL",
+	"R_RX_PL_WID",
+	"W_ACK_PAYLOAD",
+	"W_TX_PAYLOAD_NOACK",
+	"NOP",
+	"<undef>",			// undefined_cmd
+};
+
+constexpr const char* const REGISTER_NAMES[NUM_REGISTERS] =
+{
+	"CONFIG",
+	"EN_AA",
+	"EN_RXADDR",
+	"SETUP_AW",
+	"SETUP_RETR",
+	"RF_CH",
+	"RF_SETUP",
+	"STATUS",
+	"OBSERVE_TX",
+	"CD",
+	"RX_ADDR_P0",
+	"RX_ADDR_P1",
+	"RX_ADDR_P2",
+	"RX_ADDR_P3",
+	"RX_ADDR_P4",
+	"RX_ADDR_P5",
+	"TX_ADDR",
+	"RX_PW_P0",
+	"RX_PW_P1",
+	"RX_PW_P2",
+	"RX_PW_P3",
+	"RX_PW_P4",
+	"RX_PW_P5",
+	"FIFO_STATUS",
+	"<undef>",			// 0x18
+	"<undef>",			// 0x19
+	"<undef>",			// 0x1A
+	"<undef>",			// 0x1B
+	"DYNPD",
+	"FEATURE",
+	"<undef>",			// 0x1E
+	"<undef>",			// 0x1F
+};
+
+namespace
+{
+
+struct BitName
+{
+	const char*		mBitName;
+	int				mBitNum;
+};
+
+constexpr BitName CONFIG_BN[] = 
+{
+	{"MASK_RX_DR",	6},
+	{"MASK_TX_DS",	5},
+	{"MASK_MAX_RT",	4},
+	{"EN_CRC",		3},
+	{"CRCO",		2},
+	{"PWR_UP",		1},
+	{"PRIM_RX",		0},
+	{nullptr, -1},
+};
+
+constexpr BitName EN_AA_BN[] = {
+	{"ENAA_P5",	5},
+	{"ENAA_P4",	4},
+	{"ENAA_P3",	3},
+	{"ENAA_P2",	2},
+	{"ENAA_P1",	1},
+	{"ENAA_P0",	0},
+	{nullptr, -1},
+};
+
+constexpr BitName EN_RXADDR_BN[] = {
+	{"ERX_P5",	5},
+	{"ERX_P4",	4},
+	{"ERX_P3",	3},
+	{"ERX_P2",	2},
+	{"ERX_P1",	1},
+	{"ERX_P0",	0},
+	{nullptr, -1},
+};
+
+constexpr BitName RF_SETUP_BN[] = {
+	{"CONT_WAVE",	7},
+	{"RF_DR_LOW",	5},
+	{"PLL_LOCK",	4},
+	{"RF_DR_HIGH",	3},
+	{"LNA_HCURR",	0},
+	{nullptr, -1},
+};
+
+constexpr BitName STATUS_BN[] = {
+	{"RX_DR",		6},
+	{"TX_DS",		5},
+	{"MAX_RT",		4},
+	{"TX_FULL",		0},
+	{nullptr, -1},
+};
+
+constexpr BitName CD_BN[] = {
+	{"CD",		0},
+	{nullptr, -1},
+};
+
+constexpr BitName FIFO_STATUS_BN[] = {
+	{"TX_REUSE",	6},
+	{"TX_FULL",		5},
+	{"TX_EMPTY",	4},
+	{"RX_FULL",		1},
+	{"RX_EMPTY",	0},
+	{nullptr, -1},
+};
+
+constexpr BitName DYNPD_BN[] = {
+	{"DPL_P5",	6},
+	{"DPL_P5",	5},
+	{"DPL_P4",	4},
+	{"DPL_P3",	3},
+	{"DPL_P2",	2},
+	{"DPL_P1",	1},
+	{"DPL_P0",	0},
+	{nullptr, -1},
+};
+
+constexpr BitName FEATURE_BN[] = {
+	{"EN_DPL",		2},
+	{"EN_ACK_PAY",	1},
+	{"EN_DYN_ACK",	0},
+	{nullptr, -1},
+};
+
+constexpr const BitName* ALL_REGISTERS[NUM_REGISTERS] = {
+	CONFIG_BN,			// CONFIG		
+	EN_AA_BN,			// EN_AA		
+	EN_RXADDR_BN,		// EN_RXADDR	
+	nullptr,			// SETUP_AW	
+	nullptr,			// SETUP_RETR	
+	nullptr,			// RF_CH		
+	RF_SETUP_BN,		// RF_SETUP	
+	STATUS_BN,			// STATUS		
+	nullptr,			// OBSERVE_TX	
+	CD_BN,				// CD			
+	nullptr,			// RX_ADDR_P0	
+	nullptr,			// RX_ADDR_P1	
+	nullptr,			// RX_ADDR_P2	
+	nullptr,			// RX_ADDR_P3	
+	nullptr,			// RX_ADDR_P4	
+	nullptr,			// RX_ADDR_P5	
+	nullptr,			// TX_ADDR		
+	nullptr,			// RX_PW_P0	
+	nullptr,			// RX_PW_P1	
+	nullptr,			// RX_PW_P2	
+	nullptr,			// RX_PW_P3	
+	nullptr,			// RX_PW_P4	
+	nullptr,			// RX_PW_P5
+	FIFO_STATUS_BN,		// FIFO_STATUS
+	nullptr,			// 0x18
+	nullptr,			// 0x19
+	nullptr,			// 0x1A
+	nullptr,			// 0x1B
+	DYNPD_BN,			// DYNPD
+	FEATURE_BN,			// FEATURE
+	nullptr,			// 0x1E
+	nullptr,			// 0x1F
+};
+
+// builds a string in a table entry
+class TextBuilder
+{
+public:
+	constexpr TextBuilder(char* text)
+	:	mText(text),
+		mLength(0)
+	{
+		mText[0] = '\0';
+	}
+
+	constexpr TextBuilder& Append(const char* str)
+	{
+		while (*str != '\0')
+		{
+			// makes the build fail if REGISTER_TEXT_SIZE is too small
+			if (mLength + 1 >= REGISTER_TEXT_SIZE)
+				throw "register text doesn't fit";
+
+			mText[mLength++] = *str++;
+		}
+
+		mText[mLength] = '\0';
+		return *this;
+	}
+
+	constexpr TextBuilder& AppendDecimal(unsigned value)
+	{
+		char digits[12] = {};
+		int ndx = 10;
+		do {
+			digits[ndx--] = char('0' + value % 10);
+			value /= 10;
+		} while (value != 0);
+
+		return Append(digits + ndx + 1);
+	}
+
+	constexpr TextBuilder& AddPart(const char* part)
+	{
+		if (mLength > 0)
+			Append(", ");
+
+		return Append(part);
+	}
+
+	constexpr void HighBits(U8 bits, int reg)
+	{
+		for (const BitName* iBN = ALL_REGISTERS[reg]; iBN->mBitName != nullptr; ++iBN)
+		{
+			// is the bit set?
+			if ((bits & (1 << iBN->mBitNum)) != 0)
+				AddPart(iBN->mBitName);
+		}
+	}
+
+	constexpr void StatusBits(U8 stat)
+	{
+		HighBits(stat, STATUS);
+
+		U8 pipe = (stat >> 1) & 7;
+		if (pipe < 7)
+			AddPart("RX_P_NO=").AppendDecimal(pipe);
+		else
+			AddPart("RX_FIFO empty");
+	}
+
+protected:
+	char*		mText;
+	size_t		mLength;
+};
+
+constexpr bool HasRegisterText(int reg)
+{
+	return reg == SETUP_AW  ||  reg == SETUP_RETR  ||  reg == RF_CH  ||  reg == OBSERVE_TX
+			||  (reg >= RX_PW_P0  &&  reg <= RX_PW_P5)
+			||  ALL_REGISTERS[reg] != nullptr;
+}
+
+constexpr void MakeRegisterText(char* text, int reg, U8 value)
+{
+	TextBuilder ret_val(text);
+
+	if (reg == SETUP_AW)
+	{
+		switch (value)
+		{
+		case 1:		ret_val.Append("AW=3 bytes");		break;
+		case 2:		ret_val.Append("AW=4 bytes");		break;
+		case 3:		ret_val.Append("AW=5 bytes");		break;
+		default:	ret_val.Append("<SETUP_AW ERROR>");	break;
+ 		}
+
+	} else if (reg == SETUP_RETR) {
+		
+		ret_val.Append("ARD=").AppendDecimal(((value >> 4) + 1) * 250).Append("us");
+		ret_val.Append(", ARC=");
+
+		U8 arc = value & 0xf;
+		if (arc == 0)
+			ret_val.Append("Disabled");
+		else
+			ret_val.AppendDecimal(arc).Append(" retransmit");
+
+	} else if (reg == RF_CH) {
+
+		ret_val.Append("channel=").AppendDecimal(value);
+
+	} else if (reg == RF_SETUP) {
+
+		ret_val.HighBits(value, reg);
+
+		ret_val.AddPart("RF_PWR=");
+
+		switch ((value >> 1) & 3)
+		{
+		case 0:		ret_val.Append("-18dBm");	break;
+		case 1:		ret_val.Append("-12dBm");	break;
+		case 2:		ret_val.Append("-6dBm");	break;
+		case 3:		ret_val.Append("0dBm");		break;
+		}
+
+	} else if (reg == STATUS) {
+
+		ret_val.StatusBits(value);
+
+	} else if (reg == OBSERVE_TX) {
+
+		U8 plos_cnt = value >> 4;
+		U8 arc_cnt = value & 7;
+
+		ret_val.Append("PLOS_CNT=").AppendDecimal(plos_cnt);
+		ret_val.Append(" ARC_CNT=").AppendDecimal(arc_cnt);
+
+	} else if (reg >= RX_PW_P0  &&  reg <= RX_PW_P5) {
+
+		ret_val.Append(REGISTER_NAMES[reg]);
+		ret_val.Append("=").AppendDecimal(value & 0x1f);
+		
+	} else if (ALL_REGISTERS[reg] != nullptr) {
+
+		ret_val.HighBits(value, reg);
+
+	} else {
+		ret_val.Append("<register error>");
+	}
+}
+
+constexpr nRFRegisterTextTable MakeRegisterTexts()
+{
+	nRFRegisterTextTable table = {};
+
+	// the last row is for the registers without a value text
+	int row = 0;
+	for (int reg = 0; reg < NUM_REGISTERS; ++reg)
+	{
+		if (HasRegisterText(reg))
+		{
+			for (int value = 0; value < 256; ++value)
+				MakeRegisterText(table.mTexts[row][value], reg, U8(value));
+
+			table.mRow[reg] = U8(row++);
+		} else {
+			table.mRow[reg] = NUM_TEXT_REGISTERS - 1;
+		}
+	}
+
+	if (row != NUM_TEXT_REGISTERS - 1)
+		throw "NUM_TEXT_REGISTERS is wrong";
+
+	for (int value = 0; value < 256; ++value)
+		TextBuilder(table.mTexts[row][value]).Append("<register error>");
+
+	return table;
+}
+
+constexpr nRFCommand_e CommandFromByte(U8 cmd_byte)
+{
+	U8 highest_3_bits = cmd_byte >> 5;
+	nRFCommand_e cmd = undefined_cmd;
+
+	if (highest_3_bits < 2)
+		cmd = highest_3_bits == 0 ? R_REGISTER : W_REGISTER;
+	else if (cmd_byte == 0x61)
+		cmd = R_RX_PAYLOAD;
+	else if (cmd_byte == 0xA0)
+		cmd = W_TX_PAYLOAD;
+	else if (cmd_byte == 0xE1)
+		cmd = FLUSH_TX;
+	else if (cmd_byte == 0xE2)
+		cmd = FLUSH_RX;
+	else if (cmd_byte == 0xE3)
+		cmd = REUSE_TX_PL;
+	else if (cmd_byte == 0x50)
+		cmd = ACTIVATE;
+	else if (cmd_byte == 0x60)
+		cmd = R_RX_PL_WID;
+	else if ((cmd_byte >> 3) == 0x15)
+		cmd = W_ACK_PAYLOAD;
+	else if (cmd_byte == 0xB0)
+		cmd = W_TX_PAYLOAD_NOACK;
+	else if (cmd_byte == 0xFF)
+		cmd = NOP;
+
+	return cmd;
+}
+
+constexpr nRFCommandTable MakeCommandTable()
+{
+	nRFCommandTable table = {};
+
+	for (int cmd_byte = 0; cmd_byte < 256; ++cmd_byte)
+	{
+		nRFCommand_e cmd = CommandFromByte(U8(cmd_byte));
+		nRFCommandInfo& info = table.mInfo[cmd_byte];
+
+		info.mCommand = U8(cmd);
+		info.mRegister = undefined_reg;
+		info.mFlags = 0;
+
+		if (cmd == R_REGISTER  ||  cmd == W_REGISTER)
+		{
+			info.mRegister = U8(cmd_byte & reg_mask);
+			info.mFlags |= CMD_IS_REGISTER;
+		}
+
+		if (cmd == R_REGISTER  ||  cmd == R_RX_PAYLOAD  ||  cmd == R_RX_PL_WID)
+			info.mFlags |= CMD_IS_READ;
+
+		if (!(cmd == FLUSH_TX  ||  cmd == FLUSH_RX  ||  cmd == REUSE_TX_PL  ||  cmd == NOP))
+			info.mFlags |= CMD_HAS_DATA;
+
+		if (cmd == W_TX_PAYLOAD  ||  cmd == R_RX_PAYLOAD  ||  cmd == W_ACK_PAYLOAD  ||  cmd == W_TX_PAYLOAD_NOACK)
+			info.mFlags |= CMD_HAS_PAYLOAD;
+	}
+
+	return table;
+}
+
+}	// namespace
+
+constexpr nRFCommandTable COMMAND_TABLE = MakeCommandTable();
+constexpr nRFRegisterTextTable REGISTER_TEXTS = MakeRegisterTexts();